@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include <benchmark/benchmark.h>
+#include <h5/h5.hpp>
+#include <numeric>
+#include <utility>
+
+namespace h5ai = h5::array_interface;
+
+// A view on a (n0, n1) C-ordered array of double
+static h5ai::h5_array_view make_view(std::vector<double> &a, long n0, long n1) {
+  h5ai::h5_array_view v{h5::hdf5_type<double>(), a.data(), 2, false};
+  v.slab.count = v.L_tot = {h5::hsize_t(n0), h5::hsize_t(n1)};
+  return v;
+}
+
+// The shapes (n0, n1) of the arrays, each with and without compression
+static void array_args(benchmark::internal::Benchmark *b) {
+  for (long compress : {0, 1})
+    for (auto [n0, n1] : {std::pair{1l, 1000l}, {1l, 1000000l}, {1000l, 1000l}}) b->Args({n0, n1, compress});
+  b->ArgNames({"n0", "n1", "compress"})->Unit(benchmark::kMicrosecond);
+}
+
+// Throughput of the N-d array writes, with the args (n0, n1, compress), in a file on disk
+static void BM_ArrayWrite(benchmark::State &state) {
+  long n0 = state.range(0), n1 = state.range(1);
+  bool compress = state.range(2);
+  std::vector<double> a(n0 * n1);
+  std::iota(a.begin(), a.end(), 0.0);
+  h5::file f{"bench_array_write.h5", 'w'};
+  h5::group g{f};
+  for (auto _ : state) h5ai::write(g, "a", make_view(a, n0, n1), compress);
+  state.SetBytesProcessed(state.iterations() * long(a.size() * sizeof(double)));
+}
+BENCHMARK(BM_ArrayWrite)->Apply(array_args);
+
+static void BM_ArrayRead(benchmark::State &state) {
+  long n0 = state.range(0), n1 = state.range(1);
+  bool compress = state.range(2);
+  std::vector<double> a(n0 * n1);
+  std::iota(a.begin(), a.end(), 0.0);
+  {
+    h5::file f{"bench_array_read.h5", 'w'};
+    h5ai::write(f, "a", make_view(a, n0, n1), compress);
+  }
+  h5::file f{"bench_array_read.h5", 'r'};
+  h5::group g{f};
+  for (auto _ : state) {
+    h5ai::read(g, "a", make_view(a, n0, n1), h5ai::get_h5_lengths_type(g, "a"));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * long(a.size() * sizeof(double)));
+}
+BENCHMARK(BM_ArrayRead)->Apply(array_args);
+
+// 1d std::vector<double>, in a memory file
+static void BM_VectorDoubleRoundTrip(benchmark::State &state) {
+  std::vector<double> v(state.range(0), 1.0), w;
+  h5::file f;
+  h5::group g{f};
+  for (auto _ : state) {
+    h5::write(g, "v", v);
+    h5::read(g, "v", w);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * long(sizeof(double)));
+}
+BENCHMARK(BM_VectorDoubleRoundTrip)->RangeMultiplier(100)->Range(1, 1000000);
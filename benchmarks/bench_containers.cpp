@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include <benchmark/benchmark.h>
+#include <h5/h5.hpp>
+#include <map>
+
+// std::vector<std::string>, with strings of equal length, or with one long outlier
+static void BM_VectorStringRoundTrip(benchmark::State &state) {
+  std::vector<std::string> v(state.range(0), "abcdefgh"), w;
+  if (state.range(1)) v[0] = std::string(4096, 'x');
+  h5::file f;
+  h5::group g{f};
+  for (auto _ : state) {
+    h5::write(g, "v", v);
+    h5::read(g, "v", w);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorStringRoundTrip)->ArgsProduct({{100, 10000}, {0, 1}})->ArgNames({"n", "outlier"});
+
+// The generic vector : one subgroup key per element
+static void BM_VectorGenericRoundTrip(benchmark::State &state) {
+  std::vector<std::vector<int>> v(state.range(0), std::vector<int>{1, 2, 3}), w;
+  h5::file f;
+  h5::group g{f};
+  for (auto _ : state) {
+    h5::write(g, "v", v);
+    h5::read(g, "v", w);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorGenericRoundTrip)->Arg(10)->Arg(1000);
+
+static void BM_MapRoundTrip(benchmark::State &state) {
+  std::map<std::string, double> m, r;
+  for (long i = 0; i < state.range(0); ++i) {
+    auto n       = std::to_string(i);
+    m["key" + n] = double(i);
+  }
+  h5::file f;
+  h5::group g{f};
+  for (auto _ : state) {
+    h5::write(g, "m", m);
+    h5::read(g, "m", r);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MapRoundTrip)->Arg(10)->Arg(1000);
+
+// Listing a wide group
+static void BM_GroupListing(benchmark::State &state) {
+  h5::file f;
+  h5::group g{f};
+  for (long i = 0; i < state.range(0); ++i) {
+    auto n = std::to_string(i);
+    h5::write(g, "d" + n, i);
+  }
+  for (auto _ : state) benchmark::DoNotOptimize(g.get_all_dataset_names());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GroupListing)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,50 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include <benchmark/benchmark.h>
+#include <h5/h5.hpp>
+
+// Latency of the scalar writes and reads, in a memory file
+static void BM_ScalarWrite(benchmark::State &state) {
+  h5::file f;
+  h5::group g{f};
+  double x = 1.5;
+  for (auto _ : state) h5::write(g, "x", x);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarWrite);
+
+static void BM_ScalarRead(benchmark::State &state) {
+  h5::file f;
+  h5::group g{f};
+  h5::write(g, "x", 1.5);
+  double x = 0;
+  for (auto _ : state) {
+    h5::read(g, "x", x);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarRead);
+
+static void BM_StringWrite(benchmark::State &state) {
+  h5::file f;
+  h5::group g{f};
+  std::string s(state.range(0), 'a');
+  for (auto _ : state) h5::write(g, "s", s);
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringWrite)->Arg(16)->Arg(4096);
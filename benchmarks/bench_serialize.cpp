@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include <benchmark/benchmark.h>
+#include <h5/h5.hpp>
+#include <h5/serialization.hpp>
+#include <h5/compact.hpp>
+
+// serialize / deserialize round trip of a std::vector<double>
+static void BM_SerializeRoundTrip(benchmark::State &state) {
+  std::vector<double> v(state.range(0), 1.0);
+  for (auto _ : state) {
+    auto buf = h5::serialize(v);
+    benchmark::DoNotOptimize(h5::deserialize<std::vector<double>>(buf));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * long(sizeof(double)));
+}
+BENCHMARK(BM_SerializeRoundTrip)->RangeMultiplier(100)->Range(1, 1000000);
+
+// Latency of serialize for a small object
+static void BM_SerializeScalar(benchmark::State &state) {
+  for (auto _ : state) benchmark::DoNotOptimize(h5::serialize(1.5));
+}
+BENCHMARK(BM_SerializeScalar);
+
+// The same with a reused serializer
+static void BM_SerializerRoundTrip(benchmark::State &state) {
+  std::vector<double> v(state.range(0), 1.0);
+  h5::serializer ser;
+  for (auto _ : state) benchmark::DoNotOptimize(h5::deserialize<std::vector<double>>(ser(v)));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * long(sizeof(double)));
+}
+BENCHMARK(BM_SerializerRoundTrip)->RangeMultiplier(100)->Range(1, 1000000);
+
+static void BM_SerializerScalar(benchmark::State &state) {
+  h5::serializer ser;
+  for (auto _ : state) benchmark::DoNotOptimize(ser(1.5));
+}
+BENCHMARK(BM_SerializerScalar);
+
+// The same small objects in the compact format
+static void BM_SerializeCompactScalar(benchmark::State &state) {
+  for (auto _ : state) benchmark::DoNotOptimize(h5::serialize_compact(1.5));
+}
+BENCHMARK(BM_SerializeCompactScalar);
+
+static void BM_SerializeCompactRoundTripPair(benchmark::State &state) {
+  auto p = std::pair<int, double>{1, 2.5};
+  for (auto _ : state) benchmark::DoNotOptimize(h5::deserialize_compact<std::pair<int, double>>(h5::serialize_compact(p)));
+}
+BENCHMARK(BM_SerializeCompactRoundTripPair);
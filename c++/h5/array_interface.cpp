@@ -22,10 +22,27 @@
 
 #include <numeric>
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream> // DEBUG
 
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define H5_HAS_MMAP
+#endif
+
 namespace h5::array_interface {
 
+  //------------------------------------------------
+  // select the hyperslab sl in the dataspace ds
+  static void select_hyperslab(dataspace const &ds, hyperslab const &sl) {
+    herr_t err = H5Sselect_hyperslab(ds, H5S_SELECT_SET, sl.offset.data(), sl.stride.data(), sl.count.data(),
+                                     (sl.block.empty() ? nullptr : sl.block.data()));
+    if (err < 0) throw std::runtime_error("Cannot set hyperslab");
+  }
+
   //------------------------------------------------
   // the dataspace corresponding to the array. Contiguous data only...
   dataspace make_mem_dspace(h5_array_view const &v) {
@@ -35,13 +52,112 @@ namespace h5::array_interface {
     dataspace ds = H5Screate_simple(v.slab.rank(), v.L_tot.data(), nullptr);
     if (!ds.is_valid()) throw std::runtime_error("Cannot create the dataset");
 
-    herr_t err = H5Sselect_hyperslab(ds, H5S_SELECT_SET, v.slab.offset.data(), v.slab.stride.data(), v.slab.count.data(),
-                                     (v.slab.block.empty() ? nullptr : v.slab.block.data()));
-    if (err < 0) throw std::runtime_error("Cannot set hyperslab");
-
+    select_hyperslab(ds, v.slab);
     return ds;
   }
 
+  //------------------------------------------------
+  // Size in bytes of the selection of the dataspace d, for the type ty (in memory)
+  [[maybe_unused]] static size_t selected_bytes(dataspace const &d, datatype const &ty) { return H5Sget_select_npoints(d) * H5Tget_size(ty); }
+
+  // Has the dataset ds a filter (e.g. compression) ?
+  [[maybe_unused]] static bool is_filtered(dataset const &ds) {
+    proplist dcpl = H5Dget_create_plist(ds);
+    return H5Pget_nfilters(dcpl) > 0;
+  }
+
+  //------------------------------------------------
+  // the dataspace of the dataset ds in the file, with the hyperslab sl selected (if not empty)
+  static dataspace make_file_dspace(dataset const &ds, hyperslab const &sl, std::string const &name) {
+    dataspace file_dspace = H5Dget_space(ds);
+    if (sl.empty()) return file_dspace;
+
+    if (sl.rank() != H5Sget_simple_extent_ndims(file_dspace))
+      throw std::runtime_error("h5 slice of dataset " + name + " : rank mismatch between the hyperslab and the dataset");
+    select_hyperslab(file_dspace, sl);
+    if (H5Sselect_valid(file_dspace) <= 0) throw std::runtime_error("h5 slice of dataset " + name + " : hyperslab out of the bounds of the dataset");
+    return file_dspace;
+  }
+
+  //------------------------------------------------
+  // chunk dimensions of about p.chunk_bytes, filling the trailing dimensions first
+  static v_t make_chunk_dims(int rank, hsize_t const *dims, size_t type_size, write_policy const &p) {
+    v_t chunk_dims(rank);
+    hsize_t n_elem = std::max(hsize_t(p.chunk_bytes / std::max(type_size, size_t{1})), hsize_t{1});
+    for (int i = rank - 1; i >= 0; --i) {
+      chunk_dims[i] = std::clamp(n_elem, hsize_t{1}, std::max(dims[i], hsize_t{1}));
+      n_elem        = std::max(n_elem / chunk_dims[i], hsize_t{1});
+    }
+    return chunk_dims;
+  }
+
+  //------------------------------------------------
+  // Is the ZFP filter used for a dataset of type ty and rank, with the write policy p ?
+  static bool uses_zfp(int rank, datatype const &ty, write_policy const &p) {
+    return p.precision == write_policy::precision_t::zfp and H5Tget_class(ty) == H5T_FLOAT and H5Tget_size(ty) == 8 and rank <= 4
+       and H5Zfilter_avail(write_policy::filter_zfp) > 0;
+  }
+
+  // The type in the file of an array of type ty, following the precision of the write policy p
+  static datatype storage_type(int rank, datatype const &ty, bool compress, write_policy const &p) {
+    if (p.precision == write_policy::precision_t::native or not compress or rank == 0) return ty;
+    if (H5Tget_class(ty) != H5T_FLOAT or H5Tget_size(ty) <= H5Tget_size(hdf5_type<float>())) return ty;
+    if (uses_zfp(rank, ty, p)) return ty;
+    return hdf5_type<float>();
+  }
+
+  //------------------------------------------------
+  // property list for the creation of a dataset of dimensions dims, following the write policy p
+  static proplist make_dcpl(int rank, hsize_t const *dims, datatype const &ty, bool compress, write_policy const &p) {
+    if (not compress or (rank == 0)) return H5P_DEFAULT;
+
+    size_t type_size = H5Tget_size(ty);
+    size_t total_size = std::accumulate(dims, dims + rank, type_size, std::multiplies<>{});
+    if (total_size < p.contiguous_threshold) return H5P_DEFAULT;
+
+    proplist cparms = H5Pcreate(H5P_DATASET_CREATE);
+    auto chunk_dims = make_chunk_dims(rank, dims, type_size, p);
+    H5Pset_chunk(cparms, rank, chunk_dims.data());
+
+    // ZFP in accuracy mode (cf. H5Pset_zfp_accuracy_cdata in H5Zzfp_plugin.h) : the mode, 0, the accuracy as a double
+    if (uses_zfp(rank, ty, p)) {
+      std::array<unsigned, 4> cd = {3, 0, 0, 0};
+      std::memcpy(&cd[2], &p.zfp_accuracy, sizeof(double));
+      if (H5Pset_filter(cparms, write_policy::filter_zfp, H5Z_FLAG_MANDATORY, cd.size(), cd.data()) < 0)
+        throw std::runtime_error("Cannot set the ZFP filter of the dataset creation property list");
+      return cparms;
+    }
+
+    using filter_t = write_policy::filter_t;
+    auto filter    = p.filter;
+    if (filter == filter_t::registered and H5Zfilter_avail(p.filter_id) <= 0) filter = filter_t::deflate;
+
+    herr_t err = 0;
+    switch (filter) {
+      case filter_t::none: break;
+      case filter_t::shuffle_deflate: err = H5Pset_shuffle(cparms); [[fallthrough]];
+      case filter_t::deflate:
+        if (err >= 0) err = H5Pset_deflate(cparms, p.deflate_level);
+        break;
+      case filter_t::registered: err = H5Pset_filter(cparms, p.filter_id, H5Z_FLAG_OPTIONAL, p.cd_values.size(), p.cd_values.data()); break;
+    }
+    if (err < 0) throw std::runtime_error("Cannot set the filters of the dataset creation property list");
+    return cparms;
+  }
+
+  //------------------------------------------------
+  // transfer property list for the writes of slices : collective if the file is opened with MPI-IO
+  static proplist make_slice_dxpl([[maybe_unused]] group const &g) {
+#ifdef H5_HAVE_PARALLEL
+    if (g.get_file().is_parallel()) {
+      proplist dxpl = H5Pcreate(H5P_DATASET_XFER);
+      if (H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE) < 0) throw std::runtime_error("Cannot set the collective MPI-IO transfer mode");
+      return dxpl;
+    }
+#endif
+    return H5P_DEFAULT;
+  }
+
   //------------------------------------------------
 
   std::pair<v_t, v_t> get_L_tot_and_strides_h5(long const *stri, int rank, long total_size) {
@@ -69,44 +185,212 @@ namespace h5::array_interface {
   //                    write
   //-------------------------------------------------------
 
-  void write(group g, std::string const &name, h5_array_view const &v, bool compress) {
+  // The attribute holding the content hash of a dataset (cf. write_policy::skip_unchanged)
+  static constexpr const char *content_hash_attribute = "__xxh64__";
+
+  // Is g[name] a dataset with the content hash h, the type file_ty, the shape of v, and the same __complex__ attribute ?
+  static bool is_unchanged(group const &g, std::string const &name, h5_array_view const &v, datatype const &file_ty, std::uint64_t h) {
+    if (not g.has_dataset(name)) return false;
+    dataset ds = g.open_dataset(name);
+    if (H5Aexists(ds, content_hash_attribute) <= 0) return false;
 
-    g.unlink(name);
+    std::uint64_t stored = 0;
+    read_attribute(ds, content_hash_attribute, {hdf5_type<unsigned long long>(), &stored, 0, false});
+    if (stored != h) return false;
 
-    // Some properties for the dataset : add compression
-    proplist cparms = H5P_DEFAULT;
-    if (compress and (v.rank() != 0)) {
-      int n_dims = v.rank();
-      std::vector<hsize_t> chunk_dims(n_dims);
-      for (int i = 0; i < v.rank(); ++i) chunk_dims[i] = std::max(v.slab.count[i], hsize_t{1});
-      cparms = H5Pcreate(H5P_DATASET_CREATE);
-      H5Pset_chunk(cparms, n_dims, chunk_dims.data());
-      H5Pset_deflate(cparms, 1);
+    datatype ty = H5Dget_type(ds);
+    if (H5Tequal(ty, file_ty) <= 0) return false;
+
+    dataspace sp = H5Dget_space(ds);
+    v_t dims(H5Sget_simple_extent_ndims(sp));
+    H5Sget_simple_extent_dims(sp, dims.data(), nullptr);
+    if (dims != v.slab.count) return false;
+
+    return (H5Aexists(ds, "__complex__") > 0) == v.is_complex;
+  }
+
+  // Remove the content hash of a dataset whose content is changed in part, e.g. by write_slice or append
+  static void drop_content_hash(dataset const &ds, std::string const &name) {
+    if (H5Aexists(ds, content_hash_attribute) > 0 and H5Adelete(ds, content_hash_attribute) < 0)
+      throw std::runtime_error("h5 : cannot remove the content hash of the dataset " + name);
+  }
+
+  void write(group const &g, std::string const &name, h5_array_view const &v, bool compress) {
+    hdf5_lock lock;
+
+    // The type in the file, e.g. float for a double array stored in single precision
+    auto const &policy = g.get_write_policy();
+    datatype file_ty   = storage_type(v.rank(), v.ty, compress, policy);
+
+    // Incremental mode : an unchanged dataset is not written again
+    std::optional<std::uint64_t> hash;
+    if (policy.skip_unchanged) {
+      hash = content_hash(v);
+      if (hash and is_unchanged(g, name, v, file_ty, *hash)) {
+        H5_TRACE_SCOPE(sc, g.get_file().get_stats(), write_skipped, name);
+        H5_TRACE(sc.bytes = selected_bytes(make_mem_dspace(v), v.ty));
+        return;
+      }
     }
 
+    // Some properties for the dataset : add compression
+    proplist cparms = make_dcpl(v.rank(), v.slab.count.data(), file_ty, compress, policy);
+
     // dataspace for the dataset in the file
     dataspace file_dspace = H5Screate_simple(v.slab.rank(), v.slab.count.data(), nullptr);
 
-    // create the dataset in the file
-    dataset ds = H5Dcreate2(g, name.c_str(), v.ty, file_dspace, H5P_DEFAULT, cparms, H5P_DEFAULT);
-    if (!ds.is_valid()) throw std::runtime_error("Cannot create the dataset " + name + " in the group " + g.name());
+    // create the dataset in the file (or reuse it, cf. write_policy::in_place_overwrite)
+    dataset ds = g.create_dataset(name, file_ty, file_dspace, cparms);
 
     // memory data space
     dataspace mem_dspace = make_mem_dspace(v);
     if (H5Sget_simple_extent_npoints(mem_dspace) > 0) { // avoid writing empty arrays
-      herr_t err = H5Dwrite(ds, v.ty, mem_dspace, H5S_ALL, H5P_DEFAULT, v.start);
-      if (err < 0) throw std::runtime_error("Error writing the scalar dataset " + name + " in the group" + g.name());
+      H5_TRACE_SCOPE(sc, g.get_file().get_stats(), write, name);
+      H5_TRACE(sc.bytes = selected_bytes(mem_dspace, v.ty); sc.filtered = (H5Pget_nfilters(cparms) > 0));
+      auto n_threads = policy.n_threads;
+      if (n_threads == 1 or not write_chunks(ds, v, n_threads)) {
+        herr_t err = H5Dwrite(ds, v.ty, mem_dspace, H5S_ALL, H5P_DEFAULT, v.start);
+        if (err < 0) throw std::runtime_error("Error writing the scalar dataset " + name + " in the group" + g.name());
+      }
     }
 
     // If we are dealing with complex, we had the attribute
-    if (v.is_complex) h5_write_attribute(ds, "__complex__", "1");
+    if (v.is_complex) h5_write_attribute_fixed_size(ds, "__complex__", "1");
+
+    if (hash) write_attribute(ds, content_hash_attribute, {hdf5_type<unsigned long long>(), &*hash, 0, false});
+  }
+
+  //-------------------------------------------------------------
+
+  void create_dataset(group const &g, std::string const &name, h5_lengths_type const &lt, bool compress) {
+    hdf5_lock lock;
+
+    proplist cparms       = make_dcpl(lt.rank(), lt.lengths.data(), lt.ty, compress, g.get_write_policy());
+    dataspace file_dspace = (lt.rank() == 0 ? H5Screate(H5S_SCALAR) : H5Screate_simple(lt.rank(), lt.lengths.data(), nullptr));
+
+    dataset ds = g.create_dataset(name, lt.ty, file_dspace, cparms);
+
+    if (lt.has_complex_attribute) h5_write_attribute_fixed_size(ds, "__complex__", "1");
+  }
+
+  //-------------------------------------------------------------
+
+  void write_slice(group const &g, std::string const &name, h5_array_view const &v, h5_lengths_type const &lt, hyperslab const &sl) {
+    hdf5_lock lock;
+
+    if (sl.empty()) throw std::runtime_error("h5 write_slice of dataset " + name + " : empty hyperslab");
+
+    if (H5Tget_class(v.ty) != H5Tget_class(lt.ty))
+      throw std::runtime_error("Incompatible types in h5 write_slice. Writing a " + get_name_of_h5_type(v.ty)
+                               + " into a dataset of type " + get_name_of_h5_type(lt.ty));
+
+    if (v.is_complex != lt.has_complex_attribute)
+      throw std::runtime_error("h5 write_slice of dataset " + name + " : mismatch of complex and real data");
+
+    dataset ds            = (lt.ds.is_valid() ? lt.ds : g.open_dataset(name));
+    dataspace file_dspace = make_file_dspace(ds, sl, name);
+    dataspace mem_dspace  = make_mem_dspace(v);
+
+    if (H5Sget_select_npoints(mem_dspace) != H5Sget_select_npoints(file_dspace))
+      throw std::runtime_error("h5 write_slice of dataset " + name + " : size mismatch between the array and the hyperslab");
+
+    // In collective mode, every rank takes part in the write, possibly with an empty selection
+    proplist dxpl = make_slice_dxpl(g);
+    bool empty    = (H5Sget_select_npoints(file_dspace) == 0);
+    if (empty and (dxpl == H5P_DEFAULT)) return;
+    if (empty) {
+      H5Sselect_none(mem_dspace);
+      H5Sselect_none(file_dspace);
+    }
+    drop_content_hash(ds, name);
+
+    H5_TRACE_SCOPE(sc, g.get_file().get_stats(), write, name);
+    H5_TRACE(sc.bytes = selected_bytes(mem_dspace, v.ty); sc.filtered = is_filtered(ds));
+    herr_t err = H5Dwrite(ds, v.ty, mem_dspace, file_dspace, dxpl, v.start);
+    if (err < 0) throw std::runtime_error("Error writing the slice of dataset " + name + " in the group" + g.name());
+  }
+
+  //-------------------------------------------------------------
+
+  // Approximate size in bytes of the chunks of the appendable datasets, and maximal number of rows of a chunk
+  constexpr hsize_t append_chunk_bytes    = 64 * 1024;
+  constexpr hsize_t append_chunk_max_rows = 16 * 1024;
+
+  void append(group const &g, std::string const &name, h5_array_view const &v) {
+    hdf5_lock lock;
+
+    if (v.rank() - v.is_complex == 0) throw std::runtime_error("h5 append to dataset " + name + " : can not append a scalar view, it needs a leading dimension");
+
+    // first call : create the dataset with an unlimited leading dimension
+    if (not g.has_key(name)) {
+      int rank = v.rank();
+      v_t dims = v.slab.count, maxdims = v.slab.count, chunk_dims = v.slab.count;
+      dims[0]    = 0;
+      maxdims[0] = H5S_UNLIMITED;
+
+      // The filters and precision of the write policy. The dataset is always chunked, whatever its size.
+      auto policy                 = g.get_write_policy();
+      policy.contiguous_threshold = 0;
+      datatype file_ty            = storage_type(rank, v.ty, true, policy);
+
+      // chunk along the leading dimension : about append_chunk_bytes, whatever the size of the first view,
+      // so that the later appends only touch the last chunks. A large first view spans several chunks.
+      hsize_t row_bytes = H5Tget_size(file_ty);
+      for (int i = 1; i < rank; ++i) {
+        chunk_dims[i] = std::max(chunk_dims[i], hsize_t{1});
+        row_bytes *= chunk_dims[i];
+      }
+      chunk_dims[0] = std::clamp(append_chunk_bytes / row_bytes, hsize_t{1}, append_chunk_max_rows);
+
+      proplist cparms = make_dcpl(rank, chunk_dims.data(), file_ty, true, policy);
+      H5Pset_chunk(cparms, rank, chunk_dims.data());
+
+      dataspace file_dspace = H5Screate_simple(rank, dims.data(), maxdims.data());
+      dataset ds            = g.create_dataset(name, file_ty, file_dspace, cparms);
+      if (v.is_complex) h5_write_attribute_fixed_size(ds, "__complex__", "1");
+    }
+
+    auto lt    = get_h5_lengths_type(g, name);
+    dataset ds = lt.ds;
+
+    // Checks
+    if (H5Tget_class(v.ty) != H5Tget_class(lt.ty))
+      throw std::runtime_error("Incompatible types in h5 append. Appending a " + get_name_of_h5_type(v.ty) + " to a dataset of type "
+                               + get_name_of_h5_type(lt.ty));
+
+    if (v.is_complex != lt.has_complex_attribute)
+      throw std::runtime_error("h5 append to dataset " + name + " : mismatch of complex and real data");
+
+    if (lt.rank() != v.rank())
+      throw std::runtime_error("h5 append to dataset " + name + " : rank mismatch : the dataset has rank " + std::to_string(lt.rank())
+                               + " while the array has rank " + std::to_string(v.rank()));
+
+    if (not std::equal(lt.lengths.begin() + 1, lt.lengths.end(), v.slab.count.begin() + 1))
+      throw std::runtime_error("h5 append to dataset " + name + " : lengths mismatch in the non-leading dimensions");
+
+    // extend the dataset, and write the new data at the end of the leading dimension
+    v_t new_dims = lt.lengths;
+    new_dims[0] += v.slab.count[0];
+    drop_content_hash(ds, name);
+    if (H5Dset_extent(ds, new_dims.data()) < 0) throw std::runtime_error("h5 append : cannot extend the dataset " + name + ". Is it appendable ?");
+
+    hyperslab sl(v.rank(), false);
+    sl.offset[0] = lt.lengths[0];
+    sl.count     = v.slab.count;
+    write_slice(g, name, v, get_h5_lengths_type(ds), sl);
+
+    // In SWMR mode, the readers see the new data once the dataset is flushed
+    if (g.get_file().is_swmr()) {
+      if (H5Dflush(ds) < 0) throw std::runtime_error("h5 append : cannot flush the dataset " + name);
+    }
   }
 
   //-------------------------------------------------------------
 
-  void write_attribute(object obj, std::string const &name, h5_array_view v) {
+  void write_attribute(object const &obj, std::string const &name, h5_array_view v) {
+    hdf5_lock lock;
 
-    if (H5LTfind_attribute(obj, name.c_str()) != 0) throw std::runtime_error("The attribute " + name + " is already present. Can not overwrite");
+    if (H5Aexists(obj, name.c_str()) != 0) throw std::runtime_error("The attribute " + name + " is already present. Can not overwrite");
 
     dataspace mem_dspace = make_mem_dspace(v);
 
@@ -121,11 +405,14 @@ namespace h5::array_interface {
   //                    READ
   //-------------------------------------------------------
 
-  h5_lengths_type get_h5_lengths_type(group g, std::string const &name) {
+  h5_lengths_type get_h5_lengths_type(group const &g, std::string const &name, access_hint hint) {
+    return get_h5_lengths_type(g.open_dataset(name, hint));
+  }
 
-    dataset ds = g.open_dataset(name);
+  h5_lengths_type get_h5_lengths_type(dataset ds) {
+    hdf5_lock lock;
 
-    bool has_complex_attribute = H5LTfind_attribute(ds, "__complex__"); // the array in file should be interpreted as a complex
+    bool has_complex_attribute = (H5Aexists(ds, "__complex__") > 0); // the array in file should be interpreted as a complex
     dataspace dspace           = H5Dget_space(ds);
     int rank                   = H5Sget_simple_extent_ndims(dspace);
 
@@ -135,41 +422,106 @@ namespace h5::array_interface {
 
     //  get the type from the file
     datatype ty = H5Dget_type(ds);
-    return {std::move(dims_out), ty, has_complex_attribute};
+    return {std::move(dims_out), ty, has_complex_attribute, std::move(ds)};
   }
 
   //--------------------------------------------------------
 
-  void read(group g, std::string const &name, h5_array_view v, h5_lengths_type lt) {
+  // The view v of complex numbers, as a view of rank - 1 of the compound {r, i}
+  static h5_array_view complex_as_compound(h5_array_view const &v) {
+    size_t s = H5Tget_size(v.ty);
+    h5_array_view res{make_compound_type(2 * s, {{"r", 0, v.ty}, {"i", s, v.ty}}), v.start, v.rank() - 1, false};
+    std::copy_n(v.L_tot.begin(), res.rank(), res.L_tot.begin());
+    std::copy_n(v.slab.offset.begin(), res.rank(), res.slab.offset.begin());
+    std::copy_n(v.slab.stride.begin(), res.rank(), res.slab.stride.begin());
+    std::copy_n(v.slab.count.begin(), res.rank(), res.slab.count.begin());
+    if (not v.slab.block.empty()) res.slab.block.assign(v.slab.block.begin(), v.slab.block.begin() + res.rank());
+    return res;
+  }
 
-    dataset ds            = g.open_dataset(name);
-    dataspace file_dspace = H5Dget_space(ds);
+  // Can HDF5 convert the file type ft to the memory type mt without loss ?
+  // I.e. a float widened to a wider float (e.g. a double array stored with precision_t::float32),
+  // or an integer to a wider integer (e.g. int32 indices written by scipy, read into long).
+  static bool is_widening(datatype const &mt, datatype const &ft) {
+    auto cls = H5Tget_class(mt);
+    if (cls != H5Tget_class(ft)) return false;
+    auto ms = H5Tget_size(mt), fs = H5Tget_size(ft);
+    if (cls == H5T_FLOAT) return ms >= fs;
+    if (cls != H5T_INTEGER) return false;
+    auto msign = H5Tget_sign(mt), fsign = H5Tget_sign(ft);
+    return (msign == fsign and ms >= fs) or (msign == H5T_SGN_2 and fsign == H5T_SGN_NONE and ms > fs);
+  }
+
+  void read(group const &g, std::string const &name, h5_array_view v, h5_lengths_type const &lt, hyperslab const &sl) {
+    hdf5_lock lock;
+
+    dataset ds            = (lt.ds.is_valid() ? lt.ds : g.open_dataset(name));
+    dataspace file_dspace = make_file_dspace(ds, sl, name);
+
+    // Complex numbers can also be read from a compound {r, i} (cf. dcplx_t), or from real numbers,
+    // with a single H5Dread : with the compound as memory type, or into the real parts only.
+    bool real_into_complex = false;
+    if (v.is_complex and not lt.has_complex_attribute and lt.rank() == v.rank() - 1) {
+      if (H5Tget_class(lt.ty) == H5T_COMPOUND)
+        v = complex_as_compound(v);
+      else {
+        real_into_complex = true;
+        std::cerr << "WARNING: Mismatching types in h5_read. Expecting a complex " + get_name_of_h5_type(v.ty)
+              + " while the array stored in the hdf5 file has type " + get_name_of_h5_type(lt.ty) + "\n";
+      }
+    }
 
     // Checks
     if (H5Tget_class(v.ty) != H5Tget_class(lt.ty))
       throw std::runtime_error("Incompatible types in h5_read. Expecting a " + get_name_of_h5_type(v.ty)
                                + " while the array stored in the hdf5 file has type " + get_name_of_h5_type(lt.ty));
 
-    if (not hdf5_type_equal(v.ty, lt.ty))
+    // NB : compound members are converted by name, a different layout is not a mismatch
+    if ((H5Tget_class(lt.ty) != H5T_COMPOUND) and not real_into_complex and not hdf5_type_equal(v.ty, lt.ty) and not is_widening(v.ty, lt.ty))
       std::cerr << "WARNING: Mismatching types in h5_read. Expecting a " + get_name_of_h5_type(v.ty)
             + " while the array stored in the hdf5 file has type " + get_name_of_h5_type(lt.ty) + "\n";
 
-    if (lt.rank() != v.rank())
-      throw std::runtime_error("h5 read. Rank mismatch : expecting in file a rank " + std::to_string(v.rank())
+    int rank = v.rank() - real_into_complex;
+    if (lt.rank() != rank)
+      throw std::runtime_error("h5 read. Rank mismatch : expecting in file a rank " + std::to_string(rank)
                                + " while the array stored in the hdf5 file has rank " + std::to_string(lt.rank()));
 
-    if (lt.lengths != v.slab.count) throw std::runtime_error("h5 read. Lengths mismatch");
+    v_t count = v.slab.count;
+    if (real_into_complex) {
+      // Select the real parts only, and set the imaginary parts to 0
+      count.pop_back();
+      v.slab.count.back()       = 1;
+      v.slab.offset.back()      = 1;
+      alignas(16) char zero[32] = {};
+      if (H5Tget_size(v.ty) > sizeof(zero)) throw std::runtime_error("h5 read of real numbers into complex : type is too large");
+      if (H5Dfill(zero, v.ty, v.start, v.ty, make_mem_dspace(v)) < 0) throw std::runtime_error("Cannot set the imaginary parts in h5 read of " + name);
+      v.slab.offset.back() = 0;
+    }
 
     dataspace mem_dspace = make_mem_dspace(v);
-    if (H5Sget_simple_extent_npoints(file_dspace) > 0) {
-      herr_t err = H5Dread(ds, v.ty, mem_dspace, file_dspace, H5P_DEFAULT, v.start);
-      if (err < 0) throw std::runtime_error("Error reading the scalar dataset " + name + " in the group " + g.name());
+
+    if (sl.empty()) {
+      if (lt.lengths != count) throw std::runtime_error("h5 read. Lengths mismatch");
+    } else {
+      if (H5Sget_select_npoints(mem_dspace) != H5Sget_select_npoints(file_dspace))
+        throw std::runtime_error("h5 read of a slice of dataset " + name + " : size mismatch between the array and the hyperslab");
+    }
+
+    if (H5Sget_select_npoints(file_dspace) > 0) {
+      H5_TRACE_SCOPE(sc, g.get_file().get_stats(), read, name);
+      H5_TRACE(sc.bytes = selected_bytes(mem_dspace, v.ty));
+      auto n_threads = g.get_write_policy().n_threads;
+      if (n_threads == 1 or not sl.empty() or real_into_complex or not read_chunks(ds, v, lt, n_threads)) {
+        herr_t err = H5Dread(ds, v.ty, mem_dspace, file_dspace, H5P_DEFAULT, v.start);
+        if (err < 0) throw std::runtime_error("Error reading the scalar dataset " + name + " in the group " + g.name());
+      }
     }
   }
 
   //-------------------------------------------------------------
 
-  void read_attribute(object obj, std::string const &name, h5_array_view v) {
+  void read_attribute(object const &obj, std::string const &name, h5_array_view v) {
+    hdf5_lock lock;
 
     //if (v.rank() != 0) throw std::runtime_error("Non scalar attribute not implemented");
 
@@ -188,4 +540,83 @@ namespace h5::array_interface {
     if (err < 0) throw std::runtime_error("Cannot read the attribute " + name);
   }
 
+  //-------------------------------------------------------
+  //                    MAP
+  //-------------------------------------------------------
+
+  // Why ds can not be mapped ("" if it can). Otherwise, set the position of its data in the file.
+  static std::string why_not_mappable(dataset const &ds, h5_lengths_type const &lt, haddr_t &file_offset) {
+#ifndef H5_HAS_MMAP
+    return "memory mapping is not available on this platform";
+#else
+    object fi       = H5Iget_file_id(ds);
+    unsigned intent = 0;
+    H5Fget_intent(fi, &intent);
+    if (intent & H5F_ACC_RDWR) return "the file is not opened read-only";
+
+    proplist fapl = H5Fget_access_plist(fi);
+    if (H5Pget_driver(fapl) != H5FD_SEC2) return "the file is not a plain file on disk";
+
+    // The data in file must be usable as is in memory
+    if (H5Tis_variable_str(lt.ty) > 0 or H5Tdetect_class(lt.ty, H5T_VLEN) > 0 or H5Tdetect_class(lt.ty, H5T_REFERENCE) > 0)
+      return "the type of the dataset has variable length";
+    datatype native = H5Tget_native_type(lt.ty, H5T_DIR_DEFAULT);
+    if (H5Tequal(native, lt.ty) <= 0) return "the type of the dataset is not native";
+
+    // An empty dataset has an empty view, whatever its layout
+    dataspace dspace = H5Dget_space(ds);
+    if (H5Sget_simple_extent_npoints(dspace) == 0) {
+      file_offset = 0;
+      return "";
+    }
+
+    proplist dcpl = H5Dget_create_plist(ds);
+    if (H5Pget_layout(dcpl) != H5D_CONTIGUOUS) return "the dataset is not contiguous";
+    if (H5Pget_nfilters(dcpl) > 0) return "the dataset is filtered";
+
+    haddr_t addr = H5Dget_offset(ds);
+    if (addr == HADDR_UNDEF) return "the dataset has no storage allocated";
+
+    file_offset = addr;
+    return "";
+#endif
+  }
+
+  bool is_mappable(group const &g, std::string const &name) {
+    hdf5_lock lock;
+    auto lt        = get_h5_lengths_type(g, name);
+    haddr_t offset = 0;
+    return why_not_mappable(lt.ds, lt, offset).empty();
+  }
+
+  mapped_dataset map_dataset(group const &g, std::string const &name) {
+    hdf5_lock lock;
+    auto lt        = get_h5_lengths_type(g, name);
+    haddr_t offset = 0;
+    if (auto why = why_not_mappable(lt.ds, lt, offset); not why.empty())
+      throw std::runtime_error("Cannot map the dataset " + name + " in the group " + g.name() + " : " + why);
+
+    size_t size = H5Dget_storage_size(lt.ds);
+    if (size == 0) return {nullptr, std::move(lt), {}};
+
+#ifdef H5_HAS_MMAP
+    // mmap requires an offset aligned on pages
+    size_t page     = sysconf(_SC_PAGESIZE);
+    size_t shift    = offset % page;
+    size_t map_size = size + shift;
+
+    auto fname = g.get_file().name();
+    int fd     = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot map the dataset " + name + " : cannot open the file " + fname);
+    void *p = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, off_t(offset - shift));
+    ::close(fd); // the mapping keeps the file
+    if (p == MAP_FAILED) throw std::runtime_error("Cannot map the dataset " + name + " : mmap failed");
+
+    auto handle = std::shared_ptr<void const>(p, [map_size](void const *q) { ::munmap(const_cast<void *>(q), map_size); });
+    return {static_cast<char const *>(p) + shift, std::move(lt), std::move(handle)};
+#else
+    return {};
+#endif
+  }
+
 } // namespace h5::array_interface
@@ -17,6 +17,10 @@
 #ifndef LIBH5_ARRAY_INTERFACE_HPP
 #define LIBH5_ARRAY_INTERFACE_HPP
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <string>
@@ -31,6 +35,7 @@ namespace h5::array_interface {
     v_t lengths;
     datatype ty;
     bool has_complex_attribute;
+    dataset ds = {}; // The open dataset (if any), reused by read and write_slice
 
     //
     [[nodiscard]] int rank() const { return lengths.size(); }
@@ -54,8 +59,14 @@ namespace h5::array_interface {
       }
     }
 
+    // An empty hyperslab, i.e. select the whole dataspace
+    hyperslab() = default;
+
     //
     [[nodiscard]] int rank() const { return count.size(); }
+
+    //
+    [[nodiscard]] bool empty() const { return count.empty(); }
   };
 
   // Stores a view of an array.
@@ -86,19 +97,111 @@ namespace h5::array_interface {
   std::pair<v_t, v_t> get_L_tot_and_strides_h5(long const *stri, int rank, long total_size);
 
   // Retrieve lengths and hdf5 type from a dataset g[name] or attribute obj[name]
-  h5_lengths_type get_h5_lengths_type(group g, std::string const &name);
+  // The dataset is kept open in the result, with the chunk cache sized for the access pattern hint.
+  h5_lengths_type get_h5_lengths_type(group const &g, std::string const &name, access_hint hint = access_hint::none);
+
+  // Retrieve lengths and hdf5 type from an open dataset
+  h5_lengths_type get_h5_lengths_type(dataset ds);
 
   // Write the view of the array to the group
-  void write(group g, std::string const &name, h5_array_view const &a, bool compress);
+  void write(group const &g, std::string const &name, h5_array_view const &a, bool compress);
+
+  // Create a dataset g[name] of the shape and type given by lt, without writing any data.
+  // To be filled later with write_slice.
+  void create_dataset(group const &g, std::string const &name, h5_lengths_type const &lt, bool compress);
+
+  // Write the view of the array into the hyperslab sl of the existing dataset g[name]
+  // lt is the shape and type of the dataset, as returned by get_h5_lengths_type (its dataset is reused if open)
+  void write_slice(group const &g, std::string const &name, h5_array_view const &v, h5_lengths_type const &lt, hyperslab const &sl);
+
+  // Append the view of the array to the dataset g[name] along its leading dimension.
+  // If the dataset does not exist, it is created chunked, with an unlimited leading dimension.
+  // The other dimensions of the view must match those of the dataset.
+  void append(group const &g, std::string const &name, h5_array_view const &v);
 
   // Read into an array_view from the group
-  void read(group g, std::string const &name, h5_array_view v, h5_lengths_type lt);
+  // If the hyperslab sl is not empty, only this part of the dataset is read.
+  // If lt holds an open dataset, it is read directly, without opening g[name] again.
+  // E.g. for the tiles of a chunked dataset, lt = get_h5_lengths_type(g, name, hint) is reused for all the reads, with its chunk cache.
+  void read(group const &g, std::string const &name, h5_array_view v, h5_lengths_type const &lt, hyperslab const &sl = {});
+
+  // A read of read_batch : the dataset g[name], or its hyperslab sl if not empty, into v
+  struct read_request {
+    std::string name;
+    h5_array_view v;
+    hyperslab sl = {};
+  };
+
+  struct read_batch_options {
+    bool readahead  = false;   // Hint the OS to read ahead the ranges of the contiguous datasets (posix_fadvise, for a file on disk)
+    hsize_t max_gap = 1 << 16; // Two contiguous datasets less than max_gap bytes apart are in the same range
+  };
+
+  // The order of the reads of read_batch
+  struct read_plan {
+    std::vector<h5_lengths_type> lts;                // the shape and type of the datasets, in the order of the requests
+    std::vector<size_t> order;                       // the requests in the order of their data in the file
+    std::vector<std::pair<hsize_t, hsize_t>> ranges; // the (offset, size) in the file of the contiguous datasets, coalesced
+  };
+
+  // Open all the datasets of the requests and sort them by the position of their data in the file :
+  // the offset of a contiguous dataset, of its first chunk for a chunked dataset. The others (e.g. compact) are read last.
+  read_plan plan_read_batch(group const &g, std::vector<read_request> const &reqs, hsize_t max_gap = read_batch_options{}.max_gap);
+
+  // Read all the requests, in the order of the file (cf. plan_read_batch), e.g. many datasets for a restart.
+  void read_batch(group const &g, std::vector<read_request> const &reqs, read_batch_options const &opts = {});
+
+  // Format of a sparse matrix stored in compressed sparse row format (cf. write_sparse_csr)
+  inline constexpr const char *sparse_csr_format = "SparseCSR";
+
+  // A view of a sparse matrix in compressed sparse row (CSR) format, as scipy.sparse.csr_matrix :
+  // the non-zero elements of row i are in the columns indices[indptr[i]:indptr[i+1]], with the values data[indptr[i]:indptr[i+1]]
+  struct sparse_csr_view {
+    std::array<long, 2> shape; // number of rows and of columns
+    h5_array_view indptr;      // 1d, number of rows + 1 integers, from 0 to nnz
+    h5_array_view indices;     // 1d, nnz integers
+    h5_array_view data;        // 1d, nnz values
+  };
+
+  // Write the sparse matrix to the new subgroup g[name], with the Format "SparseCSR" and the 1d datasets shape, indptr, indices and data.
+  // A range of rows is read back with the hyperslabs of indptr, then of indices and data (cf. h5::read_csr_rows).
+  void write_sparse_csr(group const &g, std::string const &name, sparse_csr_view const &v, bool compress);
+
+  // Read the whole chunked dataset ds into v, decompressing its chunks on n_threads threads (0 : all hardware threads).
+  // The raw chunks are read with H5Dread_chunk. Only for the datasets filtered with deflate and/or shuffle, whose chunks are all
+  // written, and for a view with the type of the file. Returns false, without reading, otherwise.
+  bool read_chunks(dataset const &ds, h5_array_view const &v, h5_lengths_type const &lt, unsigned n_threads);
+
+  // Write v into the whole new chunked dataset ds, compressing its chunks on n_threads threads (0 : all hardware threads).
+  // The chunks are written with H5Dwrite_chunk. Same conditions as read_chunks. Returns false, without writing, otherwise.
+  bool write_chunks(dataset const &ds, h5_array_view const &v, unsigned n_threads);
+
+  // XXH64 hash of the n bytes at data (cf. https://github.com/Cyan4973/xxHash)
+  std::uint64_t xxh64(void const *data, std::size_t n, std::uint64_t seed = 0);
+
+  // Hash of the content of the view v, its shape and the size of its type (cf. write_policy::skip_unchanged).
+  // Empty for the types which do not hold their data in the view, e.g. variable length strings.
+  std::optional<std::uint64_t> content_hash(h5_array_view const &v);
+
+  // A read-only view of the data of a dataset, mapped in memory from the file (cf. map_dataset)
+  struct mapped_dataset {
+    void const *data = nullptr;         // start of the data, in C order, with the native layout of the type lt.ty. nullptr if empty
+    h5_lengths_type lt;                 // shape and type of the dataset
+    std::shared_ptr<void const> handle; // the mapping, released with its last copy. It does not depend on the h5::file
+  };
+
+  // True iff the dataset g[name] can be mapped by map_dataset :
+  // contiguous and unfiltered, with a native fixed-size type, in a file on disk opened read-only (mode 'r').
+  bool is_mappable(group const &g, std::string const &name);
+
+  // Map the dataset g[name] read-only in memory, without copying it. Throws if it is not mappable.
+  mapped_dataset map_dataset(group const &g, std::string const &name);
 
   // Write the view of the array to the attribute
-  void write_attribute(object obj, std::string const &name, h5_array_view v);
+  void write_attribute(object const &obj, std::string const &name, h5_array_view v);
 
   // Read into a contiguous array_view from the attribute
-  void read_attribute(object obj, std::string const &name, h5_array_view v);
+  void read_attribute(object const &obj, std::string const &name, h5_array_view v);
 
 } // namespace h5::array_interface
 
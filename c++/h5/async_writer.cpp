@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./async_writer.hpp"
+
+namespace h5 {
+
+  async_writer::async_writer(file f) : root{std::move(f)}, worker{[this]() { run(); }} {}
+
+  async_writer::~async_writer() {
+    {
+      std::lock_guard lock{mtx};
+      stopping = true;
+    }
+    cv_task.notify_one();
+    worker.join();
+  }
+
+  // ------------------------------------------------------------------
+
+  void async_writer::push(task_t task) {
+    {
+      std::lock_guard lock{mtx};
+      if (stopping) throw std::runtime_error("async_writer : write after the writer was stopped");
+      tasks.push_back(std::move(task));
+    }
+    cv_task.notify_one();
+  }
+
+  void async_writer::run() {
+    std::unique_lock lock{mtx};
+    while (true) {
+      cv_task.wait(lock, [this]() { return stopping or not tasks.empty(); });
+      if (tasks.empty()) return; // stopping, and all writes done
+
+      auto task = std::move(tasks.front());
+      tasks.pop_front();
+      busy = true;
+      lock.unlock();
+
+      std::exception_ptr err;
+      try {
+        task();
+      } catch (...) { err = std::current_exception(); }
+      // the snapshot is released on this thread, before the writer is seen idle
+      task = {};
+
+      lock.lock();
+      busy = false;
+      if (err and not error) {
+        error = err;
+        tasks.clear();
+      }
+      if (tasks.empty()) cv_idle.notify_all();
+    }
+  }
+
+  // ------------------------------------------------------------------
+
+  long async_writer::pending() {
+    std::lock_guard lock{mtx};
+    return long(tasks.size()) + (busy ? 1 : 0);
+  }
+
+  void async_writer::flush() {
+    std::exception_ptr err;
+    {
+      std::unique_lock lock{mtx};
+      cv_idle.wait(lock, [this]() { return tasks.empty() and not busy; });
+      std::swap(err, error);
+    }
+    if (err) std::rethrow_exception(err);
+    root.get_file().flush();
+  }
+
+} // namespace h5
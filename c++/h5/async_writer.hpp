@@ -0,0 +1,117 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_ASYNC_WRITER_HPP
+#define LIBH5_ASYNC_WRITER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "./group.hpp"
+
+namespace h5 {
+
+  /**
+   * Writes objects into a file from a dedicated I/O thread.
+   *
+   * write takes a snapshot of the object (a copy, or a move if an rvalue is given, move-only types included) and returns immediately.
+   * The writes are done in order by the I/O thread. flush() waits for all of them, flushes the file,
+   * and rethrows the first error of a write, if any. After an error, the pending writes are dropped.
+   *
+   * The file must not be used by other threads until flush() returns, unless HDF5 is threadsafe.
+   * The destructor waits for the pending writes, errors are then ignored : call flush() to see them.
+   */
+  class async_writer {
+
+    group root;
+
+    // A task of the I/O thread. Unlike std::function, it holds move-only callables, e.g. the snapshot of a std::unique_ptr.
+    class task_t {
+      struct base {
+        virtual ~base()           = default;
+        virtual void operator()() = 0;
+      };
+      template <typename F>
+      struct impl : base {
+        F f;
+        explicit impl(F &&f) : f(std::move(f)) {}
+        void operator()() override { f(); }
+      };
+      std::unique_ptr<base> p;
+
+      public:
+      task_t() = default;
+      template <typename F>
+      task_t(F f) : p(std::make_unique<impl<F>>(std::move(f))) {}
+      void operator()() { (*p)(); }
+    };
+
+    std::mutex mtx;
+    std::condition_variable cv_task, cv_idle;
+    std::deque<task_t> tasks;
+    bool busy = false, stopping = false;
+    std::exception_ptr error;
+    std::thread worker;
+
+    // enqueue a task for the I/O thread
+    void push(task_t task);
+
+    // the loop of the I/O thread
+    void run();
+
+    public:
+    /// Start the I/O thread writing into the file f
+    explicit async_writer(file f);
+
+    async_writer(async_writer const &)            = delete;
+    async_writer &operator=(async_writer const &) = delete;
+
+    ///
+    ~async_writer();
+
+    /**
+     * Write x as g[name] in the I/O thread
+     *
+     * @tparam T A copy or move constructible type, with h5_write
+     * @param g The group, in the file of the writer
+     * @param name Name of the object
+     * @param x The object to write, taken by value
+     */
+    template <typename T>
+    void write(group g, std::string name, T x) {
+      push([g = std::move(g), name = std::move(name), x = std::move(x)]() { h5_write(g, name, x); });
+    }
+
+    /// Write x as name in the top group of the file
+    template <typename T>
+    void write(std::string name, T x) {
+      write(root, std::move(name), std::move(x));
+    }
+
+    /// Number of writes not yet done
+    [[nodiscard]] long pending();
+
+    /// Wait for the pending writes, flush the file and rethrow the first error of the writes
+    void flush();
+  };
+
+} // namespace h5
+
+#endif // LIBH5_ASYNC_WRITER_HPP
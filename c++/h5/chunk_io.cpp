@@ -0,0 +1,390 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./array_interface.hpp"
+
+#include <hdf5.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace h5::array_interface {
+
+  namespace {
+
+    // A queue of bounded capacity between the thread calling HDF5 and the workers (de)compressing the chunks
+    template <typename T>
+    class bounded_queue {
+      std::mutex mtx;
+      std::condition_variable not_empty, not_full;
+      std::deque<T> q;
+      size_t capacity;
+      bool closed = false;
+
+      public:
+      explicit bounded_queue(size_t capacity) : capacity{capacity} {}
+
+      // false if the queue is closed
+      bool push(T x) {
+        std::unique_lock lock{mtx};
+        not_full.wait(lock, [this] { return closed or q.size() < capacity; });
+        if (closed) return false;
+        q.push_back(std::move(x));
+        not_empty.notify_one();
+        return true;
+      }
+
+      // Empty once the queue is closed and drained
+      std::optional<T> pop() {
+        std::unique_lock lock{mtx};
+        not_empty.wait(lock, [this] { return closed or not q.empty(); });
+        if (q.empty()) return {};
+        T x = std::move(q.front());
+        q.pop_front();
+        not_full.notify_one();
+        return x;
+      }
+
+      void close() {
+        std::lock_guard lock{mtx};
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+      }
+    };
+
+    // The first error of the workers, rethrown by the calling thread
+    struct first_error {
+      std::mutex mtx;
+      std::exception_ptr ptr;
+      std::atomic<bool> raised = false;
+
+      void set(std::exception_ptr e) {
+        std::lock_guard lock{mtx};
+        if (!ptr) ptr = std::move(e);
+        raised = true;
+      }
+      void rethrow() {
+        if (ptr) std::rethrow_exception(ptr);
+      }
+    };
+
+    //------------------------------------------------
+
+    // The filters of a chunked dataset, if it only uses shuffle and deflate
+    struct chunk_filters {
+      bool shuffle_first = false; // shuffle is applied before deflate
+      bool shuffle       = false;
+      bool deflate       = false;
+      int deflate_level  = 1;
+    };
+
+    std::optional<chunk_filters> get_chunk_filters(proplist const &dcpl) {
+      chunk_filters res;
+      int n = H5Pget_nfilters(dcpl);
+      if (n < 0) return {};
+      for (int i = 0; i < n; ++i) {
+        unsigned flags = 0, filter_config = 0, cd_values[8];
+        size_t cd_nelmts = 8;
+        auto id          = H5Pget_filter2(dcpl, i, &flags, &cd_nelmts, cd_values, 0, nullptr, &filter_config);
+        if (id == H5Z_FILTER_SHUFFLE) {
+          res.shuffle       = true;
+          res.shuffle_first = not res.deflate;
+        } else if (id == H5Z_FILTER_DEFLATE) {
+          res.deflate       = true;
+          res.deflate_level = (cd_nelmts > 0 ? int(cd_values[0]) : 1);
+        } else
+          return {};
+      }
+      if (res.shuffle and not res.shuffle_first) return {}; // unusual order : let HDF5 do it
+      return res;
+    }
+
+    // The byte shuffle of HDF5 : byte j of element i goes to j * n + i. The trailing bytes are left in place.
+    void shuffle(std::vector<char> &buf, size_t elem_size, bool forward) {
+      if (elem_size <= 1) return;
+      size_t n = buf.size() / elem_size;
+      std::vector<char> res(buf.size());
+      for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < elem_size; ++j) {
+          if (forward)
+            res[j * n + i] = buf[i * elem_size + j];
+          else
+            res[i * elem_size + j] = buf[j * n + i];
+        }
+      std::copy(buf.begin() + long(n * elem_size), buf.end(), res.begin() + long(n * elem_size));
+      buf.swap(res);
+    }
+
+    //------------------------------------------------
+
+    // The chunk grid of a dataset
+    struct chunk_grid {
+      v_t dims;   // dimensions of the dataset
+      v_t cdims;  // dimensions of a chunk
+      v_t counts; // number of chunks in each dimension
+
+      [[nodiscard]] int rank() const { return dims.size(); }
+
+      [[nodiscard]] hsize_t size() const {
+        hsize_t n = 1;
+        for (auto c : counts) n *= c;
+        return n;
+      }
+
+      [[nodiscard]] hsize_t chunk_elements() const {
+        hsize_t n = 1;
+        for (auto c : cdims) n *= c;
+        return n;
+      }
+
+      // The offset (in elements) in the dataset of the chunk number k, in C order
+      [[nodiscard]] v_t offset(hsize_t k) const {
+        v_t res(rank());
+        for (int d = rank() - 1; d >= 0; --d) {
+          res[d] = (k % counts[d]) * cdims[d];
+          k /= counts[d];
+        }
+        return res;
+      }
+    };
+
+    // Copy between a chunk at offset coff (C ordered, of dimensions cdims) and the view v.
+    // The parts of the chunk outside of the dataset are not touched.
+    void copy_chunk(chunk_grid const &gr, v_t const &coff, char *chunk, h5_array_view const &v, size_t es, bool to_view) {
+      int r = gr.rank();
+      v_t extent(r), cstride(r), mstride(r);
+      for (int d = 0; d < r; ++d) extent[d] = std::min(gr.cdims[d], gr.dims[d] - coff[d]);
+      cstride[r - 1] = mstride[r - 1] = 1;
+      for (int d = r - 2; d >= 0; --d) {
+        cstride[d] = cstride[d + 1] * gr.cdims[d + 1];
+        mstride[d] = mstride[d + 1] * v.L_tot[d + 1];
+      }
+
+      auto *mem         = static_cast<char *>(v.start);
+      hsize_t mem_step  = v.slab.stride[r - 1] * mstride[r - 1];
+      hsize_t row_bytes = extent[r - 1] * es;
+      v_t x(r, 0); // position in the chunk
+      while (true) {
+        hsize_t c = 0, m = 0;
+        for (int d = 0; d < r; ++d) {
+          c += x[d] * cstride[d];
+          m += (v.slab.offset[d] + (coff[d] + x[d]) * v.slab.stride[d]) * mstride[d];
+        }
+        char *cp = chunk + c * es;
+        char *mp = mem + m * es;
+        if (mem_step == 1) {
+          if (to_view)
+            std::memcpy(mp, cp, row_bytes);
+          else
+            std::memcpy(cp, mp, row_bytes);
+        } else {
+          for (hsize_t i = 0; i < extent[r - 1]; ++i) {
+            if (to_view)
+              std::memcpy(mp + i * mem_step * es, cp + i * es, es);
+            else
+              std::memcpy(cp + i * es, mp + i * mem_step * es, es);
+          }
+        }
+        // next row
+        int d = r - 2;
+        for (; d >= 0; --d) {
+          if (++x[d] < extent[d]) break;
+          x[d] = 0;
+        }
+        if (d < 0) break;
+      }
+    }
+
+    // The chunk grid and filters of ds, if its chunks can be (de)compressed by us to or from v
+    std::optional<std::pair<chunk_grid, chunk_filters>> get_chunk_layout(dataset const &ds, h5_array_view const &v, datatype const &file_ty) {
+      proplist dcpl = H5Dget_create_plist(ds);
+      if (H5Pget_layout(dcpl) != H5D_CHUNKED) return {};
+      auto filters = get_chunk_filters(dcpl);
+      if (not filters or not(filters->deflate or filters->shuffle)) return {};
+
+      // The chunks are copied byte for byte : the type of the view must be the type in the file
+      if (not hdf5_type_equal(v.ty, file_ty) or H5Tis_variable_str(file_ty) > 0 or H5Tget_class(file_ty) == H5T_VLEN) return {};
+
+      chunk_grid gr;
+      int r = v.rank();
+      if (r == 0 or H5Pget_chunk(dcpl, 0, nullptr) != r) return {};
+      gr.cdims.resize(r);
+      H5Pget_chunk(dcpl, r, gr.cdims.data());
+      gr.dims = v.slab.count;
+      gr.counts.resize(r);
+      for (int d = 0; d < r; ++d) gr.counts[d] = (gr.dims[d] + gr.cdims[d] - 1) / gr.cdims[d];
+      return std::make_pair(std::move(gr), *filters);
+    }
+
+    unsigned get_n_threads(unsigned n_threads, hsize_t n_chunks) {
+      if (n_threads == 0) n_threads = std::max(1u, std::thread::hardware_concurrency());
+      return unsigned(std::min<hsize_t>(n_threads, n_chunks));
+    }
+
+    // A raw chunk, as stored in the file
+    struct raw_chunk {
+      v_t offset;
+      uint32_t filter_mask = 0;
+      std::vector<char> data;
+    };
+
+  } // namespace
+
+  //-------------------------------------------------------
+  //                    read
+  //-------------------------------------------------------
+
+  bool read_chunks(dataset const &ds, h5_array_view const &v, h5_lengths_type const &lt, unsigned n_threads) {
+    hdf5_lock lock;
+
+    auto layout = get_chunk_layout(ds, v, lt.ty);
+    if (not layout) return false;
+    auto const &[gr, filters] = *layout;
+
+    // Unallocated chunks hold the fill value : let HDF5 do it
+    hsize_t n_chunks = 0;
+    dataspace dspace = H5Dget_space(ds);
+    if (H5Dget_num_chunks(ds, dspace, &n_chunks) < 0 or n_chunks != gr.size()) return false;
+
+    size_t es          = H5Tget_size(lt.ty);
+    size_t chunk_bytes = gr.chunk_elements() * es;
+    n_threads          = get_n_threads(n_threads, n_chunks);
+
+    // This thread reads the raw chunks (all HDF5 calls are made here), the workers decompress them into v
+    bounded_queue<raw_chunk> queue{2 * size_t(n_threads)};
+    first_error error;
+
+    auto decompress = [&]() {
+      std::vector<char> buf;
+      while (auto c = queue.pop()) {
+        if (error.raised) continue;
+        try {
+          bool deflated = filters.deflate and not(c->filter_mask & (filters.shuffle_first ? 2u : 1u));
+          bool shuffled = filters.shuffle and not(c->filter_mask & (filters.shuffle_first ? 1u : 2u));
+          if (deflated) {
+            buf.resize(chunk_bytes);
+            uLongf len = chunk_bytes;
+            if (uncompress(reinterpret_cast<Bytef *>(buf.data()), &len, reinterpret_cast<Bytef const *>(c->data.data()), c->data.size()) != Z_OK
+                or len != chunk_bytes)
+              throw std::runtime_error("Cannot inflate a chunk of the dataset");
+          } else
+            buf.swap(c->data);
+          if (shuffled) shuffle(buf, es, false);
+          if (buf.size() != chunk_bytes) throw std::runtime_error("Unexpected size of a chunk of the dataset");
+          copy_chunk(gr, c->offset, buf.data(), v, es, true);
+        } catch (...) { error.set(std::current_exception()); }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads);
+    for (unsigned i = 0; i < n_threads; ++i) workers.emplace_back(decompress);
+
+    try {
+      for (hsize_t k = 0; k < n_chunks and not error.raised; ++k) {
+        raw_chunk c{gr.offset(k), 0, {}};
+        hsize_t nbytes = 0;
+        if (H5Dget_chunk_storage_size(ds, c.offset.data(), &nbytes) < 0) throw std::runtime_error("Cannot get the size of a chunk of the dataset");
+        c.data.resize(nbytes);
+        if (H5Dread_chunk(ds, H5P_DEFAULT, c.offset.data(), &c.filter_mask, c.data.data()) < 0)
+          throw std::runtime_error("Cannot read a chunk of the dataset");
+        if (not queue.push(std::move(c))) break;
+      }
+    } catch (...) { error.set(std::current_exception()); }
+
+    queue.close();
+    for (auto &w : workers) w.join();
+    error.rethrow();
+    return true;
+  }
+
+  //-------------------------------------------------------
+  //                    write
+  //-------------------------------------------------------
+
+  bool write_chunks(dataset const &ds, h5_array_view const &v, unsigned n_threads) {
+    hdf5_lock lock;
+
+    datatype file_ty = H5Dget_type(ds);
+    auto layout      = get_chunk_layout(ds, v, file_ty);
+    if (not layout) return false;
+    auto const &[gr, filters] = *layout;
+
+    // The chunks are filled from the view, compressed by the workers, and written by this thread
+    size_t es          = H5Tget_size(file_ty);
+    size_t chunk_bytes = gr.chunk_elements() * es;
+    hsize_t n_chunks   = gr.size();
+    n_threads          = get_n_threads(n_threads, n_chunks);
+
+    bounded_queue<raw_chunk> queue{2 * size_t(n_threads)};
+    std::atomic<hsize_t> next = 0;
+    std::atomic<unsigned> running = n_threads;
+    first_error error;
+
+    auto compress = [&]() {
+      std::vector<char> buf;
+      try {
+        for (hsize_t k = next++; k < n_chunks and not error.raised; k = next++) {
+          raw_chunk c{gr.offset(k), 0, {}};
+          buf.assign(chunk_bytes, 0); // the parts outside of the dataset are 0
+          copy_chunk(gr, c.offset, buf.data(), v, es, false);
+          if (filters.shuffle) shuffle(buf, es, true);
+          if (filters.deflate) {
+            uLongf len = compressBound(chunk_bytes);
+            c.data.resize(len);
+            if (compress2(reinterpret_cast<Bytef *>(c.data.data()), &len, reinterpret_cast<Bytef const *>(buf.data()), chunk_bytes,
+                          filters.deflate_level)
+                != Z_OK)
+              throw std::runtime_error("Cannot deflate a chunk of the dataset");
+            c.data.resize(len);
+          } else
+            c.data.swap(buf);
+          if (not queue.push(std::move(c))) break;
+        }
+      } catch (...) { error.set(std::current_exception()); }
+      if (--running == 0) queue.close();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads);
+    for (unsigned i = 0; i < n_threads; ++i) workers.emplace_back(compress);
+
+    try {
+      while (auto c = queue.pop()) {
+        if (error.raised) continue;
+        if (H5Dwrite_chunk(ds, H5P_DEFAULT, 0, c->offset.data(), c->data.size(), c->data.data()) < 0)
+          throw std::runtime_error("Cannot write a chunk of the dataset");
+      }
+    } catch (...) {
+      error.set(std::current_exception());
+      queue.close();
+    }
+
+    for (auto &w : workers) w.join();
+    error.rethrow();
+    return true;
+  }
+
+} // namespace h5::array_interface
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./compact.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace h5::compact {
+
+  // The header : magic, format version, byte order
+  static constexpr std::array<char, 4> magic       = {'H', '5', 'C', 'S'};
+  static constexpr std::uint8_t little_endian_flag = (std::endian::native == std::endian::little ? 1 : 0);
+
+  ostream::ostream(size_t size_hint) {
+    buf.reserve(std::max<size_t>(size_hint, 16));
+    put_bytes(magic.data(), magic.size());
+    put_bytes(&format_version, 1);
+    put_bytes(&little_endian_flag, 1);
+  }
+
+  void ostream::put_size(std::size_t n) {
+    do {
+      auto b = std::uint8_t(n & 0x7f);
+      n >>= 7;
+      if (n != 0) b |= 0x80;
+      buf.push_back(std::byte(b));
+    } while (n != 0);
+  }
+
+  //-------------------------------------------------------
+
+  istream::istream(std::span<std::byte const> b) : buf(b) {
+    std::array<char, 4> m{};
+    std::uint8_t version = 0, little_endian = 0;
+    if (buf.size() < m.size() + 2) throw std::runtime_error("h5 compact deserialize : the buffer is too short");
+    get_bytes(m.data(), m.size());
+    if (m != magic) throw std::runtime_error("h5 compact deserialize : the buffer is not in the compact format");
+    get_bytes(&version, 1);
+    if (version != format_version)
+      throw std::runtime_error("h5 compact deserialize : the buffer has the format version " + std::to_string(version) + " instead of "
+                               + std::to_string(format_version));
+    get_bytes(&little_endian, 1);
+    if (little_endian != little_endian_flag) throw std::runtime_error("h5 compact deserialize : the buffer was written with another byte order");
+  }
+
+  void istream::get_bytes(void *p, size_t n) {
+    if (n > buf.size() - pos) throw std::runtime_error("h5 compact deserialize : unexpected end of the buffer");
+    if (n > 0) std::memcpy(p, buf.data() + pos, n);
+    pos += n;
+  }
+
+  void istream::expect_tag(tag_t t, const char *what) {
+    std::byte b{};
+    get_bytes(&b, 1);
+    if (tag_t(b) != t) throw std::runtime_error("h5 compact deserialize : expected a " + std::string(what) + " in the buffer");
+  }
+
+  std::size_t istream::get_size() {
+    std::size_t n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      std::uint8_t b = 0;
+      get_bytes(&b, 1);
+      n |= std::size_t(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) return n;
+    }
+    throw std::runtime_error("h5 compact deserialize : invalid size in the buffer");
+  }
+
+  std::size_t istream::get_length(std::size_t bytes_each) {
+    auto n = get_size();
+    if (n > (buf.size() - pos) / bytes_each) throw std::runtime_error("h5 compact deserialize : unexpected end of the buffer");
+    return n;
+  }
+
+  void istream::finish() const {
+    if (pos != buf.size()) throw std::runtime_error("h5 compact deserialize : " + std::to_string(buf.size() - pos) + " unread bytes at the end of the buffer");
+  }
+
+} // namespace h5::compact
@@ -0,0 +1,344 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_COMPACT_HPP
+#define LIBH5_COMPACT_HPP
+
+#include "./serialization.hpp"
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace h5 {
+
+  /**
+   * A compact binary format for the serialization of small objects, e.g. for MPI broadcasts (cf. serialize_compact).
+   *
+   * The buffer starts with a header (magic, format version, byte order), followed by the tagged values.
+   * The scalars, strings, std::vector, std::array, std::map, std::pair, std::tuple, std::optional and std::variant
+   * are written directly in the buffer. A user type may provide the hooks, found by ADL,
+   *
+   *     void h5_write_compact(h5::compact::ostream &os, T const &x);
+   *     void h5_read_compact(h5::compact::istream &is, T &x);
+   *
+   * calling h5::compact::write and read on its members. Any other type is stored as the image of an HDF5 file
+   * in memory (cf. h5::serialize), written by its h5_write and read by its h5_read.
+   */
+  namespace compact {
+
+    /// Version of the format
+    constexpr std::uint8_t format_version = 2;
+
+    // The tags of the values in the buffer
+    enum class tag_t : std::uint8_t { scalar = 1, string, raw_array, list, map, tuple, optional, variant, object, h5_image };
+
+    /// The buffer being written
+    class ostream {
+      std::vector<std::byte> buf;
+
+      public:
+      /// Start a buffer with the header, reserving size_hint bytes
+      explicit ostream(size_t size_hint = 0);
+
+      void put_bytes(void const *p, size_t n) {
+        auto const *b = static_cast<std::byte const *>(p);
+        buf.insert(buf.end(), b, b + n);
+      }
+      void put_tag(tag_t t) { buf.push_back(std::byte(t)); }
+      void put_size(std::size_t n); // LEB128 varint
+
+      /// Release the buffer
+      [[nodiscard]] std::vector<std::byte> release() && { return std::move(buf); }
+    };
+
+    /// The buffer being read
+    class istream {
+      std::span<std::byte const> buf;
+      std::size_t pos = 0;
+
+      public:
+      /// Check the header. Throws std::runtime_error if the buffer is not in the compact format, or of another version or byte order.
+      explicit istream(std::span<std::byte const> buf);
+
+      void get_bytes(void *p, size_t n);
+      void expect_tag(tag_t t, const char *what);
+      std::size_t get_size();
+
+      /// Read the number of elements of a container, each taking at least bytes_each bytes in the buffer.
+      /// Throws std::runtime_error if the rest of the buffer is too short for them.
+      std::size_t get_length(std::size_t bytes_each);
+
+      /// Throws std::runtime_error if the whole buffer was not read
+      void finish() const;
+    };
+
+    namespace detail {
+
+      template <typename T, template <typename...> class TMPLT>
+      inline constexpr bool is_instance_of = false;
+      template <template <typename...> class TMPLT, typename... Ts>
+      inline constexpr bool is_instance_of<TMPLT<Ts...>, TMPLT> = true;
+
+      template <typename T>
+      inline constexpr bool is_std_array = false;
+      template <typename T, size_t N>
+      inline constexpr bool is_std_array<std::array<T, N>> = true;
+
+      // The scalars written as raw bytes
+      template <typename T>
+      inline constexpr bool is_scalar = std::is_arithmetic_v<T> or is_complex_v<T>;
+
+      // The code of a scalar type : its kind in the 3 high bits, its size (at most 16, e.g. long double) in the 5 low bits
+      template <typename T>
+      constexpr std::uint8_t scalar_code() {
+        auto code = [](std::uint8_t kind, std::size_t size) { return std::uint8_t(kind << 5 | size); };
+        if constexpr (is_complex_v<T>) {
+          static_assert(sizeof(typename T::value_type) < 32);
+          return code(4, sizeof(typename T::value_type));
+        } else {
+          static_assert(sizeof(T) < 32);
+          if constexpr (std::is_same_v<T, bool>) {
+            return code(5, sizeof(T));
+          } else if constexpr (std::is_floating_point_v<T>) {
+            return code(3, sizeof(T));
+          } else if constexpr (std::is_signed_v<T>) {
+            return code(1, sizeof(T));
+          } else {
+            return code(2, sizeof(T));
+          }
+        }
+      }
+
+      template <typename T>
+      void put_scalar_code(ostream &os) {
+        std::uint8_t c = scalar_code<T>();
+        os.put_bytes(&c, 1);
+      }
+
+      template <typename T>
+      void expect_scalar_code(istream &is) {
+        std::uint8_t c = 0;
+        is.get_bytes(&c, 1);
+        if (c != scalar_code<T>()) throw std::runtime_error("h5 compact deserialize : mismatch of the scalar type");
+      }
+
+    } // namespace detail
+
+    template <typename T>
+    void write(ostream &os, T const &x);
+
+    template <typename T>
+    void read(istream &is, T &x);
+
+    template <typename T>
+    concept has_compact_hooks = requires(ostream &os, istream &is, T const &cx, T &x) {
+      h5_write_compact(os, cx);
+      h5_read_compact(is, x);
+    };
+
+    // Read a new T (default constructed first)
+    template <typename T>
+    T read_value(istream &is) {
+      T x{};
+      read(is, x);
+      return x;
+    }
+
+    /// Write x into the stream
+    template <typename T>
+    void write(ostream &os, T const &x) {
+      using detail::is_instance_of;
+
+      if constexpr (detail::is_scalar<T>) {
+        os.put_tag(tag_t::scalar);
+        detail::put_scalar_code<T>(os);
+        os.put_bytes(&x, sizeof(T));
+
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        os.put_tag(tag_t::string);
+        os.put_size(x.size());
+        os.put_bytes(x.data(), x.size());
+
+      } else if constexpr (is_instance_of<T, std::vector> or detail::is_std_array<T>) {
+        using E = typename T::value_type;
+        if constexpr (detail::is_scalar<E> and not std::is_same_v<E, bool>) {
+          os.put_tag(tag_t::raw_array);
+          detail::put_scalar_code<E>(os);
+          os.put_size(x.size());
+          os.put_bytes(x.data(), x.size() * sizeof(E));
+        } else {
+          os.put_tag(tag_t::list);
+          os.put_size(x.size());
+          for (E const &e : x) write(os, e);
+        }
+
+      } else if constexpr (is_instance_of<T, std::map>) {
+        os.put_tag(tag_t::map);
+        os.put_size(x.size());
+        for (auto const &[k, v] : x) {
+          write(os, k);
+          write(os, v);
+        }
+
+      } else if constexpr (is_instance_of<T, std::pair> or is_instance_of<T, std::tuple>) {
+        os.put_tag(tag_t::tuple);
+        os.put_size(std::tuple_size_v<T>);
+        std::apply([&os](auto const &...xs) { (write(os, xs), ...); }, x);
+
+      } else if constexpr (is_instance_of<T, std::optional>) {
+        os.put_tag(tag_t::optional);
+        os.put_size(x.has_value());
+        if (x) write(os, *x);
+
+      } else if constexpr (is_instance_of<T, std::variant>) {
+        os.put_tag(tag_t::variant);
+        os.put_size(x.index());
+        std::visit([&os](auto const &v) { write(os, v); }, x);
+
+      } else if constexpr (has_compact_hooks<T>) {
+        os.put_tag(tag_t::object);
+        h5_write_compact(os, x);
+
+      } else {
+        auto image = h5::serialize(x);
+        os.put_tag(tag_t::h5_image);
+        os.put_size(image.size());
+        os.put_bytes(image.data(), image.size());
+      }
+    }
+
+    /// Read x from the stream. Throws std::runtime_error if the stream holds another type.
+    template <typename T>
+    void read(istream &is, T &x) {
+      using detail::is_instance_of;
+
+      if constexpr (detail::is_scalar<T>) {
+        is.expect_tag(tag_t::scalar, "scalar");
+        detail::expect_scalar_code<T>(is);
+        is.get_bytes(&x, sizeof(T));
+
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        is.expect_tag(tag_t::string, "string");
+        x.resize(is.get_length(1));
+        is.get_bytes(x.data(), x.size());
+
+      } else if constexpr (is_instance_of<T, std::vector> or detail::is_std_array<T>) {
+        using E = typename T::value_type;
+        if constexpr (detail::is_scalar<E> and not std::is_same_v<E, bool>) {
+          is.expect_tag(tag_t::raw_array, "array");
+          detail::expect_scalar_code<E>(is);
+          auto n = is.get_length(sizeof(E));
+          if constexpr (detail::is_std_array<T>) {
+            if (n != x.size()) throw std::runtime_error("h5 compact deserialize : mismatch of the size of the std::array");
+          } else {
+            x.resize(n);
+          }
+          is.get_bytes(x.data(), n * sizeof(E));
+        } else {
+          is.expect_tag(tag_t::list, "list");
+          auto n = is.get_length(1); // each element has at least its tag
+          if constexpr (detail::is_std_array<T>) {
+            if (n != x.size()) throw std::runtime_error("h5 compact deserialize : mismatch of the size of the std::array");
+          } else {
+            x.clear();
+            x.reserve(n);
+          }
+          for (size_t i = 0; i < n; ++i) {
+            if constexpr (detail::is_std_array<T>)
+              read(is, x[i]);
+            else
+              x.push_back(read_value<E>(is));
+          }
+        }
+
+      } else if constexpr (is_instance_of<T, std::map>) {
+        is.expect_tag(tag_t::map, "map");
+        x.clear();
+        auto n = is.get_size();
+        for (size_t i = 0; i < n; ++i) {
+          auto k = read_value<typename T::key_type>(is);
+          x.emplace(std::move(k), read_value<typename T::mapped_type>(is));
+        }
+
+      } else if constexpr (is_instance_of<T, std::pair> or is_instance_of<T, std::tuple>) {
+        is.expect_tag(tag_t::tuple, "tuple");
+        if (is.get_size() != std::tuple_size_v<T>) throw std::runtime_error("h5 compact deserialize : mismatch of the size of the tuple");
+        std::apply([&is](auto &...xs) { (read(is, xs), ...); }, x);
+
+      } else if constexpr (is_instance_of<T, std::optional>) {
+        is.expect_tag(tag_t::optional, "optional");
+        x.reset();
+        if (is.get_size()) x.emplace(read_value<typename T::value_type>(is));
+
+      } else if constexpr (is_instance_of<T, std::variant>) {
+        is.expect_tag(tag_t::variant, "variant");
+        auto idx = is.get_size();
+        if (idx >= std::variant_size_v<T>) throw std::runtime_error("h5 compact deserialize : invalid index of the variant");
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+          ((idx == Is ? (x = read_value<std::variant_alternative_t<Is, T>>(is), 0) : 0), ...);
+        }(std::make_index_sequence<std::variant_size_v<T>>{});
+
+      } else if constexpr (has_compact_hooks<T>) {
+        is.expect_tag(tag_t::object, "object");
+        h5_read_compact(is, x);
+
+      } else {
+        is.expect_tag(tag_t::h5_image, "h5 image");
+        std::vector<std::byte> image(is.get_length(1));
+        is.get_bytes(image.data(), image.size());
+        x = h5::deserialize<T>(std::move(image));
+      }
+    }
+
+  } // namespace compact
+
+  /**
+   * Serialize an object into a byte buffer, in the compact binary format (cf. h5::compact).
+   * Much smaller and faster than serialize for small objects, as no HDF5 file is created.
+   *
+   * @param x The object
+   * @param size_hint Expected size of the buffer, reserved before writing
+   */
+  template <typename T>
+  std::vector<std::byte> serialize_compact(T const &x, size_t size_hint = 0) {
+    compact::ostream os{size_hint};
+    compact::write(os, x);
+    return std::move(os).release();
+  }
+
+  /// Deserialize an object from a buffer in the compact binary format. Throws std::runtime_error if it holds another type.
+  template <typename T>
+  T deserialize_compact(std::span<std::byte const> buf) {
+    compact::istream is{buf};
+    auto x = compact::read_value<T>(is);
+    is.finish();
+    return x;
+  }
+
+} // namespace h5
+
+#endif // LIBH5_COMPACT_HPP
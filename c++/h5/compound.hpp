@@ -0,0 +1,133 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_COMPOUND_HPP
+#define LIBH5_COMPOUND_HPP
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include "./array_interface.hpp"
+#include "./macros.hpp"
+
+namespace h5 {
+
+  // An aggregate T whose fields are all arithmetic (or complex<double>, std::array of them, or compound themselves)
+  // can be stored as a single hdf5 compound dataset, written and read in one H5Dwrite/H5Dread.
+  // This is opt-in : specialize hdf5_compound_impl<T> with a static fields() returning a tuple of compound_field,
+  // most simply with the macro, at global scope :
+  //
+  //   struct params_t { double beta; int n_iw; };
+  //   H5_SPECIALIZE_COMPOUND(params_t, H5_COMPOUND_FIELD(params_t, beta), H5_COMPOUND_FIELD(params_t, n_iw));
+  //
+  // The members are matched by name on read, so fields can be reordered, or added, between versions.
+  template <typename T>
+  struct hdf5_compound_impl;
+
+  template <typename T>
+  constexpr bool is_compound_v = requires { hdf5_compound_impl<T>::fields(); };
+
+  // A field of a compound : its name in the file, and the pointer to the member
+  template <typename C, typename M>
+  struct compound_field {
+    const char *name;
+    M C::*member;
+  };
+
+#define H5_COMPOUND_FIELD(C, M)                                                                                                                      \
+  h5::compound_field<C, decltype(C::M)> { H5_AS_STRING(M), &C::M }
+
+#define H5_SPECIALIZE_COMPOUND(C, ...)                                                                                                               \
+  template <>                                                                                                                                        \
+  struct h5::hdf5_compound_impl<C> {                                                                                                                 \
+    static constexpr auto fields() { return std::make_tuple(__VA_ARGS__); }                                                                          \
+  }
+
+  template <typename T>
+  datatype hdf5_compound_type();
+
+  namespace detail {
+
+    template <typename T>
+    struct _is_std_array : std::false_type {};
+
+    template <typename T, size_t N>
+    struct _is_std_array<std::array<T, N>> : std::true_type {
+      using value_type               = T;
+      static constexpr hsize_t size = N;
+    };
+
+    // hdf5 type of a member of a compound
+    template <typename M>
+    datatype compound_member_type() {
+      if constexpr (is_compound_v<M>) {
+        return hdf5_compound_type<M>();
+      } else if constexpr (_is_std_array<M>::value) {
+        return make_array_type(compound_member_type<typename _is_std_array<M>::value_type>(), {_is_std_array<M>::size});
+      } else if constexpr (is_complex_v<M>) {
+        static_assert(std::is_same_v<M, std::complex<double>>, "Only std::complex<double> is supported in a compound");
+        return hdf5_type<dcplx_t>();
+      } else {
+        static_assert(std::is_arithmetic_v<M>, "The fields of a compound must be arithmetic, complex, std::array or compound");
+        return hdf5_type<M>();
+      }
+    }
+
+  } // namespace detail
+
+  /// The hdf5 compound datatype of T, from its field list
+  template <typename T>
+  datatype hdf5_compound_type() {
+    T x{};
+    auto offset = [&x](auto const &f) { return size_t(reinterpret_cast<char const *>(&(x.*f.member)) - reinterpret_cast<char const *>(&x)); };
+
+    std::vector<compound_member> members;
+    std::apply(
+       [&](auto const &...f) {
+         (members.push_back({f.name, offset(f), detail::compound_member_type<std::remove_cvref_t<decltype(x.*f.member)>>()}), ...);
+       },
+       hdf5_compound_impl<T>::fields());
+    return make_compound_type(sizeof(T), members);
+  }
+
+  /**
+   * Write an aggregate with a field list as a scalar compound dataset
+   *
+   * @param g The h5::group
+   * @param name Name of the dataset
+   * @param x The object
+   */
+  template <typename T>
+  void h5_write(group const &g, std::string const &name, T const &x) H5_REQUIRES(is_compound_v<T>) {
+    array_interface::write(g, name, array_interface::h5_array_view{hdf5_compound_type<T>(), (void *)(&x), 0, false}, false);
+  }
+
+  /**
+   * Read an aggregate with a field list from a scalar compound dataset
+   *
+   * @param g The h5::group
+   * @param name Name of the dataset
+   * @param x The object to read into
+   */
+  template <typename T>
+  void h5_read(group const &g, std::string const &name, T &x) H5_REQUIRES(is_compound_v<T>) {
+    auto lt = array_interface::get_h5_lengths_type(g, name);
+    array_interface::read(g, name, array_interface::h5_array_view{hdf5_compound_type<T>(), (void *)(&x), 0, false}, lt);
+  }
+
+} // namespace h5
+
+#endif // LIBH5_COMPOUND_HPP
@@ -0,0 +1,173 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./array_interface.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace h5::array_interface {
+
+  namespace {
+
+    constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t P3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+    std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    // unaligned reads, the hash of a little endian machine
+    std::uint64_t read64(unsigned char const *p) {
+      std::uint64_t x;
+      std::memcpy(&x, p, 8);
+      return x;
+    }
+
+    std::uint64_t read32(unsigned char const *p) {
+      std::uint32_t x;
+      std::memcpy(&x, p, 4);
+      return x;
+    }
+
+    std::uint64_t round(std::uint64_t acc, std::uint64_t input) { return rotl(acc + input * P2, 31) * P1; }
+
+    std::uint64_t merge_round(std::uint64_t acc, std::uint64_t val) { return (acc ^ round(0, val)) * P1 + P4; }
+
+  } // namespace
+
+  std::uint64_t xxh64(void const *data, std::size_t n, std::uint64_t seed) {
+    auto const *p   = static_cast<unsigned char const *>(data);
+    auto const *end = p + n;
+    std::uint64_t h = 0;
+
+    if (n >= 32) {
+      std::uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+      for (; p + 32 <= end; p += 32) {
+        v1 = round(v1, read64(p));
+        v2 = round(v2, read64(p + 8));
+        v3 = round(v3, read64(p + 16));
+        v4 = round(v4, read64(p + 24));
+      }
+      h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+      for (auto v : {v1, v2, v3, v4}) h = merge_round(h, v);
+    } else {
+      h = seed + P5;
+    }
+    h += n;
+
+    for (; p + 8 <= end; p += 8) h = rotl(h ^ round(0, read64(p)), 27) * P1 + P4;
+    if (p + 4 <= end) {
+      h = rotl(h ^ (read32(p) * P1), 23) * P2 + P3;
+      p += 4;
+    }
+    for (; p < end; ++p) h = rotl(h ^ (*p * P5), 11) * P1;
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  //-------------------------------------------------------
+
+  namespace {
+
+    // Hashes a stream of bytes by blocks of block_bytes, each one seeding the hash of the next.
+    // The result only depends on the bytes, not on the pieces they are fed in.
+    class block_hasher {
+      static constexpr size_t block_bytes = 64 * 1024;
+      std::uint64_t h;
+      std::vector<char> buf;
+
+      public:
+      explicit block_hasher(std::uint64_t seed) : h{seed} { buf.reserve(block_bytes); }
+
+      void feed(char const *p, size_t n) {
+        if (not buf.empty()) {
+          size_t m = std::min(n, block_bytes - buf.size());
+          buf.insert(buf.end(), p, p + m);
+          p += m;
+          n -= m;
+          if (buf.size() < block_bytes) return;
+          h = xxh64(buf.data(), buf.size(), h);
+          buf.clear();
+        }
+        for (; n >= block_bytes; p += block_bytes, n -= block_bytes) h = xxh64(p, block_bytes, h);
+        buf.insert(buf.end(), p, p + n);
+      }
+
+      std::uint64_t finish() { return buf.empty() ? h : xxh64(buf.data(), buf.size(), h); }
+    };
+
+  } // namespace
+
+  std::optional<std::uint64_t> content_hash(h5_array_view const &v) {
+
+    // The data of variable length types and references are not in the view
+    if (H5Tis_variable_str(v.ty) > 0 or H5Tdetect_class(v.ty, H5T_VLEN) > 0 or H5Tdetect_class(v.ty, H5T_REFERENCE) > 0) return {};
+    auto const &sl = v.slab;
+    if (std::any_of(sl.block.begin(), sl.block.end(), [](hsize_t b) { return b != 1; })) return {};
+
+    size_t es       = H5Tget_size(v.ty);
+    auto const *mem = static_cast<char const *>(v.start);
+    int r           = v.rank();
+    block_hasher hasher{xxh64(sl.count.data(), sl.count.size() * sizeof(hsize_t), es)};
+    if (r == 0) {
+      hasher.feed(mem, es);
+      return hasher.finish();
+    }
+    for (auto c : sl.count)
+      if (c == 0) return hasher.finish();
+
+    v_t mstride(r);
+    mstride[r - 1] = 1;
+    for (int d = r - 2; d >= 0; --d) mstride[d] = mstride[d + 1] * v.L_tot[d + 1];
+
+    // The elements are fed in the C order of the view, the trailing dimensions [k, r) as one contiguous run
+    int k = r - 1;
+    if (sl.stride[r - 1] == 1)
+      while (k > 0 and sl.stride[k - 1] == 1 and sl.count[k] == v.L_tot[k]) --k;
+    hsize_t run = 1;
+    for (int d = k; d < r; ++d) run *= sl.count[d];
+    hsize_t mem_step = sl.stride[r - 1];
+
+    v_t x(k, 0);
+    while (true) {
+      hsize_t m = 0;
+      for (int d = 0; d < r; ++d) m += (sl.offset[d] + (d < k ? x[d] * sl.stride[d] : 0)) * mstride[d];
+      char const *mp = mem + m * es;
+      if (mem_step == 1)
+        hasher.feed(mp, run * es);
+      else
+        for (hsize_t i = 0; i < run; ++i) hasher.feed(mp + i * mem_step * es, es);
+      // next run
+      int d = k - 1;
+      for (; d >= 0; --d) {
+        if (++x[d] < sl.count[d]) break;
+        x[d] = 0;
+      }
+      if (d < 0) break;
+    }
+    return hasher.finish();
+  }
+
+} // namespace h5::array_interface
@@ -0,0 +1,163 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_DATASET_HANDLE_HPP
+#define LIBH5_DATASET_HANDLE_HPP
+
+#include "./array_interface.hpp"
+
+#include <numeric>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5 {
+
+  /**
+   * A dataset of scalars T (arithmetic or complex), opened once, to query its shape and read or write slices of it,
+   * e.g. to stream through an array larger than the memory. Cf. group::open_dataset_handle and group::create_dataset_handle.
+   *
+   * The shape is the one of the array of T, i.e. without the trailing dimension 2 of a complex dataset.
+   * The slices are C-ordered contiguous arrays, of lengths counts. The strides are in the HDF5 sense (1 : contiguous).
+   */
+  template <typename T>
+  class dataset_handle {
+    static_assert(std::is_arithmetic_v<T> or is_complex_v<T>, "h5::dataset_handle : T must be an arithmetic or complex type");
+
+    group g;
+    std::string key;
+    array_interface::h5_lengths_type lt;
+    v_t shape_;
+
+    // The view of an array of T of lengths counts at data
+    static array_interface::h5_array_view make_view(T const *data, v_t const &counts) {
+      array_interface::h5_array_view v{hdf5_type<T>(), (void *)data, int(counts.size()), is_complex_v<T>};
+      for (size_t i = 0; i < counts.size(); ++i) v.slab.count[i] = v.L_tot[i] = counts[i];
+      return v;
+    }
+
+    // The hyperslab of the dataset
+    array_interface::hyperslab make_slab(v_t const &offsets, v_t const &counts, v_t const &strides) const {
+      int r = rank();
+      if (offsets.size() != size_t(r) or counts.size() != size_t(r) or not(strides.empty() or strides.size() == size_t(r)))
+        throw std::runtime_error("h5::dataset_handle " + key + " : the slice must have the rank " + std::to_string(r) + " of the dataset");
+      array_interface::hyperslab sl(r, lt.has_complex_attribute);
+      std::copy(offsets.begin(), offsets.end(), sl.offset.begin());
+      std::copy(counts.begin(), counts.end(), sl.count.begin());
+      if (not strides.empty()) std::copy(strides.begin(), strides.end(), sl.stride.begin());
+      return sl;
+    }
+
+    static size_t n_elements(v_t const &counts) { return std::accumulate(counts.begin(), counts.end(), size_t{1}, std::multiplies<>{}); }
+
+    void check_size(size_t n, v_t const &counts, const char *what) const {
+      if (n != n_elements(counts))
+        throw std::runtime_error("h5::dataset_handle " + key + " : " + what + " of size " + std::to_string(n) + " for a slice of "
+                                 + std::to_string(n_elements(counts)) + " elements");
+    }
+
+    public:
+    /**
+     * Open the dataset g[key]
+     *
+     * @param hint  Sizes the chunk cache for the access pattern (cf. access_hint)
+     */
+    dataset_handle(group g_, std::string key_, access_hint hint = access_hint::none)
+       : g(std::move(g_)), key(std::move(key_)), lt(array_interface::get_h5_lengths_type(g, key, hint)) {
+      shape_ = lt.lengths;
+      if (lt.has_complex_attribute) shape_.pop_back();
+    }
+
+    /// Name of the dataset in its group
+    [[nodiscard]] std::string const &name() const { return key; }
+
+    /// The shape of the array
+    [[nodiscard]] v_t const &shape() const { return shape_; }
+
+    /// Rank of the array
+    [[nodiscard]] int rank() const { return shape_.size(); }
+
+    /// Number of elements of the array
+    [[nodiscard]] size_t size() const { return n_elements(shape_); }
+
+    /// True iff the dataset holds complex numbers
+    [[nodiscard]] bool is_complex() const { return lt.has_complex_attribute; }
+
+    /// The hdf5 type of the dataset in the file
+    [[nodiscard]] datatype const &file_type() const { return lt.ty; }
+
+    /// The open dataset
+    [[nodiscard]] dataset const &get_dataset() const { return lt.ds; }
+
+    /// Update the shape, e.g. after an append to the dataset (or file::refresh for a SWMR reader)
+    void refresh_shape() {
+      lt     = array_interface::get_h5_lengths_type(lt.ds);
+      shape_ = lt.lengths;
+      if (lt.has_complex_attribute) shape_.pop_back();
+    }
+
+    /// Read the whole array into out, of size size()
+    void read_into(std::span<T> out) const {
+      check_size(out.size(), shape_, "read into a span");
+      array_interface::read(g, key, make_view(out.data(), shape_), lt);
+    }
+
+    /// Read the whole array
+    [[nodiscard]] std::vector<T> read() const {
+      std::vector<T> res(size());
+      read_into(res);
+      return res;
+    }
+
+    /// Read the slice into out, of size the product of counts
+    void read_slice_into(std::span<T> out, v_t const &offsets, v_t const &counts, v_t const &strides = {}) const {
+      check_size(out.size(), counts, "read into a span");
+      array_interface::read(g, key, make_view(out.data(), counts), lt, make_slab(offsets, counts, strides));
+    }
+
+    /// Read the slice
+    [[nodiscard]] std::vector<T> read_slice(v_t const &offsets, v_t const &counts, v_t const &strides = {}) const {
+      std::vector<T> res(n_elements(counts));
+      read_slice_into(res, offsets, counts, strides);
+      return res;
+    }
+
+    /// Write data, of size the product of counts, into the slice
+    void write_slice(std::span<T const> data, v_t const &offsets, v_t const &counts, v_t const &strides = {}) const {
+      check_size(data.size(), counts, "write of a span");
+      array_interface::write_slice(g, key, make_view(data.data(), counts), lt, make_slab(offsets, counts, strides));
+    }
+  };
+
+  // -------------------- group members ------------------------------
+
+  template <typename T>
+  dataset_handle<T> group::open_dataset_handle(std::string const &key, access_hint hint) const {
+    return {*this, key, hint};
+  }
+
+  template <typename T>
+  dataset_handle<T> group::create_dataset_handle(std::string const &key, v_t const &shape, bool compress) const {
+    v_t lengths = shape;
+    if (is_complex_v<T>) lengths.push_back(2);
+    array_interface::create_dataset(*this, key, {lengths, hdf5_type<T>(), is_complex_v<T>}, compress);
+    return {*this, key};
+  }
+
+} // namespace h5
+
+#endif // LIBH5_DATASET_HANDLE_HPP
@@ -0,0 +1,177 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./device.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef H5_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+namespace h5::array_interface {
+
+  device_copier host_copier() {
+    return {[](void *host, void const *device, std::size_t bytes) { std::memcpy(host, device, bytes); },
+            [](void *device, void const *host, std::size_t bytes) { std::memcpy(device, host, bytes); },
+            {},
+            {}};
+  }
+
+#ifdef H5_WITH_CUDA
+  namespace {
+    void check_cuda(cudaError_t err, const char *what) {
+      if (err != cudaSuccess) throw std::runtime_error(std::string{"h5 : "} + what + " failed : " + cudaGetErrorString(err));
+    }
+  } // namespace
+
+  device_copier cuda_copier() {
+    // The stream is shared by the copies of the copier, and destroyed with the last one
+    cudaStream_t s = nullptr;
+    check_cuda(cudaStreamCreateWithFlags(&s, cudaStreamNonBlocking), "cudaStreamCreate");
+    auto stream = std::shared_ptr<CUstream_st>(s, [](cudaStream_t st) { cudaStreamDestroy(st); });
+
+    return {[stream](void *host, void const *device, std::size_t bytes) {
+              check_cuda(cudaMemcpyAsync(host, device, bytes, cudaMemcpyDeviceToHost, stream.get()), "cudaMemcpyAsync");
+              check_cuda(cudaStreamSynchronize(stream.get()), "cudaStreamSynchronize");
+            },
+            [stream](void *device, void const *host, std::size_t bytes) {
+              check_cuda(cudaMemcpyAsync(device, host, bytes, cudaMemcpyHostToDevice, stream.get()), "cudaMemcpyAsync");
+              check_cuda(cudaStreamSynchronize(stream.get()), "cudaStreamSynchronize");
+            },
+            [](std::size_t bytes) {
+              void *p = nullptr;
+              check_cuda(cudaMallocHost(&p, bytes), "cudaMallocHost");
+              return p;
+            },
+            [](void *p) { cudaFreeHost(p); }};
+  }
+#endif
+
+  namespace {
+
+    // The two host buffers of the blocks, allocated by the copier
+    struct staging_buffers {
+      device_copier const &c;
+      void *buf[2] = {nullptr, nullptr};
+
+      staging_buffers(device_copier const &c, std::size_t bytes) : c(c) {
+        for (auto &b : buf) b = (c.alloc_host ? c.alloc_host(bytes) : ::operator new(bytes));
+      }
+      ~staging_buffers() {
+        for (auto b : buf)
+          if (b) (c.free_host ? c.free_host(b) : ::operator delete(b));
+      }
+      staging_buffers(staging_buffers const &)            = delete;
+      staging_buffers &operator=(staging_buffers const &) = delete;
+    };
+
+    // The cut of v in blocks of rows (along its first dimension) of about block_bytes bytes
+    struct blocking {
+      hsize_t n_rows, rows_per_block, n_blocks;
+      std::size_t row_bytes;
+
+      blocking(device_array_view const &v, std::size_t block_bytes, std::string const &name) {
+        if (v.lengths.empty()) throw std::runtime_error("h5 : the device array " + name + " must have a rank >= 1");
+        row_bytes = H5Tget_size(v.ty) * (v.is_complex ? 2 : 1);
+        for (size_t i = 1; i < v.lengths.size(); ++i) row_bytes *= v.lengths[i];
+        n_rows         = v.lengths[0];
+        rows_per_block = std::max(hsize_t(block_bytes / std::max(row_bytes, std::size_t{1})), hsize_t{1});
+        n_blocks       = (row_bytes == 0 ? 0 : (n_rows + rows_per_block - 1) / rows_per_block);
+      }
+
+      [[nodiscard]] hsize_t first_row(hsize_t k) const { return k * rows_per_block; }
+      [[nodiscard]] hsize_t rows(hsize_t k) const { return std::min(rows_per_block, n_rows - first_row(k)); }
+      [[nodiscard]] std::size_t offset_bytes(hsize_t k) const { return first_row(k) * row_bytes; }
+      [[nodiscard]] std::size_t bytes(hsize_t k) const { return rows(k) * row_bytes; }
+    };
+
+    // The host view of the block k in buf, and its hyperslab in the dataset
+    std::pair<h5_array_view, hyperslab> block_view(device_array_view const &v, blocking const &b, hsize_t k, void *buf) {
+      int rank = int(v.lengths.size());
+      h5_array_view hv{v.ty, buf, rank, v.is_complex};
+      hyperslab sl(rank, v.is_complex);
+      for (int i = 0; i < rank; ++i) hv.slab.count[i] = hv.L_tot[i] = sl.count[i] = v.lengths[i];
+      hv.slab.count[0] = hv.L_tot[0] = sl.count[0] = b.rows(k);
+      sl.offset[0]                                 = b.first_row(k);
+      return {hv, sl};
+    }
+
+  } // namespace
+
+  //-------------------------------------------------------------
+
+  void write_from_device(group const &g, std::string const &name, device_array_view const &v, device_copier const &c, bool compress,
+                         std::size_t block_bytes) {
+    if (not c.to_host) throw std::runtime_error("h5 write_from_device of " + name + " : no copy to the host");
+
+    blocking b{v, block_bytes, name};
+    auto file_lengths = v.lengths;
+    if (v.is_complex) file_lengths.push_back(2);
+    create_dataset(g, name, {file_lengths, v.ty, v.is_complex}, compress);
+    if (b.n_blocks == 0) return;
+
+    auto lt = get_h5_lengths_type(g, name);
+    staging_buffers buffers{c, b.bytes(0)};
+    auto copy_to_host = [&](hsize_t k) { c.to_host(buffers.buf[k % 2], static_cast<char const *>(v.start) + b.offset_bytes(k), b.bytes(k)); };
+
+    // Copy the block k + 1 while the block k is written. The pending copy is waited for by the future, even on an exception.
+    auto pending = std::async(std::launch::async, copy_to_host, hsize_t{0});
+    for (hsize_t k = 0; k < b.n_blocks; ++k) {
+      pending.get();
+      if (k + 1 < b.n_blocks) pending = std::async(std::launch::async, copy_to_host, k + 1);
+      auto [hv, sl] = block_view(v, b, k, buffers.buf[k % 2]);
+      write_slice(g, name, hv, lt, sl);
+    }
+  }
+
+  //-------------------------------------------------------------
+
+  void read_to_device(group const &g, std::string const &name, device_array_view const &v, device_copier const &c, std::size_t block_bytes) {
+    if (not c.to_device) throw std::runtime_error("h5 read_to_device of " + name + " : no copy to the device");
+
+    auto lt        = get_h5_lengths_type(g, name);
+    auto v_lengths = v.lengths;
+    if (v.is_complex) v_lengths.push_back(2);
+    if (lt.lengths != v_lengths or lt.has_complex_attribute != v.is_complex)
+      throw std::runtime_error("h5 read_to_device of " + name + " : the shape of the device array is not the one of the dataset");
+
+    blocking b{v, block_bytes, name};
+    if (b.n_blocks == 0) return;
+
+    staging_buffers buffers{c, b.bytes(0)};
+    auto copy_to_device = [&](hsize_t k) { c.to_device(static_cast<char *>(v.start) + b.offset_bytes(k), buffers.buf[k % 2], b.bytes(k)); };
+
+    // Read the block k while the block k - 1 is copied
+    std::future<void> pending;
+    for (hsize_t k = 0; k < b.n_blocks; ++k) {
+      auto [hv, sl] = block_view(v, b, k, buffers.buf[k % 2]);
+      read(g, name, hv, lt, sl);
+      if (pending.valid()) pending.get();
+      pending = std::async(std::launch::async, copy_to_device, k);
+    }
+    pending.get();
+  }
+
+} // namespace h5::array_interface
@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_DEVICE_HPP
+#define LIBH5_DEVICE_HPP
+
+#include "./array_interface.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace h5::array_interface {
+
+  /**
+   * The copies between the memory of a device, e.g. a GPU, and the memory of the host, for the staged I/O below.
+   * The copies are called on a worker thread, while the main thread reads or writes the previous block with HDF5.
+   * They must be complete when they return.
+   */
+  struct device_copier {
+    std::function<void(void *host, void const *device, std::size_t bytes)> to_host;
+    std::function<void(void *device, void const *host, std::size_t bytes)> to_device;
+
+    /// Allocation of the two staging buffers on the host, e.g. page-locked memory for faster copies. Empty : operator new.
+    std::function<void *(std::size_t bytes)> alloc_host;
+    std::function<void(void *)> free_host;
+  };
+
+  /// Copies with std::memcpy, for arrays which are in fact on the host, e.g. in memory shared with the device.
+  device_copier host_copier();
+
+#ifdef H5_WITH_CUDA
+  /// Copies with cudaMemcpyAsync on a stream of its own, from and to page-locked buffers (cudaMallocHost)
+  device_copier cuda_copier();
+#endif
+
+  /**
+   * A C-ordered contiguous array in the memory of a device, which HDF5 can not address.
+   * lengths are the ones of the array, i.e. without the trailing 2 of the complex arrays.
+   */
+  struct device_array_view {
+    datatype ty;     // HDF5 type of the elements, or of the real and imaginary parts of the complex elements
+    void *start;     // start of the data on the device
+    v_t lengths;     // shape of the array, of rank >= 1
+    bool is_complex; // the elements are pairs of ty
+  };
+
+  /**
+   * Write the device array v to the new dataset g[name], through host buffers of about block_bytes bytes each :
+   * the array is cut in blocks of its first dimension, and the copy of a block to the host overlaps the write of the previous one.
+   * The time is then bounded by the slower of the copy and the write, not by their sum.
+   */
+  void write_from_device(group const &g, std::string const &name, device_array_view const &v, device_copier const &c, bool compress,
+                         std::size_t block_bytes = std::size_t{1} << 24);
+
+  /// Read the dataset g[name], of the shape of v, into the device array v. The copy of a block to the device overlaps the read of the next one.
+  void read_to_device(group const &g, std::string const &name, device_array_view const &v, device_copier const &c,
+                      std::size_t block_bytes = std::size_t{1} << 24);
+
+} // namespace h5::array_interface
+
+#endif // LIBH5_DEVICE_HPP
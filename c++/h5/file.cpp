@@ -18,6 +18,12 @@
 #include <hdf5.h>
 #include <hdf5_hl.h>
 #include <vector>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <string>
 
 using namespace std::string_literals;
 
@@ -26,10 +32,15 @@ using namespace std::string_literals;
 
 namespace h5 {
 
-  file::file(const char *name, char mode) {
+  // open or create the file name, according to mode, with the file access and creation property lists fapl, fcpl
+  // In SWMR mode, the reader or writer flag is added.
+  static hid_t open_file(const char *name, char mode, hid_t fapl, hid_t fcpl = H5P_DEFAULT, bool swmr = false) {
+    hdf5_lock lock;
+    hid_t id        = -1;
+    unsigned swmr_w = (swmr ? H5F_ACC_SWMR_WRITE : 0u);
     switch (mode) {
-      case 'r': id = H5Fopen(name, H5F_ACC_RDONLY, H5P_DEFAULT); break;
-      case 'w': id = H5Fcreate(name, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT); break;
+      case 'r': id = H5Fopen(name, H5F_ACC_RDONLY | (swmr ? H5F_ACC_SWMR_READ : 0u), fapl); break;
+      case 'w': id = H5Fcreate(name, H5F_ACC_TRUNC | swmr_w, fcpl, fapl); break;
       case 'a':
         // Turn off error handling
         herr_t (*old_func)(void *);
@@ -38,24 +49,118 @@ namespace h5 {
         H5Eset_auto1(nullptr, nullptr);
 
         // This may fail
-        id = H5Fcreate(name, H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+        id = H5Fcreate(name, H5F_ACC_EXCL | swmr_w, fcpl, fapl);
 
         // Turn on error handling
         H5Eset_auto1(old_func, old_client_data);
 
         // Open in RDWR if creation failed
-        if (id < 0) id = H5Fopen(name, H5F_ACC_RDWR, H5P_DEFAULT);
+        if (id < 0) id = H5Fopen(name, H5F_ACC_RDWR | swmr_w, fapl);
         break;
-      case 'e': id = H5Fopen(name, H5F_ACC_EXCL, H5P_DEFAULT); break;
+      case 'e': id = H5Fopen(name, H5F_ACC_EXCL | swmr_w, fapl); break;
       default: throw std::runtime_error("HDF5 file opening : mode is not r, w, a, e. Cf documentation");
     }
 
     if (id < 0) throw std::runtime_error("HDF5 : cannot "s + (((mode == 'r') or (mode == 'a')) ? "open" : "create") + "file : "s + name);
+    return id;
+  }
+
+  file::file(const char *name, char mode) { id = open_file(name, mode, H5P_DEFAULT); }
+
+  //---------------------------------------------
+
+  // The file access property list with the options
+  static proplist make_fapl(file_options const &opts) {
+    proplist fapl = H5Pcreate(H5P_FILE_ACCESS);
+    CHECK_OR_THROW((fapl.is_valid()), "creating fapl");
+
+    herr_t err = 0;
+    if (opts.latest_format or opts.swmr) err |= H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+    if (opts.alignment > 1) err |= H5Pset_alignment(fapl, opts.alignment_threshold, opts.alignment);
+    if (opts.meta_block_size > 0) err |= H5Pset_meta_block_size(fapl, opts.meta_block_size);
+    if (opts.small_data_block_size > 0) err |= H5Pset_small_data_block_size(fapl, opts.small_data_block_size);
+    if (opts.sieve_buf_size > 0) err |= H5Pset_sieve_buf_size(fapl, opts.sieve_buf_size);
+    if (opts.page_buffer_size > 0) err |= H5Pset_page_buffer_size(fapl, opts.page_buffer_size, 0, 0);
+    CHECK_OR_THROW((err >= 0), "setting the file access properties");
+
+    if (opts.chunk_cache_bytes > 0 or opts.chunk_cache_slots > 0 or opts.chunk_cache_w0 >= 0) {
+      int mdc_nelmts = 0;
+      size_t slots = 0, bytes = 0;
+      double w0 = 0;
+      err = H5Pget_cache(fapl, &mdc_nelmts, &slots, &bytes, &w0);
+      if (opts.chunk_cache_bytes > 0) bytes = opts.chunk_cache_bytes;
+      if (opts.chunk_cache_slots > 0) slots = opts.chunk_cache_slots;
+      if (opts.chunk_cache_w0 >= 0) w0 = opts.chunk_cache_w0;
+      err |= H5Pset_cache(fapl, mdc_nelmts, slots, bytes, w0);
+      CHECK_OR_THROW((err >= 0), "setting the chunk cache");
+    }
+
+    if (opts.metadata_cache_size > 0) {
+      H5AC_cache_config_t config;
+      config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+      err            = H5Pget_mdc_config(fapl, &config);
+
+      config.set_initial_size = true;
+      config.initial_size     = opts.metadata_cache_size;
+      config.max_size         = opts.metadata_cache_size;
+      config.min_size         = std::min(config.min_size, opts.metadata_cache_size);
+      err |= H5Pset_mdc_config(fapl, &config);
+      CHECK_OR_THROW((err >= 0), "setting the metadata cache size");
+    }
+    return fapl;
+  }
+
+  // The file creation property list with the options
+  static proplist make_fcpl(file_options const &opts) {
+    proplist fcpl = H5Pcreate(H5P_FILE_CREATE);
+    CHECK_OR_THROW((fcpl.is_valid()), "creating fcpl");
+
+    herr_t err = 0;
+    if (opts.paged_aggregation or opts.persist_free_space) {
+      auto strategy = (opts.paged_aggregation ? H5F_FSPACE_STRATEGY_PAGE : H5F_FSPACE_STRATEGY_FSM_AGGR);
+      err |= H5Pset_file_space_strategy(fcpl, strategy, opts.persist_free_space, std::max(opts.free_space_threshold, std::size_t{1}));
+    }
+    if (opts.file_space_page_size > 0) err |= H5Pset_file_space_page_size(fcpl, opts.file_space_page_size);
+    CHECK_OR_THROW((err >= 0), "setting the file creation properties");
+    return fcpl;
+  }
+
+  file::file(std::string const &name, char mode, file_options const &opts) {
+    proplist fapl = make_fapl(opts);
+    proplist fcpl = make_fcpl(opts);
+    id            = open_file(name.c_str(), mode, fapl, fcpl, opts.swmr);
+  }
+
+  //---------------------------------------------
+
+#ifdef H5_WITH_MPI
+  file::file(std::string const &name, char mode, MPI_Comm comm, MPI_Info info, file_options const &opts) {
+
+    proplist fapl = make_fapl(opts);
+
+    auto err = H5Pset_fapl_mpio(fapl, comm, info);
+    CHECK_OR_THROW((err >= 0), "setting the MPI-IO file driver in fapl.");
+
+    proplist fcpl = make_fcpl(opts);
+    id            = open_file(name.c_str(), mode, fapl, fcpl);
+  }
+#endif
+
+  bool file::is_parallel() const {
+    hdf5_lock lock;
+#ifdef H5_HAVE_PARALLEL
+    if (not is_valid()) return false;
+    proplist fapl = H5Fget_access_plist(id);
+    return H5Pget_driver(fapl) == H5FD_MPIO;
+#else
+    return false;
+#endif
   }
 
   //---------------------------------------------
 
   std::string file::name() const { // same function as for group
+    hdf5_lock lock;
     char _n[1];
     ssize_t size = H5Fget_name(id, _n, 1); // first call, get the size only
     std::vector<char> buf(size + 1, 0x00);
@@ -68,45 +173,282 @@ namespace h5 {
   //---------------------------------------------
 
   void file::flush() {
+    hdf5_lock lock;
     if (not is_valid()) return;
     auto err = H5Fflush(id, H5F_SCOPE_GLOBAL);
     CHECK_OR_THROW((err >= 0), "flushing the file");
   }
 
-  // -------------------------
+  void file::flush_if_not_in_session() {
+    if (not in_write_session()) flush();
+  }
 
-  file::file() {
+  //---------------------------------------------
 
-    proplist fapl = H5Pcreate(H5P_FILE_ACCESS);
-    CHECK_OR_THROW((fapl >= 0), "creating fapl");
+  bool file::is_swmr() const {
+    hdf5_lock lock;
+    unsigned intent = 0;
+    if (not is_valid() or H5Fget_intent(id, &intent) < 0) return false;
+    return (intent & (H5F_ACC_SWMR_READ | H5F_ACC_SWMR_WRITE)) != 0;
+  }
 
-    auto err = H5Pset_fapl_core(fapl, (size_t)(64 * 1024), false);
-    CHECK_OR_THROW((err >= 0), "setting core file driver in fapl.");
+  void file::start_swmr_write() {
+    hdf5_lock lock;
+    auto err = H5Fstart_swmr_write(id);
+    CHECK_OR_THROW((err >= 0), "starting the SWMR write mode. Is the file opened for writing, with the latest format ?");
+  }
 
-    this->id = H5Fcreate("MemoryBuffer", 0, H5P_DEFAULT, fapl);
-    CHECK_OR_THROW((this->is_valid()), "created core file");
+  void file::refresh() {
+    hdf5_lock lock;
+    unsigned types = H5F_OBJ_DATASET | H5F_OBJ_GROUP;
+    std::vector<hid_t> ids(H5Fget_obj_count(id, types));
+    if (ids.empty()) return;
+    ids.resize(H5Fget_obj_ids(id, types, ids.size(), ids.data()));
+    for (auto i : ids) {
+      auto err = H5Orefresh(i);
+      CHECK_OR_THROW((err >= 0), "refreshing the objects of the file. Is it opened in SWMR mode ?");
+    }
+  }
+
+  //---------------------------------------------
+
+  namespace {
+
+    // Copy the attributes of the object src to the object dst, e.g. of the root group, which H5Ocopy does not copy
+    extern "C" herr_t copy_attribute(hid_t src, const char *name, const H5A_info_t *, void *dst) {
+      object a = H5Aopen(src, name, H5P_DEFAULT);
+      if (not a.is_valid()) return -1;
+      datatype ty   = H5Aget_type(a);
+      dataspace sp  = H5Aget_space(a);
+      auto n_points = H5Sget_simple_extent_npoints(sp);
+      if (n_points < 0) return -1;
+
+      std::vector<char> buf(std::max(H5Tget_size(ty) * size_t(n_points), size_t{1}));
+      if (H5Aread(a, ty, buf.data()) < 0) return -1;
+      object b   = H5Acreate2(*static_cast<hid_t *>(dst), name, ty, sp, H5P_DEFAULT, H5P_DEFAULT);
+      herr_t err = (b.is_valid() ? H5Awrite(b, ty, buf.data()) : -1);
+      if (H5Tdetect_class(ty, H5T_VLEN) > 0 or H5Tis_variable_str(ty) > 0) {
+#if H5_VERSION_GE(1, 12, 0)
+        H5Treclaim(ty, sp, H5P_DEFAULT, buf.data());
+#else
+        H5Dvlen_reclaim(ty, sp, H5P_DEFAULT, buf.data());
+#endif
+      }
+      return err;
+    }
+
+#if H5_VERSION_GE(1, 12, 0)
+    using object_key = std::pair<unsigned long, std::string>;
+#else
+    using object_key = std::pair<unsigned long, haddr_t>;
+#endif
+
+    // A key identifying the object loc/name in its file, and its type (H5O_TYPE_UNKNOWN on error)
+    std::pair<object_key, H5O_type_t> get_object_key(hid_t loc, const char *name) {
+#if H5_VERSION_GE(1, 12, 0)
+      H5O_info2_t info;
+      if (H5Oget_info_by_name3(loc, name, &info, H5O_INFO_BASIC, H5P_DEFAULT) < 0) return {{}, H5O_TYPE_UNKNOWN};
+      return {{info.fileno, std::string(reinterpret_cast<char const *>(&info.token), sizeof(info.token))}, info.type};
+#else
+      H5O_info_t info;
+      if (H5Oget_info_by_name2(loc, name, &info, H5O_INFO_BASIC, H5P_DEFAULT) < 0) return {{}, H5O_TYPE_UNKNOWN};
+      return {{info.fileno, info.addr}, info.type};
+#endif
+    }
+
+    // The destination group of a copy, and the objects already copied, to copy an object with several hard links only once
+    struct copy_context {
+      hid_t dst;                                 // the group the links are copied into
+      std::string dst_path;                      // its path in the destination file, ending with a /
+      std::map<object_key, std::string> *copied; // the path in the destination file of the objects already copied
+    };
+
+    extern "C" herr_t copy_link(hid_t src, const char *name, const H5L_info_t *info, void *ctx_);
+
+    // Copy the links and the attributes of the group src into the group dst, in the order of their creation if it is tracked, by name otherwise
+    herr_t copy_group_content(hid_t src, copy_context &ctx) {
+      proplist gcpl  = H5Gget_create_plist(src);
+      unsigned order = 0;
+      H5Pget_link_creation_order(gcpl, &order);
+      auto index = ((order & H5P_CRT_ORDER_TRACKED) ? H5_INDEX_CRT_ORDER : H5_INDEX_NAME);
+
+      if (H5Literate(src, index, H5_ITER_INC, nullptr, copy_link, &ctx) < 0) return -1;
+      return H5Aiterate2(src, H5_INDEX_NAME, H5_ITER_INC, nullptr, copy_attribute, &ctx.dst);
+    }
+
+    // Copy the link name of the group src into ctx.dst : the objects (with their attributes) and the soft and external links.
+    // The groups are copied recursively. An object reached by several hard links is copied once, and linked again.
+    extern "C" herr_t copy_link(hid_t src, const char *name, const H5L_info_t *info, void *ctx_) {
+      auto &ctx = *static_cast<copy_context *>(ctx_);
+      hid_t dst = ctx.dst;
+      if (info->type == H5L_TYPE_HARD) {
+        auto [key, type] = get_object_key(src, name);
+        if (type == H5O_TYPE_UNKNOWN) return -1;
+        auto [pos, is_new] = ctx.copied->try_emplace(key, ctx.dst_path + name);
+        if (not is_new) return H5Lcreate_hard(dst, pos->second.c_str(), dst, name, H5P_DEFAULT, H5P_DEFAULT);
+        if (type != H5O_TYPE_GROUP) return H5Ocopy(src, name, dst, name, H5P_DEFAULT, H5P_DEFAULT);
+
+        object src_group = H5Gopen2(src, name, H5P_DEFAULT);
+        if (not src_group.is_valid()) return -1;
+        proplist gcpl    = H5Gget_create_plist(src_group);
+        object dst_group = H5Gcreate2(dst, name, H5P_DEFAULT, gcpl, H5P_DEFAULT);
+        if (not dst_group.is_valid()) return -1;
+        copy_context sub{dst_group, pos->second + "/", ctx.copied};
+        return copy_group_content(src_group, sub);
+      }
+
+      std::vector<char> val(info->u.val_size + 1, 0);
+      if (H5Lget_val(src, name, val.data(), val.size(), H5P_DEFAULT) < 0) return -1;
+      if (info->type == H5L_TYPE_SOFT) return H5Lcreate_soft(val.data(), dst, name, H5P_DEFAULT, H5P_DEFAULT);
+      if (info->type == H5L_TYPE_EXTERNAL) {
+        const char *file_name = nullptr, *obj_name = nullptr;
+        unsigned flags        = 0;
+        if (H5Lunpack_elink_val(val.data(), val.size(), &flags, &file_name, &obj_name) < 0) return -1;
+        return H5Lcreate_external(file_name, obj_name, dst, name, H5P_DEFAULT, H5P_DEFAULT);
+      }
+      return 0; // user defined links are not copied
+    }
+
+  } // namespace
+
+  void file::compact(std::string const &dest, file_options const &opts) const {
+    hdf5_lock lock;
+    CHECK_OR_THROW(is_valid(), "compacting a closed file");
+    CHECK_OR_THROW(dest != name(), "compacting the file " + dest + " into itself");
+
+    file f{dest, 'w', opts};
+    object src_root = H5Gopen2(id, "/", H5P_DEFAULT);
+    object dst_root = H5Gopen2(f, "/", H5P_DEFAULT);
+
+    // The root group is the new root : a hard link to it is linked to the new root
+    std::map<object_key, std::string> copied{{get_object_key(id, "/").first, "/"}};
+    copy_context ctx{dst_root, "/", &copied};
+    auto err = copy_group_content(src_root, ctx);
+    CHECK_OR_THROW((err >= 0), "copying the objects of the file " + name() + " into " + dest);
+    f.flush();
   }
 
   // -------------------------
+  // The buffer of a memory file.
+  //
+  // The core driver allocates, resizes and frees the memory image through the file image callbacks below.
+  // They all work directly on the std::vector of the file_image, so that the buffer can be
+  // adopted from, and released to the user without any copy.
+  // The udata passed to HDF5 is a borrowed pointer to the file_image, which is owned by the h5::file
+  // and outlives the HDF5 file (closed in ~file, with all its objects).
+
+  struct file_image {
+    std::vector<std::byte> buf;
+  };
+
+  namespace {
+
+    std::vector<std::byte> &buffer_of(void *udata) { return static_cast<file_image *>(udata)->buf; }
+
+    extern "C" {
+
+    // The fapl, its copies and the file all share the buffer of the file_image
+    void *image_malloc(size_t size, H5FD_file_image_op_t op, void *udata) {
+      auto &buf = buffer_of(udata);
+      switch (op) {
+        case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_SET:
+        case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_COPY:
+        case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_GET:
+        case H5FD_FILE_IMAGE_OP_FILE_OPEN:
+          if (buf.size() < size) return nullptr;
+          return buf.data();
+        default: return nullptr;
+      }
+    }
 
-  file::file(const std::byte *buf, size_t size) {
+    // Nothing to copy, the source and destination buffers are the same
+    void *image_memcpy(void *dest, const void *src, size_t size, H5FD_file_image_op_t, void *) {
+      if (dest != src) std::memcpy(dest, src, size);
+      return dest;
+    }
 
-    proplist fapl = H5Pcreate(H5P_FILE_ACCESS);
-    CHECK_OR_THROW((fapl >= 0), "creating fapl");
+    void *image_realloc(void *, size_t size, H5FD_file_image_op_t op, void *udata) {
+      if (op != H5FD_FILE_IMAGE_OP_FILE_RESIZE) return nullptr;
+      auto &buf = buffer_of(udata);
+      try {
+        buf.resize(size);
+      } catch (std::bad_alloc const &) { return nullptr; }
+      return buf.data();
+    }
+
+    // The buffer is owned by the file_image, freed with it
+    herr_t image_free(void *, H5FD_file_image_op_t, void *) { return 0; }
+
+    void *udata_copy(void *udata) { return udata; }
 
-    auto err = H5Pset_fapl_core(fapl, (size_t)(64 * 1024), false);
-    CHECK_OR_THROW((err >= 0), "setting core file driver in fapl.");
+    herr_t udata_free(void *) { return 0; }
+    }
+
+    // fapl for a memory file backed by the image
+    proplist make_memory_fapl(file_image *image) {
+      proplist fapl = H5Pcreate(H5P_FILE_ACCESS);
+      CHECK_OR_THROW((fapl >= 0), "creating fapl");
+
+      auto err = H5Pset_fapl_core(fapl, (size_t)(64 * 1024), false);
+      CHECK_OR_THROW((err >= 0), "setting core file driver in fapl.");
 
-    err = H5Pset_file_image(fapl, (void *)buf, size);
-    CHECK_OR_THROW((err >= 0), "set file image in fapl.");
+      // Close all the objects with the file, as the buffer is released with the last h5::file
+      err = H5Pset_fclose_degree(fapl, H5F_CLOSE_STRONG);
+      CHECK_OR_THROW((err >= 0), "setting the close degree in fapl.");
+
+      H5FD_file_image_callbacks_t callbacks = {image_malloc, image_memcpy, image_realloc, image_free, udata_copy, udata_free, image};
+      err                                   = H5Pset_file_image_callbacks(fapl, &callbacks);
+      CHECK_OR_THROW((err >= 0), "setting the file image callbacks in fapl.");
+
+      if (not image->buf.empty()) {
+        err = H5Pset_file_image(fapl, image->buf.data(), image->buf.size());
+        CHECK_OR_THROW((err >= 0), "set file image in fapl.");
+      }
+      return fapl;
+    }
+
+  } // namespace
+
+  // -------------------------
+
+  // The core driver identifies the files by their name : each memory file has its own,
+  // so that several of them can be open at the same time
+  static std::string unique_memory_file_name() {
+    static std::atomic<unsigned long> counter = 0;
+    return "MemoryBuffer" + std::to_string(counter++);
+  }
 
-    this->id = H5Fopen("MemoryBuffer", H5F_ACC_RDWR, fapl);
+  file::file() : file(size_t{0}) {}
+
+  file::file(size_t size_hint) : image(std::make_shared<file_image>()) {
+    hdf5_lock lock;
+    image->buf.reserve(size_hint);
+    proplist fapl = make_memory_fapl(image.get());
+    this->id      = H5Fcreate(unique_memory_file_name().c_str(), 0, H5P_DEFAULT, fapl);
+    CHECK_OR_THROW((this->is_valid()), "created core file");
+  }
+
+  // -------------------------
+
+  file::file(std::vector<std::byte> &&buf) : image(std::make_shared<file_image>(file_image{std::move(buf)})) {
+    hdf5_lock lock;
+    proplist fapl = make_memory_fapl(image.get());
+    this->id      = H5Fopen(unique_memory_file_name().c_str(), H5F_ACC_RDWR, fapl);
     CHECK_OR_THROW((this->is_valid()), "opened received file image file");
   }
 
+  file::file(const std::byte *buf, size_t size) : file(std::vector<std::byte>(buf, buf + size)) {}
+
   // -------------------------
 
   std::vector<std::byte> file::as_buffer() const {
+    std::vector<std::byte> buf;
+    as_buffer(buf);
+    return buf;
+  }
+
+  void file::as_buffer(std::vector<std::byte> &buf) const {
+    hdf5_lock lock;
 
     auto f   = hid_t(*this);
     auto err = H5Fflush(f, H5F_SCOPE_GLOBAL);
@@ -115,12 +457,34 @@ namespace h5 {
     ssize_t image_len = H5Fget_file_image(f, nullptr, (size_t)0);
     CHECK_OR_THROW((image_len > 0), "got image file size");
 
-    std::vector<std::byte> buf(image_len, std::byte{0});
+    buf.resize(image_len);
 
     ssize_t bytes_read = H5Fget_file_image(f, (void *)buf.data(), (size_t)image_len);
     CHECK_OR_THROW(bytes_read == image_len, "wrote file into image buffer");
+  }
 
-    return buf;
+  // -------------------------
+
+  std::vector<std::byte> file::release_buffer() {
+    hdf5_lock lock;
+    CHECK_OR_THROW(image, "release_buffer : the file is not a memory file");
+    CHECK_OR_THROW((get_ref_count() == 1), "release_buffer : the file is still in use (e.g. by a group or a copy of the file)");
+    CHECK_OR_THROW((H5Fget_obj_count(id, H5F_OBJ_ALL) == 1), "release_buffer : some objects of the file are still open");
+
+    auto err = H5Fflush(id, H5F_SCOPE_GLOBAL);
+    CHECK_OR_THROW((err >= 0), "flushed core file.");
+    ssize_t image_len = H5Fget_file_image(id, nullptr, (size_t)0);
+    CHECK_OR_THROW((image_len > 0), "got image file size");
+
+    err = H5Fclose(id);
+    CHECK_OR_THROW((err >= 0), "closing the memory file");
+    id = 0;
+
+    // The core driver allocates by increments : drop the tail after the end of the file
+    auto res = std::move(image->buf);
+    image.reset();
+    if (res.size() > image_len) res.resize(image_len);
+    return res;
   }
 
 } // namespace h5
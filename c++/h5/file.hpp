@@ -19,10 +19,28 @@
 
 #include <vector>
 #include <span>
+#include <memory>
 #include "./object.hpp"
+#include "./write_policy.hpp"
+#include "./file_options.hpp"
+#include "./instrumentation.hpp"
+
+#ifdef H5_WITH_MPI
+#include <mpi.h>
+#endif
 
 namespace h5 {
 
+  struct file_image;
+
+  namespace detail {
+    // The write_session of a file, shared by its copies
+    struct write_session_state {
+      int depth = 0;               // number of nested sessions
+      std::shared_ptr<void> saved; // the configuration of the metadata cache before the sessions (cf. write_session.cpp)
+    };
+  } // namespace detail
+
   /**
    *  A little handler for the HDF5 file
    *
@@ -30,12 +48,35 @@ namespace h5 {
    */
   class file : public object {
 
+    write_policy policy;
+
+    // The buffer of a memory file (null for a file on disk)
+    std::shared_ptr<file_image> image;
+
+    // The I/O counters, shared by the copies of the file (null if the instrumentation is compiled out)
+#ifdef H5_WITH_INSTRUMENTATION
+    std::shared_ptr<instrumentation::file_stats> stats = std::make_shared<instrumentation::file_stats>();
+#else
+    std::shared_ptr<instrumentation::file_stats> stats;
+#endif
+
+    // The write_session of the file (cf. write_session.hpp)
+    std::shared_ptr<detail::write_session_state> session = std::make_shared<detail::write_session_state>();
+    friend class write_session;
+
     public:
     /**
      * Open a file in memory
      */
     file();
 
+    /**
+     * Open a file in memory, reserving size_hint bytes for its buffer
+     *
+     * @param size_hint  Expected size of the file image, to avoid the reallocations while writing
+     */
+    explicit file(size_t size_hint);
+
     /**
      * Open the file on disk
      *
@@ -53,12 +94,71 @@ namespace h5 {
     // Open the file on disk
     file(std::string const &name, char mode) : file(name.c_str(), mode) {}
 
+    /**
+     * Open the file on disk, with some access and creation properties
+     *
+     * @param name  name of the file
+     * @param mode  Opening mode, as above
+     * @param opts  The properties, e.g. the alignment or the metadata cache size
+     */
+    file(std::string const &name, char mode, file_options const &opts);
+
+#ifdef H5_WITH_MPI
+    /**
+     * Open the file on disk with the MPI-IO driver, collectively on all the ranks of comm
+     *
+     * All ranks must then take part in the creation of groups and datasets,
+     * and in the writes of slices (array_interface::write_slice), which are collective.
+     *
+     * @param name  name of the file
+     * @param mode  Opening mode, as for the serial file
+     * @param comm  The MPI communicator
+     * @param info  MPI info object, e.g. with hints for the MPI-IO layer
+     * @param opts  Access and creation properties, as for the serial file
+     */
+    file(std::string const &name, char mode, MPI_Comm comm, MPI_Info info = MPI_INFO_NULL, file_options const &opts = {});
+#endif
+
+    /// True iff the file was opened with the MPI-IO driver
+    [[nodiscard]] bool is_parallel() const;
+
     /// Name of the file
     [[nodiscard]] std::string name() const;
 
-    /// Flush the file
+    /// Flush the file : write all its metadata and data now, during a write_session too (its commit point)
     void flush();
 
+    /// Flush the file, except during a write_session where it is left to the end of the session, e.g. the flush of HDFArchive after each key
+    void flush_if_not_in_session();
+
+    /// True iff a write_session of the file is alive
+    [[nodiscard]] bool in_write_session() const { return session->depth > 0; }
+
+    /// True iff the file is opened in SWMR mode (cf. file_options::swmr), as the writer or as a reader
+    [[nodiscard]] bool is_swmr() const;
+
+    /**
+     * Switch a file opened for writing to the SWMR mode, e.g. once its datasets are created.
+     * The file must be opened with the latest format (file_options::latest_format).
+     */
+    void start_swmr_write();
+
+    /**
+     * For a SWMR reader : refresh the metadata of the groups and datasets of the file which are still open,
+     * to see the data written since they were opened, e.g. the new length of an appendable dataset.
+     */
+    void refresh();
+
+    /**
+     * Copy the live objects of the file (groups, datasets, attributes and links) into the new file dest,
+     * tightly packed : the space of the unlinked or overwritten objects is not copied. Cf. h5repack.
+     * The file is left unchanged. To compact it in place, close it and replace it by dest.
+     *
+     * @param dest  Name of the new file on disk, overwritten if it exists
+     * @param opts  Access and creation properties of the new file
+     */
+    void compact(std::string const &dest, file_options const &opts = {}) const;
+
     private:
     file(const std::byte *buf, size_t size);
 
@@ -69,8 +169,46 @@ namespace h5 {
     /// Create a file in memory from a byte buffer
     file(std::vector<std::byte> const &buf) : file(buf.data(), buf.size()) {}
 
+    /// Create a file in memory, adopting the byte buffer without copy
+    file(std::vector<std::byte> &&buf);
+
+    file(file const &) = default;
+    file(file &&)      = default;
+    file &operator=(file const &) = default;
+    file &operator=(file &&) = default;
+
+    // Release the HDF5 handle before the buffer of a memory file
+    ~file() { close(); }
+
     /// Get a copy of the associated byte buffer
     [[nodiscard]] std::vector<std::byte> as_buffer() const;
+
+    /// Copy the associated byte buffer into buf, reusing its capacity
+    void as_buffer(std::vector<std::byte> &buf) const;
+
+    /**
+     * Close a memory file and release its byte buffer without copy.
+     *
+     * Throws if the file is still used, e.g. by a group or a copy of this file.
+     */
+    [[nodiscard]] std::vector<std::byte> release_buffer();
+
+    /// The policy passed to the groups opened from this file
+    [[nodiscard]] write_policy const &get_write_policy() const { return policy; }
+
+    /// Set the policy passed to the groups opened from this file afterwards
+    void set_write_policy(write_policy p) { policy = std::move(p); }
+
+    /// The I/O counters of the file, shared by its copies. All 0 unless compiled with H5_WITH_INSTRUMENTATION.
+    [[nodiscard]] io_counters get_io_counters() const { return stats ? stats->snapshot() : io_counters{}; }
+
+    /// Reset the I/O counters to 0
+    void reset_io_counters() {
+      if (stats) stats->reset();
+    }
+
+    // internal : the counters updated by the instrumentation
+    [[nodiscard]] instrumentation::file_stats *get_stats() const { return stats.get(); }
   };
 
 } // namespace h5
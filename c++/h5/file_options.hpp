@@ -0,0 +1,87 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_FILE_OPTIONS_HPP
+#define LIBH5_FILE_OPTIONS_HPP
+
+#include <cstddef>
+
+namespace h5 {
+
+  /**
+   * Access and creation properties of a file on disk, passed to the file constructor.
+   *
+   * The access properties apply to every opening of the file, the creation properties
+   * (marked below) only when the file is created, i.e. in mode 'w', 'e', or 'a' for a new file.
+   * A 0 leaves the HDF5 default.
+   */
+  struct file_options {
+
+    /// Use the latest file format (H5Pset_libver_bounds). The file may not be readable by older HDF5 versions.
+    bool latest_format = false;
+
+    /// Align the objects larger than alignment_threshold bytes on a multiple of alignment bytes, e.g. the stripe size of the file system
+    std::size_t alignment           = 0;
+    std::size_t alignment_threshold = 1;
+
+    /// Size in bytes of the blocks in which the metadata are aggregated (H5Pset_meta_block_size)
+    std::size_t meta_block_size = 0;
+
+    /// Size in bytes of the blocks in which the small raw data are aggregated (H5Pset_small_data_block_size)
+    std::size_t small_data_block_size = 0;
+
+    /// Initial and maximal size in bytes of the metadata cache
+    std::size_t metadata_cache_size = 0;
+
+    /**
+     * Default chunk cache of the datasets (H5Pset_cache) : size in bytes, number of slots (a prime, about 100 times the number
+     * of chunks in the cache), and preemption policy w0 in [0, 1] (negative : the HDF5 default).
+     * It can be sized for each dataset by its access pattern, cf. group::open_dataset.
+     */
+    std::size_t chunk_cache_bytes = 0;
+    std::size_t chunk_cache_slots = 0;
+    double chunk_cache_w0         = -1;
+
+    /// Size in bytes of the sieve buffer, for the partial I/O of contiguous datasets (H5Pset_sieve_buf_size)
+    std::size_t sieve_buf_size = 0;
+
+    /// Creation : allocate the file space by pages (paged aggregation), of file_space_page_size bytes
+    bool paged_aggregation           = false;
+    std::size_t file_space_page_size = 0;
+
+    /**
+     * Creation : track the free space of the file in the file itself (H5Pset_file_space_strategy with persist),
+     * so that the space of the objects unlinked, e.g. by create_group(key, true), is reused after the file is reopened.
+     * The free sections smaller than free_space_threshold bytes are not tracked.
+     */
+    bool persist_free_space          = false;
+    std::size_t free_space_threshold = 1;
+
+    /// Size in bytes of the page buffer. Only for files created with paged_aggregation.
+    std::size_t page_buffer_size = 0;
+
+    /**
+     * Single writer / multiple readers (SWMR) : the file is opened with H5F_ACC_SWMR_READ in mode 'r',
+     * and with H5F_ACC_SWMR_WRITE and the latest format in the other modes.
+     * The readers may then read the file, e.g. the data appended to a dataset (cf. array_interface::append),
+     * while the writer keeps writing it. Cf. file::refresh.
+     */
+    bool swmr = false;
+  };
+
+} // namespace h5
+
+#endif // LIBH5_FILE_OPTIONS_HPP
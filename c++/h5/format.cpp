@@ -20,27 +20,27 @@
 
 namespace h5 {
 
-  void read_hdf5_format(object obj, std::string &s) {
+  void read_hdf5_format(object const &obj, std::string &s) {
     h5_read_attribute(obj, "Format", s);
     if (s == "") { // Backward compatibility
       h5_read_attribute(obj, "TRIQS_HDF5_data_scheme", s);
     }
   }
 
-  std::string read_hdf5_format(group g) {
+  std::string read_hdf5_format(group const &g) {
     std::string s;
     read_hdf5_format(g, s);
     return s;
   }
 
-  void read_hdf5_format_from_key(group g, std::string const &key, std::string &s) {
+  void read_hdf5_format_from_key(group const &g, std::string const &key, std::string &s) {
     h5_read_attribute_from_key(g, key, "Format", s);
     if (s == "") { // Backward compatibility
       h5_read_attribute_from_key(g, key, "TRIQS_HDF5_data_scheme", s);
     }
   }
 
-  void assert_hdf5_format_as_string(group g, const char *tag_expected, bool ignore_if_absent) {
+  void assert_hdf5_format_as_string(group const &g, const char *tag_expected, bool ignore_if_absent) {
     auto tag_file = read_hdf5_format(g);
     if (ignore_if_absent and tag_file.empty()) return;
     if (tag_file != tag_expected)
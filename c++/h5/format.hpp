@@ -70,27 +70,28 @@ namespace h5 {
     return hdf5_format_impl<T>::invoke();
   }
 
-  inline void write_hdf5_format_as_string(object obj, std::string const &s) { h5_write_attribute(obj, "Format", s); }
+  // Write the h5 format tag s to the object, as a string of fixed size in its header (cf. h5_write_attribute_fixed_size)
+  inline void write_hdf5_format_as_string(object const &obj, std::string const &s) { h5_write_attribute_fixed_size(obj, "Format", s); }
 
   // Write the h5 format tag to the object
   template <typename T>
-  inline void write_hdf5_format(object obj, T const &) {
-    h5_write_attribute(obj, "Format", get_hdf5_format<T>());
+  inline void write_hdf5_format(object const &obj, T const &) {
+    write_hdf5_format_as_string(obj, get_hdf5_format<T>());
   }
 
   /// Read h5 format tag from the object
-  void read_hdf5_format(object obj, std::string &s);
-  std::string read_hdf5_format(group g);
+  void read_hdf5_format(object const &obj, std::string &s);
+  std::string read_hdf5_format(group const &g);
 
   /// Add the h5 format tag to the key in the group
-  void read_hdf5_format_from_key(group g, std::string const &key, std::string &s);
+  void read_hdf5_format_from_key(group const &g, std::string const &key, std::string &s);
 
   /// Asserts that the tag of the group is the same as the given string. Throws std::runtime_error if incompatible
-  void assert_hdf5_format_as_string(group g, const char *tag_expected, bool ignore_if_absent = false);
+  void assert_hdf5_format_as_string(group const &g, const char *tag_expected, bool ignore_if_absent = false);
 
   /// Asserts that the tag of the group is the same as for T. Throws std::runtime_error if incompatible
   template <typename T>
-  void assert_hdf5_format(group g, T const &, bool ignore_if_absent = false) {
+  void assert_hdf5_format(group const &g, T const &, bool ignore_if_absent = false) {
     assert_hdf5_format_as_string(g, get_hdf5_format<T>().c_str(), ignore_if_absent);
   }
 
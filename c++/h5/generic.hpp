@@ -30,7 +30,7 @@ namespace h5 {
    * @return The value read from the file
    */
   template <typename T>
-  T h5_read(group g, std::string const &key) {
+  T h5_read(group const &g, std::string const &key) {
     if constexpr (std::is_default_constructible_v<T>) {
       T x{};
       h5_read(g, key, x);
@@ -41,17 +41,17 @@ namespace h5 {
   }
 
   template <typename T>
-  T read(group g, std::string const &key) {
+  T read(group const &g, std::string const &key) {
     return h5_read<T>(g, key);
   }
 
   template <typename T>
-  void read(group g, std::string const &key, T &x) {
+  void read(group const &g, std::string const &key, T &x) {
     h5_read(g, key, x);
   }
 
   template <typename T>
-  void write(group g, std::string const &key, T const &x) {
+  void write(group const &g, std::string const &key, T const &x) {
     h5_write(g, key, x);
   }
 
@@ -64,24 +64,24 @@ namespace h5 {
    * @return The attribute object, and "" if the attribute does not exist.
    */
   template <typename T>
-  T h5_read_attribute(object obj, std::string const &name) {
+  T h5_read_attribute(object const &obj, std::string const &name) {
     T x;
     h5_read_attribute(obj, name, x);
     return x;
   }
 
   template <typename T>
-  T read_attribute(group g, std::string const &key) {
+  T read_attribute(group const &g, std::string const &key) {
     return h5_read_attribute<T>(g, key);
   }
 
   template <typename T>
-  void read_attribute(group g, std::string const &key, T &x) {
+  void read_attribute(group const &g, std::string const &key, T &x) {
     h5_read(g, key, x);
   }
 
   template <typename T>
-  void write_attribute(group g, std::string const &key, T const &x) {
+  void write_attribute(group const &g, std::string const &key, T const &x) {
     h5_write(g, key, x);
   }
 
@@ -95,7 +95,7 @@ namespace h5 {
    * @return The attribute object, and "" if the attribute does not exist.
    */
   template <typename T>
-  T h5_read_attribute_from_key(group g, std::string const &key, std::string const &name) {
+  T h5_read_attribute_from_key(group const &g, std::string const &key, std::string const &name) {
     T x;
     h5_read_attribute_from_key(g, key, name, x);
     return x;
@@ -111,7 +111,7 @@ namespace h5 {
    * @return true if the read succeeds, false if it fails
    */
   template <typename T>
-  inline bool h5_try_read(group g, std::string key, T &x) {
+  inline bool h5_try_read(group const &g, std::string const &key, T &x) {
     if (g.has_key(key)) {
       h5_read(g, key, x);
       return true;
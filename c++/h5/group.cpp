@@ -15,8 +15,11 @@
 // Authors: Henri Menke, Olivier Parcollet, Nils Wentzell
 
 #include <vector>
+#include <algorithm>
+#include <numeric>
 #include "./group.hpp"
 #include "./stl/string.hpp"
+#include "./format.hpp"
 
 #include <hdf5.h>
 #include <hdf5_hl.h>
@@ -29,7 +32,8 @@ namespace h5 {
 
   //static_assert(std::is_same<::hid_t, hid_t>::value, "Internal error");
 
-  group::group(file f) : object(), parent_file(f) {
+  group::group(file f) : object(), parent_file(f), policy(f.get_write_policy()) {
+    hdf5_lock lock;
     id = H5Gopen2(f, "/", H5P_DEFAULT);
     if (id < 0) throw std::runtime_error("Cannot open the root group / in the file " + f.name());
   }
@@ -42,6 +46,7 @@ namespace h5 {
   //group::group(hid_t id_) : group(object(id_)) {}
 
   std::string group::name() const {
+    hdf5_lock lock;
     char _n[1];
     ssize_t size = H5Iget_name(id, _n, 1); // first call, get the size only
     std::vector<char> buf(size + 1, 0x00);
@@ -51,9 +56,13 @@ namespace h5 {
     return res;
   }
 
-  bool group::has_key(std::string const &key) const { return H5Lexists(id, key.c_str(), H5P_DEFAULT); }
+  bool group::has_key(std::string const &key) const {
+    hdf5_lock lock;
+    return H5Lexists(id, key.c_str(), H5P_DEFAULT);
+  }
 
   bool group::has_subgroup(std::string const &key) const {
+    hdf5_lock lock;
     if (!has_key(key)) return false;
     hid_t id_node = H5Oopen(id, key.c_str(), H5P_DEFAULT);
     if (id_node <= 0) return false;
@@ -63,6 +72,7 @@ namespace h5 {
   }
 
   bool group::has_dataset(std::string const &key) const {
+    hdf5_lock lock;
     if (!has_key(key)) return false;
     hid_t id_node = H5Oopen(id, key.c_str(), H5P_DEFAULT);
     if (id_node <= 0) return false;
@@ -72,6 +82,7 @@ namespace h5 {
   }
 
   void group::unlink(std::string const &key, bool error_if_absent) const {
+    hdf5_lock lock;
     if (!has_key(key)) {
       if (error_if_absent) throw std::runtime_error("The key " + key + " is not present in the group " + name());
       return;
@@ -82,22 +93,25 @@ namespace h5 {
   }
 
   group group::open_group(std::string const &key) const {
+    hdf5_lock lock;
     if (key.empty()) return *this;
     if (!has_key(key)) throw std::runtime_error("no subgroup " + key + " in the group");
     object sg = H5Gopen2(id, key.c_str(), H5P_DEFAULT);
     if (sg < 0) throw std::runtime_error("Error in opening the subgroup " + key);
-    return {sg, parent_file};
+    return {sg, parent_file, policy};
   }
 
   group group::create_group(std::string const &key, bool delete_if_exists) const {
+    hdf5_lock lock;
     if (key.empty()) return *this;
     if (delete_if_exists) unlink(key);
     object obj = H5Gcreate2(id, key.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
     if (not obj.is_valid()) throw std::runtime_error("Cannot create the subgroup " + key + " of the group " + name());
-    return {obj, parent_file};
+    return {obj, parent_file, policy};
   }
 
   void group::create_softlink(std::string const &target_key, std::string const& key, bool delete_if_exists) const {
+    hdf5_lock lock;
     if (target_key.empty() || key.empty()) return;
     if (!has_key(target_key)) throw std::runtime_error("The target key " + target_key + " does not exist in group " + name());
     if (delete_if_exists) unlink(key, false);
@@ -106,11 +120,153 @@ namespace h5 {
     if (err < 0) throw std::runtime_error("Cannot create softlink " + target_key + " <- " + key);
   }
 
+  namespace {
+
+    // The smallest prime >= n, for the number of slots of the chunk cache
+    size_t next_prime(size_t n) {
+      auto is_prime = [](size_t p) {
+        for (size_t d = 2; d * d <= p; ++d)
+          if (p % d == 0) return false;
+        return p >= 2;
+      };
+      while (not is_prime(n)) ++n;
+      return n;
+    }
+
+    // The dataset access properties with the chunk cache of the chunked dataset ds for the hint, or an invalid proplist
+    proplist make_hint_dapl(dataset const &ds, access_hint hint) {
+      proplist dcpl = H5Dget_create_plist(ds);
+      if (H5Pget_layout(dcpl) != H5D_CHUNKED) return {};
+
+      dataspace sp = H5Dget_space(ds);
+      int rank     = H5Sget_simple_extent_ndims(sp);
+      v_t dims(rank), cdims(rank);
+      H5Sget_simple_extent_dims(sp, dims.data(), nullptr);
+      H5Pget_chunk(dcpl, rank, cdims.data());
+      datatype ty        = H5Dget_type(ds);
+      size_t chunk_bytes = H5Tget_size(ty);
+      for (auto c : cdims) chunk_bytes *= c;
+
+      // Number of chunks along each dimension, and in the cache
+      v_t n_chunks(rank);
+      for (int d = 0; d < rank; ++d) n_chunks[d] = std::max(hsize_t{1}, (dims[d] + cdims[d] - 1) / cdims[d]);
+      auto product   = [&n_chunks](int first, int last) { return std::accumulate(n_chunks.begin() + first, n_chunks.begin() + last, size_t{1}, std::multiplies<>{}); };
+      size_t n_cache = 1;
+      double w0      = 0.75;
+      switch (hint) {
+        case access_hint::none: return {};
+        case access_hint::sequential:
+          n_cache = product(1, rank);
+          w0      = 1;
+          break;
+        case access_hint::random: n_cache = product(0, rank); break;
+        case access_hint::column_sweep:
+          n_cache = product(0, rank - 1);
+          w0      = 0;
+          break;
+      }
+
+      // Never smaller than the cache of the file
+      proplist dapl     = H5Dget_access_plist(ds);
+      size_t file_slots = 0, file_bytes = 0;
+      double file_w0 = 0;
+      H5Pget_chunk_cache(dapl, &file_slots, &file_bytes, &file_w0);
+
+      size_t bytes = std::max({file_bytes, chunk_bytes, std::min(n_cache * chunk_bytes, max_hint_chunk_cache_bytes)});
+      size_t slots = std::max(file_slots, next_prime(100 * (bytes / chunk_bytes)));
+
+      if (H5Pset_chunk_cache(dapl, slots, bytes, w0) < 0) throw std::runtime_error("Cannot set the chunk cache of the dataset");
+      return dapl;
+    }
+
+  } // namespace
+
   /// Open an existing DataSet. Throw if it does not exist.
-  dataset group::open_dataset(std::string const &key) const {
+  dataset group::open_dataset(std::string const &key, access_hint hint) const {
+    hdf5_lock lock;
     if (!has_key(key)) throw std::runtime_error("no dataset " + key + " in the group");
+    H5_TRACE_SCOPE(sc, parent_file.get_stats(), dataset_open, key);
     dataset ds = H5Dopen2(id, key.c_str(), H5P_DEFAULT);
     if (!ds.is_valid()) throw std::runtime_error("Cannot open dataset " + key + " in the group " + name());
+
+    // The chunk cache is set when the dataset is opened : close it and open it again, with the cache sized from its chunks.
+    // NB : the cache is not changed if the dataset is still open elsewhere.
+    if (hint != access_hint::none) {
+      if (auto dapl = make_hint_dapl(ds, hint); dapl.is_valid()) {
+        ds = dataset{};
+        ds = H5Dopen2(id, key.c_str(), dapl);
+        if (!ds.is_valid()) throw std::runtime_error("Cannot open dataset " + key + " in the group " + name());
+      }
+    }
+    return ds;
+  }
+
+  namespace {
+
+    // Same layout, chunk dimensions and filters, with the same parameters (e.g. the deflate level or the ZFP accuracy)
+    bool same_layout(hid_t dcpl1, hid_t dcpl2) {
+      auto layout = H5Pget_layout(dcpl1);
+      if (layout != H5Pget_layout(dcpl2)) return false;
+      if (layout != H5D_CHUNKED) return true;
+
+      int rank = H5Pget_chunk(dcpl1, 0, nullptr);
+      if (rank != H5Pget_chunk(dcpl2, 0, nullptr)) return false;
+      v_t c1(rank), c2(rank);
+      H5Pget_chunk(dcpl1, rank, c1.data());
+      H5Pget_chunk(dcpl2, rank, c2.data());
+      if (c1 != c2) return false;
+
+      int n = H5Pget_nfilters(dcpl1);
+      if (n != H5Pget_nfilters(dcpl2)) return false;
+      for (int i = 0; i < n; ++i) {
+        unsigned flags = 0, config = 0;
+        size_t n_cd1 = 0, n_cd2 = 0; // first call : the numbers of parameters only
+        if (H5Pget_filter2(dcpl1, i, &flags, &n_cd1, nullptr, 0, nullptr, &config) != H5Pget_filter2(dcpl2, i, &flags, &n_cd2, nullptr, 0, nullptr, &config))
+          return false;
+        if (n_cd1 != n_cd2) return false;
+        std::vector<unsigned> cd1(n_cd1), cd2(n_cd2);
+        H5Pget_filter2(dcpl1, i, &flags, &n_cd1, cd1.data(), 0, nullptr, &config);
+        H5Pget_filter2(dcpl2, i, &flags, &n_cd2, cd2.data(), 0, nullptr, &config);
+        if (cd1 != cd2) return false;
+      }
+      return true;
+    }
+
+    // Remove all the attributes of ds : the writer sets them again
+    void delete_attributes(dataset const &ds) {
+#if H5_VERSION_GE(1, 12, 0)
+      H5O_info2_t info;
+      herr_t err = H5Oget_info3(ds, &info, H5O_INFO_NUM_ATTRS);
+#else
+      H5O_info_t info;
+      herr_t err = H5Oget_info2(ds, &info, H5O_INFO_NUM_ATTRS);
+#endif
+      if (err < 0) throw std::runtime_error("Cannot get the number of attributes of a dataset");
+      for (hsize_t i = info.num_attrs; i > 0; --i)
+        if (H5Adelete_by_idx(ds, ".", H5_INDEX_NAME, H5_ITER_DEC, 0, H5P_DEFAULT) < 0)
+          throw std::runtime_error("Cannot delete an attribute of a dataset");
+    }
+
+  } // namespace
+
+  dataset group::open_dataset_for_overwrite(std::string const &key, datatype const &ty, dataspace const &sp, hid_t pl) const {
+    hdf5_lock lock;
+    if (!has_dataset(key)) return {};
+    dataset ds = open_dataset(key);
+
+    datatype file_ty   = H5Dget_type(ds);
+    dataspace file_sp  = H5Dget_space(ds);
+    proplist file_dcpl = H5Dget_create_plist(ds);
+
+    // The layout of the new dataset, with the default creation properties for H5P_DEFAULT
+    proplist default_dcpl;
+    if (pl == H5P_DEFAULT) {
+      default_dcpl = H5Pcreate(H5P_DATASET_CREATE);
+      pl           = default_dcpl;
+    }
+    if (H5Tequal(file_ty, ty) <= 0 or H5Sextent_equal(file_sp, sp) <= 0 or not same_layout(file_dcpl, pl)) return {};
+
+    delete_attributes(ds);
     return ds;
   }
 
@@ -118,16 +274,65 @@ namespace h5 {
   * \brief Create a dataset.
   * \param key The name of the subgroup
   *
-  * NB : It unlinks the dataset if it exists.
+  * NB : It unlinks the dataset if it exists, unless it is overwritten in place (cf. write_policy::in_place_overwrite).
   */
-  dataset group::create_dataset(std::string const &key, datatype ty, dataspace sp, hid_t pl) const {
+  dataset group::create_dataset(std::string const &key, datatype const &ty, dataspace sp, hid_t pl) const {
+    hdf5_lock lock;
+    if (policy.in_place_overwrite) {
+      if (auto ds = open_dataset_for_overwrite(key, ty, sp, pl); ds.is_valid()) return ds;
+    }
     unlink(key);
+    H5_TRACE_SCOPE(sc, parent_file.get_stats(), dataset_create, key);
     dataset ds = H5Dcreate2(id, key.c_str(), ty, sp, H5P_DEFAULT, pl, H5P_DEFAULT);
     if (!ds.is_valid()) throw std::runtime_error("Cannot create the dataset " + key + " in the group " + name());
     return ds;
   }
 
-  dataset group::create_dataset(std::string const &key, datatype ty, dataspace sp) const { return create_dataset(key, ty, sp, H5P_DEFAULT); }
+  dataset group::create_dataset(std::string const &key, datatype const &ty, dataspace sp) const { return create_dataset(key, ty, sp, H5P_DEFAULT); }
+
+  //----------------------------------------------------------
+
+  dataset group::create_virtual_dataset(std::string const &key, datatype const &ty, v_t const &dims, std::vector<virtual_source> const &sources,
+                                        bool is_complex) const {
+    hdf5_lock lock;
+    size_t rank = dims.size();
+    if (is_complex and (rank == 0 or dims.back() != 2))
+      throw std::runtime_error("Cannot create the virtual dataset " + key + " : the last dimension of a complex dataset must be 2");
+
+    proplist dcpl    = H5Pcreate(H5P_DATASET_CREATE);
+    dataspace vspace = H5Screate_simple(int(rank), dims.data(), nullptr);
+
+    for (auto const &src : sources) {
+      auto mess = "Cannot create the virtual dataset " + key + " : the source " + src.src_file + ":" + src.src_dataset;
+      if (src.offset.size() != rank or src.count.size() != rank) throw std::runtime_error(mess + " does not have the rank of the dataset");
+      for (size_t d = 0; d < rank; ++d)
+        if (src.offset[d] + src.count[d] > dims[d]) throw std::runtime_error(mess + " is out of the bounds of the dataset");
+
+      v_t src_count  = (src.src_count.empty() ? src.count : src.src_count);
+      v_t src_offset = (src.src_offset.empty() ? v_t(src_count.size(), 0) : src.src_offset);
+      if (src_offset.size() != src_count.size()) throw std::runtime_error(mess + " : src_offset and src_count have different ranks");
+      auto n_elements = [](v_t const &c) { return std::accumulate(c.begin(), c.end(), hsize_t{1}, std::multiplies<>{}); };
+      if (n_elements(src_count) != n_elements(src.count)) throw std::runtime_error(mess + " : the blocks have different sizes");
+
+      // The source dataspace only needs to hold the block
+      v_t src_dims(src_count.size());
+      for (size_t d = 0; d < src_dims.size(); ++d) src_dims[d] = src_offset[d] + src_count[d];
+      dataspace src_space = H5Screate_simple(int(src_dims.size()), src_dims.data(), nullptr);
+
+      herr_t err = H5Sselect_hyperslab(vspace, H5S_SELECT_SET, src.offset.data(), nullptr, src.count.data(), nullptr);
+      err |= H5Sselect_hyperslab(src_space, H5S_SELECT_SET, src_offset.data(), nullptr, src_count.data(), nullptr);
+      err |= H5Pset_virtual(dcpl, vspace, src.src_file.c_str(), src.src_dataset.c_str(), src_space);
+      if (err < 0) throw std::runtime_error(mess + " can not be mapped");
+    }
+
+    H5Sselect_all(vspace);
+    unlink(key);
+    H5_TRACE_SCOPE(sc, parent_file.get_stats(), dataset_create, key);
+    dataset ds = H5Dcreate2(id, key.c_str(), ty, vspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    if (!ds.is_valid()) throw std::runtime_error("Cannot create the virtual dataset " + key + " in the group " + name());
+    if (is_complex) h5_write_attribute_fixed_size(ds, "__complex__", "1");
+    return ds;
+  }
 
   //----------------------------------------------------------
   // Keep as an example of H5LTset_attribute_string
@@ -140,51 +345,98 @@ namespace h5 {
   //-----------------------------------------------------------------------
 
   // C callbacks for the next functions using H5Literate
-  extern "C" {
-  herr_t get_group_elements_name_ds(::hid_t loc_id, const char *name, const H5L_info_t *, void *opdata) {
-    H5O_info_t object_info;
-    herr_t err = H5Oget_info_by_name(loc_id, name, &object_info, H5P_DEFAULT);
-    if (err < 0) throw std::runtime_error("get_group_elements_name_ds internal");
-    if (object_info.type == H5O_TYPE_DATASET) static_cast<std::vector<std::string> *>(opdata)->push_back(name);
-    return 0;
-  }
-  herr_t get_group_elements_name_grp(::hid_t loc_id, const char *name, const H5L_info_t *, void *opdata) {
-    H5O_info_t object_info;
-    herr_t err = H5Oget_info_by_name(loc_id, name, &object_info, H5P_DEFAULT);
-    if (err < 0) throw std::runtime_error("get_group_elements_name_grp internal");
-    if (object_info.type == H5O_TYPE_GROUP) static_cast<std::vector<std::string> *>(opdata)->push_back(name);
-    return 0;
-  }
-  herr_t get_group_elements_name_ds_grp(::hid_t loc_id, const char *name, const H5L_info_t *, void *opdata) {
-    H5O_info_t object_info;
-    herr_t err = H5Oget_info_by_name(loc_id, name, &object_info, H5P_DEFAULT);
-    if (err < 0) throw std::runtime_error("get_group_elements_name_grp internal");
-    if ((object_info.type == H5O_TYPE_GROUP) or (object_info.type == H5O_TYPE_DATASET))
-      static_cast<std::vector<std::string> *>(opdata)->push_back(name);
-    return 0;
+  namespace {
+
+    struct iterate_data {
+      std::vector<group_element> elements;
+      bool with_dataset_info, with_format;
+    };
+
+    extern "C" {
+    herr_t get_group_elements(::hid_t loc_id, const char *name, const H5L_info_t *, void *opdata) {
+      auto *data = static_cast<iterate_data *>(opdata);
+
+      // Only the basic info (type of the object), not the full object header
+#if H5_VERSION_GE(1, 12, 0)
+      H5O_info2_t object_info;
+      herr_t err = H5Oget_info_by_name3(loc_id, name, &object_info, H5O_INFO_BASIC, H5P_DEFAULT);
+#else
+      H5O_info_t object_info;
+      herr_t err = H5Oget_info_by_name2(loc_id, name, &object_info, H5O_INFO_BASIC, H5P_DEFAULT);
+#endif
+      if (err < 0) return -1;
+
+      group_element el{name};
+      if (object_info.type == H5O_TYPE_GROUP) el.kind = group_element::kind_t::group;
+      if (object_info.type == H5O_TYPE_DATASET) el.kind = group_element::kind_t::dataset;
+
+      // The object is opened once, for its dataset info and its attributes
+      bool dataset_info = (el.is_dataset() and data->with_dataset_info);
+      bool format_info  = (el.kind != group_element::kind_t::other and data->with_format);
+      if (dataset_info or format_info) {
+        object obj = H5Oopen(loc_id, name, H5P_DEFAULT);
+        if (!obj.is_valid()) return -1;
+        if (dataset_info) {
+          dataspace dspace = H5Dget_space(obj);
+          el.lengths.resize(H5Sget_simple_extent_ndims(dspace));
+          H5Sget_simple_extent_dims(dspace, el.lengths.data(), nullptr);
+          el.ty = H5Dget_type(obj);
+        }
+        if (format_info) {
+          try {
+            read_hdf5_format(obj, el.format);
+          } catch (...) { // no exception through the HDF5 iteration, and the other elements are still listed
+            el.format        = "";
+            el.format_unread = true;
+          }
+          if (el.is_dataset()) el.has_complex_attribute = (H5Aexists(obj, "__complex__") > 0);
+        }
+      }
+      data->elements.push_back(std::move(el));
+      return 0;
+    }
+    }
+
+    // names of the elements of g for which pred is true
+    template <typename P>
+    std::vector<std::string> get_names(group const &g, P pred) {
+      std::vector<std::string> res;
+      for (auto &el : g.get_all_elements())
+        if (pred(el)) res.push_back(std::move(el.name));
+      return res;
+    }
+
+  } // namespace
+
+  //-----------------------------------------------------------------------
+
+  long group::size() const {
+    hdf5_lock lock;
+    H5G_info_t info;
+    if (H5Gget_info(id, &info) < 0) throw std::runtime_error("Cannot get the info of the group " + name());
+    return info.nlinks;
   }
+
+  std::vector<group_element> group::get_all_elements(bool with_dataset_info, bool with_format) const {
+    hdf5_lock lock;
+    iterate_data data{{}, with_dataset_info, with_format};
+    data.elements.reserve(size());
+    H5_TRACE_SCOPE(sc, parent_file.get_stats(), iterate, name());
+    int r = H5Literate(::hid_t(id), H5_INDEX_NAME, H5_ITER_NATIVE, nullptr, get_group_elements, static_cast<void *>(&data));
+    if (r != 0) throw std::runtime_error("Iteration over the elements of group " + name() + " failed");
+    return std::move(data.elements);
   }
-  //-----------------------------------------------------------------------
 
   std::vector<std::string> group::get_all_subgroup_names() const {
-    std::vector<std::string> grp_name;
-    int r = H5Literate(::hid_t(id), H5_INDEX_NAME, H5_ITER_NATIVE, nullptr, get_group_elements_name_grp, static_cast<void *>(&grp_name));
-    if (r != 0) throw std::runtime_error("Iteration over subgroups of group " + name() + "failed");
-    return grp_name;
+    return get_names(*this, [](auto const &el) { return el.is_group(); });
   }
 
   std::vector<std::string> group::get_all_dataset_names() const {
-    std::vector<std::string> ds_name;
-    int r = H5Literate(::hid_t(id), H5_INDEX_NAME, H5_ITER_NATIVE, nullptr, get_group_elements_name_ds, static_cast<void *>(&ds_name));
-    if (r != 0) throw std::runtime_error("Iteration over datasets of group " + name() + "failed");
-    return ds_name;
+    return get_names(*this, [](auto const &el) { return el.is_dataset(); });
   }
 
   std::vector<std::string> group::get_all_subgroup_dataset_names() const {
-    std::vector<std::string> ds_name;
-    int r = H5Literate(::hid_t(id), H5_INDEX_NAME, H5_ITER_NATIVE, nullptr, get_group_elements_name_ds_grp, static_cast<void *>(&ds_name));
-    if (r != 0) throw std::runtime_error("Iteration over datasets of group " + name() + "failed");
-    return ds_name;
+    return get_names(*this, [](auto const &el) { return el.is_group() or el.is_dataset(); });
   }
 
 } // namespace h5
@@ -23,12 +23,92 @@
 
 namespace h5 {
 
+  /**
+   * An element of a group, as returned by group::get_all_elements
+   */
+  struct group_element {
+
+    /// The kind of object the link points to
+    enum class kind_t { group, dataset, other };
+
+    /// Name of the link in the group
+    std::string name;
+
+    /// Kind of object
+    kind_t kind = kind_t::other;
+
+    /// Dimensions of the dataset (only with the dataset info)
+    v_t lengths = {};
+
+    /// hdf5 type of the dataset (only with the dataset info)
+    datatype ty = {};
+
+    /// Format tag of the group or dataset, "" if none (only with the format info, cf. read_hdf5_format)
+    std::string format = {};
+
+    /// The Format tag could not be read with the listing, e.g. an attribute of another type (format is then "").
+    /// The error is left to the lookup of the key alone, cf. read_hdf5_format_from_key.
+    bool format_unread = false;
+
+    /// The dataset has the __complex__ attribute (only with the format info)
+    bool has_complex_attribute = false;
+
+    [[nodiscard]] bool is_group() const { return kind == kind_t::group; }
+    [[nodiscard]] bool is_dataset() const { return kind == kind_t::dataset; }
+  };
+
+  /**
+   * How a chunked dataset is going to be read, to size its chunk cache (cf. group::open_dataset).
+   * The cache is never made smaller than the one of the file, and at most max_hint_chunk_cache_bytes.
+   * It is kept as long as the dataset is open, e.g. in a h5_lengths_type reused for the reads of all the tiles.
+   */
+  enum class access_hint {
+    none,         ///< The chunk cache of the file (cf. file_options::chunk_cache_bytes)
+    sequential,   ///< Slices along the first dimension, in order : the cache holds one slice of chunks, the chunks fully read are evicted first
+    random,       ///< Blocks anywhere in the dataset : the cache holds all the chunks
+    column_sweep, ///< Slices along the last dimension, e.g. the columns of a matrix : the cache holds one column of chunks
+  };
+
+  /// The maximal size in bytes of a chunk cache sized by an access_hint
+  constexpr std::size_t max_hint_chunk_cache_bytes = std::size_t{256} << 20;
+
+  /**
+   * A source of a virtual dataset (cf. group::create_virtual_dataset) :
+   * the block of lengths src_count at src_offset in the dataset src_dataset of the file src_file,
+   * mapped to the block of lengths count at offset in the virtual dataset.
+   * The two blocks have the same number of elements, but the source may have another rank, e.g. a row of a matrix.
+   */
+  struct virtual_source {
+
+    /// Name of the source file, "." for the file of the virtual dataset
+    std::string src_file;
+
+    /// Path of the source dataset in its file
+    std::string src_dataset;
+
+    /// Position of the block in the virtual dataset
+    v_t offset;
+
+    /// Lengths of the block
+    v_t count;
+
+    /// Position of the block in the source dataset (empty : at 0)
+    v_t src_offset = {};
+
+    /// Lengths of the block in the source dataset (empty : count)
+    v_t src_count = {};
+  };
+
+  template <typename T>
+  class dataset_handle;
+
   /**
    *  HDF5 group
    */
   class group : public object {
 
     file parent_file;
+    write_policy policy;
 
     public:
     group() = default; // for python converter only
@@ -42,7 +122,8 @@ namespace h5 {
     private:
     // construct from the bare object and the parent
     // internal use only for open/create subgroup
-    group(object obj, file _parent_file) : object{obj}, parent_file(std::move(_parent_file)) {}
+    group(object obj, file _parent_file, write_policy _policy)
+       : object{std::move(obj)}, parent_file(std::move(_parent_file)), policy(std::move(_policy)) {}
 
     public:
     /// Name of the group
@@ -51,6 +132,12 @@ namespace h5 {
     /// Access to the parent file
     [[nodiscard]] file get_file() const { return parent_file; }
 
+    /// The policy used to create the compressed datasets in this group
+    [[nodiscard]] write_policy const &get_write_policy() const { return policy; }
+
+    /// Set the policy of this group. It is passed to the subgroups opened or created afterwards.
+    void set_write_policy(write_policy p) { policy = std::move(p); }
+
     /**
      * True iff key is an object in the group
      *
@@ -75,8 +162,9 @@ namespace h5 {
     /**
      * Unlinks the subgroup key if it exists
      * No error is thrown if key does not exists
-     * NB : unlink is almost a remove, but it does not really remove from the file (memory is not freed).
-     * After unlinking a large object, a h5repack may be needed. Cf HDF5 documentation.
+     * NB : unlink is almost a remove. The space of the object is reused in the file while it is open,
+     * and across the openings only with file_options::persist_free_space. Otherwise, the file does not shrink :
+     * cf. file::compact to copy the live objects into a new, packed file.
      *
      * @param key The name of the subgroup to be removed.
      * @param error_if_absent If True, throws an error if the key is missing.
@@ -113,17 +201,21 @@ namespace h5 {
      * Throws std::runtime_error if it does not exist.
      *
      * @param key  The name of the subgroup. If empty, return this group
+     * @param hint  For a chunked dataset, sizes the chunk cache (H5Pset_chunk_cache) for its access pattern
      */
-    [[nodiscard]] dataset open_dataset(std::string const &key) const;
+    [[nodiscard]] dataset open_dataset(std::string const &key, access_hint hint = access_hint::none) const;
 
     /**
      * Create a dataset in this group
+     *
+     * With write_policy::in_place_overwrite, an existing dataset of the same type, dataspace and layout
+     * is returned instead, without its attributes, to be overwritten.
      * 
      * @param key  The name of the dataset. 
      * @param ty Datatype
      * @param sp Dataspace
      */
-    [[nodiscard]] dataset create_dataset(std::string const &key, datatype ty, dataspace sp) const;
+    [[nodiscard]] dataset create_dataset(std::string const &key, datatype const &ty, dataspace sp) const;
 
     /**
      * Create a dataset in this group
@@ -133,7 +225,60 @@ namespace h5 {
      * @param sp Dataspace
      * @param pl Property list
      */
-    [[nodiscard]] dataset create_dataset(std::string const &key, datatype ty, dataspace sp, hid_t pl) const;
+    [[nodiscard]] dataset create_dataset(std::string const &key, datatype const &ty, dataspace sp, hid_t pl) const;
+
+    /**
+     * Open the dataset key as an array of T, to query its shape and read or write slices of it (cf. dataset_handle)
+     *
+     * @param key  The name of the dataset
+     * @param hint  Sizes the chunk cache for the access pattern
+     */
+    template <typename T>
+    [[nodiscard]] dataset_handle<T> open_dataset_handle(std::string const &key, access_hint hint = access_hint::none) const;
+
+    /**
+     * Create the dataset key for an array of T of the given shape, without writing any data, to be filled slice by slice
+     * (cf. dataset_handle::write_slice)
+     *
+     * @param key  The name of the dataset
+     * @param shape  The shape of the array
+     * @param compress  Chunk and compress the dataset, as for write
+     */
+    template <typename T>
+    [[nodiscard]] dataset_handle<T> create_dataset_handle(std::string const &key, v_t const &shape, bool compress = true) const;
+
+    /**
+     * The existing dataset key, if it has the type ty, the dataspace sp and the layout of the creation properties pl
+     * (layout, chunk dimensions and filters). Its attributes are then deleted. Otherwise, an invalid dataset.
+     */
+    [[nodiscard]] dataset open_dataset_for_overwrite(std::string const &key, datatype const &ty, dataspace const &sp, hid_t pl) const;
+
+    /**
+     * Create a virtual dataset (H5Pset_virtual), which maps blocks of datasets of other files into one array,
+     * e.g. the outputs of the ranks of a run, without copying them. It is read as a normal dataset.
+     * The source files are opened when the dataset is read : they need not exist yet.
+     * The parts of the virtual dataset not mapped by any source are read as 0.
+     *
+     * @param key  The name of the dataset
+     * @param ty  Datatype of the dataset, and of the sources
+     * @param dims  Dimensions of the dataset
+     * @param sources  The blocks of the sources. They may not overlap.
+     * @param is_complex  The sources are complex arrays : the last dimension is 2, and the dataset gets the __complex__ attribute
+     */
+    dataset create_virtual_dataset(std::string const &key, datatype const &ty, v_t const &dims, std::vector<virtual_source> const &sources,
+                                   bool is_complex = false) const;
+
+    /// Number of links in the group (H5Gget_info), without iterating over them
+    [[nodiscard]] long size() const;
+
+    /**
+     * All the elements of the group, with their kind, in a single iteration
+     *
+     * @param with_dataset_info  Also retrieve the dimensions and the type of the datasets
+     * @param with_format        Also retrieve the Format tag and the __complex__ attribute of the elements, e.g. to rebuild
+     *                           the objects of a group of many small groups without reading their attributes one by one
+     */
+    [[nodiscard]] std::vector<group_element> get_all_elements(bool with_dataset_info = false, bool with_format = false) const;
 
     /// Returns all names of subgroup of G
     [[nodiscard]] std::vector<std::string> get_all_subgroup_names() const;
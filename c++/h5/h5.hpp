@@ -31,7 +31,14 @@
 #include "./stl/tuple.hpp"
 #include "./stl/optional.hpp"
 #include "./stl/variant.hpp"
+#include "./compound.hpp"
+#include "./dataset_handle.hpp"
+#include "./sparse.hpp"
+#include "./device.hpp"
+#include "./storage_report.hpp"
+#include "./write_session.hpp"
 #include "./generic.hpp"
+#include "./async_writer.hpp"
 
 // Define this so cpp2py modules know whether hdf5 was included
 #define H5_INTERFACE_INCLUDED
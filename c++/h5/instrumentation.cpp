@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./instrumentation.hpp"
+#include "./json.hpp"
+
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace h5::instrumentation {
+
+  const char *to_string(op_t op) {
+    switch (op) {
+      case op_t::dataset_create: return "dataset_create";
+      case op_t::dataset_open: return "dataset_open";
+      case op_t::read: return "read";
+      case op_t::write: return "write";
+      case op_t::iterate: return "iterate";
+      case op_t::write_skipped: return "write_skipped";
+    }
+    return "unknown";
+  }
+
+  // ------------------------------------------------------------------
+
+  // The hook is replaced rarely, and read on every traced operation
+  static std::mutex hook_mutex;
+  static std::shared_ptr<hook_t const> global_hook;
+
+  void set_trace_hook(hook_t hook) {
+    auto h = (hook ? std::make_shared<hook_t const>(std::move(hook)) : nullptr);
+    std::lock_guard lock{hook_mutex};
+    global_hook = std::move(h);
+  }
+
+  static std::shared_ptr<hook_t const> get_trace_hook() {
+    std::lock_guard lock{hook_mutex};
+    return global_hook;
+  }
+
+  // ------------------------------------------------------------------
+
+  hook_t make_chrome_trace_hook(std::string const &filename) {
+
+    struct trace_file {
+      std::mutex mtx;
+      std::ofstream out;
+      bool first = true;
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+      ~trace_file() { out << "\n]}\n"; }
+    };
+
+    auto tf = std::make_shared<trace_file>();
+    tf->out.open(filename);
+    if (!tf->out) throw std::runtime_error("Cannot open the trace file " + filename);
+    tf->out << "{\"traceEvents\": [";
+
+    return [tf](event const &e) {
+      using us = std::chrono::duration<double, std::micro>;
+      std::lock_guard lock{tf->mtx};
+      tf->out << (tf->first ? "\n" : ",\n") << R"({"name": )" << detail::json_quote(e.key) << R"(, "cat": ")" << to_string(e.op) << R"(", "ph": "X", "ts": )"
+              << us(e.start - tf->t0).count() << R"(, "dur": )" << us(e.duration).count() << R"(, "pid": 0, "tid": 0, "args": {"bytes": )"
+              << e.bytes << R"(, "filtered": )" << (e.filtered ? "true" : "false") << "}}";
+      tf->first = false;
+    };
+  }
+
+  // ------------------------------------------------------------------
+
+  io_counters file_stats::snapshot() const {
+    return {bytes_read, bytes_written, datasets_created, datasets_opened, reads, writes, iterations,
+            writes_skipped, read_ns * 1e-9, write_ns * 1e-9, filter_ns * 1e-9};
+  }
+
+  void file_stats::reset() {
+    for (auto *c : {&bytes_read, &bytes_written, &datasets_created, &datasets_opened, &reads, &writes, &iterations, &writes_skipped, &read_ns,
+                    &write_ns, &filter_ns})
+      *c = 0;
+  }
+
+  scope::~scope() {
+    auto duration = std::chrono::steady_clock::now() - start;
+    long ns       = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+
+    if (stats) {
+      switch (op) {
+        case op_t::dataset_create: ++stats->datasets_created; break;
+        case op_t::dataset_open: ++stats->datasets_opened; break;
+        case op_t::iterate: ++stats->iterations; break;
+        case op_t::write_skipped: ++stats->writes_skipped; break;
+        case op_t::read:
+          ++stats->reads;
+          stats->bytes_read += long(bytes);
+          stats->read_ns += ns;
+          break;
+        case op_t::write:
+          ++stats->writes;
+          stats->bytes_written += long(bytes);
+          stats->write_ns += ns;
+          if (filtered) stats->filter_ns += ns;
+          break;
+      }
+    }
+
+    if (auto hook = get_trace_hook(); hook) {
+      try {
+        (*hook)(event{op, key, start, std::chrono::nanoseconds{ns}, bytes, filtered});
+      } catch (...) {} // never throw from a destructor
+    }
+  }
+
+} // namespace h5::instrumentation
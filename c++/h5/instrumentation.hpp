@@ -0,0 +1,124 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_INSTRUMENTATION_HPP
+#define LIBH5_INSTRUMENTATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace h5 {
+
+  /**
+   * I/O counters of an h5::file (cf. file::get_io_counters).
+   *
+   * They are only recorded when the library is compiled with H5_WITH_INSTRUMENTATION
+   * (CMake option Instrumentation=ON). Otherwise, they are all 0.
+   */
+  struct io_counters {
+    long bytes_read       = 0;
+    long bytes_written    = 0;
+    long datasets_created = 0;
+    long datasets_opened  = 0;
+    long reads            = 0; ///< Number of H5Dread
+    long writes           = 0; ///< Number of H5Dwrite
+    long iterations       = 0; ///< Number of H5Literate (group listings)
+    long writes_skipped   = 0; ///< Number of datasets not written again, as unchanged (cf. write_policy::skip_unchanged)
+    double read_seconds   = 0; ///< Time spent in H5Dread
+    double write_seconds  = 0; ///< Time spent in H5Dwrite
+    double filter_seconds = 0; ///< Part of write_seconds spent writing filtered (compressed) datasets
+  };
+
+  namespace instrumentation {
+
+    /// The kinds of the traced operations
+    enum class op_t { dataset_create, dataset_open, read, write, iterate, write_skipped };
+
+    /// Name of the operation, e.g. "read"
+    const char *to_string(op_t op);
+
+    /// A traced operation, passed to the trace hook
+    struct event {
+      op_t op;
+      std::string const &key;        ///< Name of the dataset or group
+      std::chrono::steady_clock::time_point start;
+      std::chrono::nanoseconds duration;
+      std::size_t bytes;             ///< Bytes read or written, or not written for write_skipped (0 for the other operations)
+      bool filtered;                 ///< For a write, true iff the dataset is filtered
+    };
+
+    /// The hook called after each traced operation. It may be called concurrently from several threads.
+    using hook_t = std::function<void(event const &)>;
+
+    /// Set the trace hook (an empty hook disables tracing)
+    void set_trace_hook(hook_t hook);
+
+    /**
+     * A trace hook writing the events to a file in the Chrome trace event format (JSON),
+     * to be viewed in chrome://tracing or https://ui.perfetto.dev.
+     * The file is completed when the last copy of the hook is destroyed, e.g. by set_trace_hook({}).
+     */
+    hook_t make_chrome_trace_hook(std::string const &filename);
+
+    // ---------------- Implementation details -------------------
+
+    // The counters of a file, shared by all its copies (and the groups opened from it)
+    struct file_stats {
+      std::atomic<long> bytes_read = 0, bytes_written = 0, datasets_created = 0, datasets_opened = 0, reads = 0, writes = 0, iterations = 0;
+      std::atomic<long> writes_skipped = 0;
+      std::atomic<long> read_ns = 0, write_ns = 0, filter_ns = 0;
+
+      [[nodiscard]] io_counters snapshot() const;
+      void reset();
+    };
+
+    // Times the operation op on key during its lifetime, then records it in the stats and calls the hook
+    class scope {
+      file_stats *stats;
+      op_t op;
+      std::string key;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      public:
+      std::size_t bytes = 0;
+      bool filtered     = false;
+
+      scope(file_stats *stats, op_t op, std::string key) : stats(stats), op(op), key(std::move(key)) {}
+      scope(scope const &)            = delete;
+      scope &operator=(scope const &) = delete;
+      ~scope();
+    };
+
+  } // namespace instrumentation
+
+} // namespace h5
+
+// H5_TRACE_SCOPE(var, stats, op, key) : declare the instrumentation::scope var.
+// H5_TRACE(statement) : a statement on it, e.g. H5_TRACE(sc.bytes = n)
+// Both are empty when the instrumentation is compiled out.
+#ifdef H5_WITH_INSTRUMENTATION
+#define H5_TRACE_SCOPE(var, stats, op, key) h5::instrumentation::scope var{stats, h5::instrumentation::op_t::op, key}
+#define H5_TRACE(...) __VA_ARGS__
+#else
+#define H5_TRACE_SCOPE(var, stats, op, key)
+#define H5_TRACE(...)
+#endif
+
+#endif // LIBH5_INSTRUMENTATION_HPP
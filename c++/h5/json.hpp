@@ -0,0 +1,46 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_JSON_HPP
+#define LIBH5_JSON_HPP
+
+#include <cstdio>
+#include <string>
+
+// Internal : the JSON output of the storage report and of the trace hook
+
+namespace h5::detail {
+
+  // s as a JSON string, quoted and escaped
+  inline std::string json_quote(std::string const &s) {
+    std::string r = "\"";
+    for (char c : s) {
+      if (c == '"' or c == '\\') {
+        r += '\\';
+        r += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+        r += buf;
+      } else
+        r += c;
+    }
+    return r + '"';
+  }
+
+} // namespace h5::detail
+
+#endif // LIBH5_JSON_HPP
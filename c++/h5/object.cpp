@@ -28,6 +28,8 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <mutex>
+#include <utility>
 
 namespace h5 {
 
@@ -82,60 +84,137 @@ namespace h5 {
     template <> hid_t hid_t_of<dcplx_t>  (){return  detail::cplx_cmpd_dt;}
     // clang-format on
 
-    // bool. Use a lambda to initialize it.
+    // bool. Created once, on first use (thread safe initialization of a local static)
     template <>
     hid_t hid_t_of<bool>() {
-      hid_t bool_enum_h5type = H5Tenum_create(H5T_NATIVE_CHAR);
-      char val = 0;
-      H5Tenum_insert(bool_enum_h5type, "FALSE", (val = 0, &val));
-      H5Tenum_insert(bool_enum_h5type, "TRUE", (val = 1, &val));
+      static hid_t const bool_enum_h5type = []() {
+        hdf5_lock lock;
+        hid_t dt = H5Tenum_create(H5T_NATIVE_CHAR);
+        char val = 0;
+        H5Tenum_insert(dt, "FALSE", (val = 0, &val));
+        H5Tenum_insert(dt, "TRUE", (val = 1, &val));
+        H5Tlock(dt);
+        return dt;
+      }();
       return bool_enum_h5type;
     }
+
+    // -----------------------  registry  ---------------------------
+
+    namespace {
+
+      // The names of the types, in the order of registered_types
+      constexpr std::array<char const *, std::tuple_size_v<registered_types>> registered_names = {
+         H5_AS_STRING(signed char),
+         H5_AS_STRING(char),
+         H5_AS_STRING(unsigned char),
+         H5_AS_STRING(bool),
+         H5_AS_STRING(short),
+         H5_AS_STRING(unsigned short),
+         H5_AS_STRING(int),
+         H5_AS_STRING(unsigned int),
+         H5_AS_STRING(long),
+         H5_AS_STRING(unsigned long),
+         H5_AS_STRING(long long),
+         H5_AS_STRING(unsigned long long),
+         H5_AS_STRING(float),
+         H5_AS_STRING(double),
+         H5_AS_STRING(long double),
+         H5_AS_STRING(std::complex<float>),
+         H5_AS_STRING(std::complex<double>),
+         H5_AS_STRING(std::complex<long double>),
+         H5_AS_STRING(std::string),
+         "Complex Compound Datatype" //
+      };
+
+      // Key of the lookup of a type : class, size and sign. The size of the strings is not compared (cf. hdf5_type_equal).
+      struct type_key_t {
+        H5T_class_t cls;
+        size_t size;
+        bool is_signed;
+        auto operator<=>(type_key_t const &) const = default;
+      };
+
+      type_key_t make_type_key(hid_t t) {
+        auto cls = H5Tget_class(t);
+        return {cls, (cls == H5T_STRING ? 0 : H5Tget_size(t)), (cls != H5T_INTEGER) or (H5Tget_sign(t) != H5T_SGN_NONE)};
+      }
+
+      // The indices of the registry, sorted by key. In case of equal keys, in the order of the registry.
+      struct sorted_index_t {
+        type_key_t key;
+        int index;
+      };
+
+      std::vector<sorted_index_t> const &registry_sorted_index() {
+        static auto const sorted = []() {
+          auto const &reg = type_registry();
+          std::vector<sorted_index_t> res;
+          for (int i = 0; i < int(reg.size()); ++i) res.push_back({make_type_key(reg[i].id), i});
+          std::stable_sort(res.begin(), res.end(), [](auto const &x, auto const &y) { return x.key < y.key; });
+          return res;
+        }();
+        return sorted;
+      }
+
+    } // namespace
+
+    std::array<registered_type, std::tuple_size_v<registered_types>> const &type_registry() {
+      static auto const registry = []<size_t... Is>(std::index_sequence<Is...>) {
+        hdf5_lock lock;
+        return std::array<registered_type, sizeof...(Is)>{registered_type{hid_t_of<std::tuple_element_t<Is, registered_types>>(), registered_names[Is]}...};
+      }(std::make_index_sequence<std::tuple_size_v<registered_types>>{});
+      return registry;
+    }
+
+    // The registry is built when the library is loaded, before any thread can hold the hdf5_lock
+    [[maybe_unused]] static auto const &registry_at_load = registry_sorted_index();
+
+    int find_registered_type(hid_t ty) {
+      hdf5_lock lock;
+      auto const &sorted = registry_sorted_index();
+      auto key           = make_type_key(ty);
+      auto pos = std::lower_bound(sorted.begin(), sorted.end(), key, [](auto const &x, auto const &k) { return x.key < k; });
+      for (; pos != sorted.end() and pos->key == key; ++pos) {
+        // The key determines the integer, floating point and string types
+        if (key.cls != H5T_ENUM and key.cls != H5T_COMPOUND) return pos->index;
+        if (H5Tequal(ty, type_registry()[pos->index].id) > 0) return pos->index;
+      }
+      return -1;
+    }
+
   } // namespace detail
 
-  // -----------------------  name  ---------------------------
+  // -----------------------  lock  ---------------------------
 
-  struct h5_name_t {
-    datatype hdf5_type; // type in hdf5
-    std::string name;   // name of the type
-  };
-
-  //---------
-
-  std::vector<h5_name_t> h5_name_table;
-
-  //----------
-
-  static void init_h5_name_table() {
-    h5_name_table = std::vector<h5_name_t>{
-       {hdf5_type<char>(), H5_AS_STRING(char)},
-       {hdf5_type<signed char>(), H5_AS_STRING(signed char)},
-       {hdf5_type<unsigned char>(), H5_AS_STRING(unsigned char)},
-       {hdf5_type<bool>(), H5_AS_STRING(bool)},
-       {hdf5_type<short>(), H5_AS_STRING(short)},
-       {hdf5_type<unsigned short>(), H5_AS_STRING(unsigned short)},
-       {hdf5_type<int>(), H5_AS_STRING(int)},
-       {hdf5_type<unsigned int>(), H5_AS_STRING(unsigned int)},
-       {hdf5_type<long>(), H5_AS_STRING(long)},
-       {hdf5_type<unsigned long>(), H5_AS_STRING(unsigned long)},
-       {hdf5_type<long long>(), H5_AS_STRING(long long)},
-       {hdf5_type<unsigned long long>(), H5_AS_STRING(unsigned long long)},
-       {hdf5_type<float>(), H5_AS_STRING(float)},
-       {hdf5_type<double>(), H5_AS_STRING(double)},
-       {hdf5_type<long double>(), H5_AS_STRING(long double)},
-       {hdf5_type<std::complex<float>>(), H5_AS_STRING(std::complex<float>)},
-       {hdf5_type<std::complex<double>>(), H5_AS_STRING(std::complex<double>)},
-       {hdf5_type<std::complex<long double>>(), H5_AS_STRING(std::complex<long double>)},
-       {hdf5_type<std::string>(), H5_AS_STRING(std::string)},
-       {hdf5_type<dcplx_t>(), "Complex Compound Datatype"} //
-    };
+  static std::recursive_mutex &hdf5_mutex() {
+    static std::recursive_mutex m;
+    return m;
   }
 
-  //--------
+  bool hdf5_lock::is_needed() {
+    static bool const needed = []() {
+      hbool_t is_ts = 0;
+      H5is_library_threadsafe(&is_ts);
+      return not is_ts;
+    }();
+    return needed;
+  }
+
+  hdf5_lock::hdf5_lock() : locked(is_needed()) {
+    if (locked) hdf5_mutex().lock();
+  }
 
-  object get_hdf5_type(dataset ds) { return H5Dget_type(ds); }
+  hdf5_lock::~hdf5_lock() {
+    if (locked) hdf5_mutex().unlock();
+  }
 
-  bool hdf5_type_equal(datatype dt1, datatype dt2) {
+  // -----------------------  name  ---------------------------
+
+  object get_hdf5_type(dataset const &ds) { return H5Dget_type(ds); }
+
+  bool hdf5_type_equal(datatype const &dt1, datatype const &dt2) {
+    hdf5_lock lock;
     // For string do not compare size, cset..
     if (H5Tget_class(dt1) == H5T_STRING) { return H5Tget_class(dt2) == H5T_STRING; }
     auto res = H5Tequal(dt1, dt2);
@@ -143,13 +222,14 @@ namespace h5 {
     return res > 0;
   }
 
-  std::string get_name_of_h5_type(datatype t) {
+  std::string get_name_of_h5_type(datatype const &t) {
 
-    if (h5_name_table.empty()) init_h5_name_table();
-    auto _end = h5_name_table.end();
-    auto pos  = std::find_if(h5_name_table.begin(), _end, [t](auto const &x) { return hdf5_type_equal(t, x.hdf5_type); });
-    if (pos == _end) throw std::logic_error("HDF5/Python : impossible error");
-    return pos->name;
+    hdf5_lock lock;
+    int i = detail::find_registered_type(t);
+    if (i >= 0) return detail::type_registry()[i].name;
+    // e.g. the user compound types
+    if (H5Tget_class(t) == H5T_COMPOUND) return "Compound Datatype";
+    throw std::logic_error("HDF5/Python : impossible error");
   }
 
   // -----------------------   Reference counting ---------------------------
@@ -157,16 +237,20 @@ namespace h5 {
   // xdecref, xincref manipulate the the ref, but ignore invalid (incl. 0) id.
   //  like XINC_REF and XDEC_REF in python
   inline void xdecref(hid_t id) {
+    hdf5_lock lock;
     if (H5Iis_valid(id)) H5Idec_ref(id);
   }
 
   inline void xincref(hid_t id) {
+    hdf5_lock lock;
     if (H5Iis_valid(id)) H5Iinc_ref(id);
   }
 
   // -----------------------  object  ---------------------------
 
-  object::object(object const &x) : id(x.id) { xincref(id); } // a new copy, a new ref.
+  object::object(object const &x) : id(x.id), is_immortal(x.is_immortal) { // a new copy, a new ref.
+    if (not is_immortal) xincref(id);
+  }
 
   // make an object when the id is now owned (simply inc. the ref).
   object object::from_borrowed(hid_t id) {
@@ -175,19 +259,48 @@ namespace h5 {
   }
 
   object &object::operator=(object &&x) noexcept { //steals the ref, after properly decref its own.
-    xdecref(id);
-    id   = x.id;
-    x.id = 0;
+    if (not is_immortal) xdecref(id);
+    id            = x.id;
+    is_immortal   = x.is_immortal;
+    x.id          = 0;
+    x.is_immortal = false;
     return *this;
   }
 
   void object::close() {
-    xdecref(id);
-    id = 0;
+    if (not is_immortal) xdecref(id);
+    id          = 0;
+    is_immortal = false;
   } // e.g. to close a file explicitely.
 
-  int object::get_ref_count() const { return H5Iget_ref(id); }
+  int object::get_ref_count() const {
+    hdf5_lock lock;
+    return H5Iget_ref(id);
+  }
+
+  bool object::is_valid() const {
+    hdf5_lock lock;
+    return H5Iis_valid(id) == 1;
+  }
 
-  bool object::is_valid() const { return H5Iis_valid(id) == 1; }
+  // -----------------------------------------------------------
+
+  datatype make_compound_type(size_t size, std::vector<compound_member> const &members) {
+    hdf5_lock lock;
+    datatype dt = H5Tcreate(H5T_COMPOUND, size);
+    if (!dt.is_valid()) throw std::runtime_error("Cannot create a compound datatype");
+    for (auto const &m : members) {
+      herr_t err = H5Tinsert(dt, m.name.c_str(), m.offset, m.ty);
+      if (err < 0) throw std::runtime_error("Cannot insert the member " + m.name + " in a compound datatype");
+    }
+    return dt;
+  }
+
+  datatype make_array_type(datatype const &ty, v_t const &dims) {
+    hdf5_lock lock;
+    datatype dt = H5Tarray_create2(ty, dims.size(), dims.data());
+    if (!dt.is_valid()) throw std::runtime_error("Cannot create an array datatype");
+    return dt;
+  }
 
 } // namespace h5
@@ -17,7 +17,11 @@
 #ifndef LIBH5_OBJECT_HPP
 #define LIBH5_OBJECT_HPP
 
+#include <array>
 #include <complex>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <sstream>
 #include "./macros.hpp"
@@ -56,6 +60,27 @@ namespace h5 {
     return std::runtime_error{fs.str()};
   }
 
+  /**
+   * Serializes the HDF5 calls of the library when libhdf5 is not built threadsafe.
+   *
+   * It holds a global recursive mutex for its lifetime, and does nothing with a threadsafe libhdf5
+   * (which has its own global lock). The functions of this library take it, so that several threads
+   * can read from a shared h5::file. Code calling the HDF5 C API directly on the same objects should take it too.
+   */
+  class hdf5_lock {
+    bool locked = false;
+
+    public:
+    hdf5_lock();
+    ~hdf5_lock();
+
+    hdf5_lock(hdf5_lock const &)            = delete;
+    hdf5_lock &operator=(hdf5_lock const &) = delete;
+
+    /// True iff libhdf5 is not threadsafe, i.e. the lock is really taken
+    static bool is_needed();
+  };
+
   /*
    * A handle to the a general HDF5 object
    *
@@ -68,10 +93,20 @@ namespace h5 {
     protected:
     hid_t id = 0; //NOLINT Ok, I want a protected variable ...
 
+    private:
+    bool is_immortal = false; // the id is never released : no reference counting
+
     public:
     /// make an h5::object from a simple borrowed ref (simply inc. the ref).
     static object from_borrowed(hid_t id);
 
+    /// make an h5::object from an id which lives as long as the program (e.g. a type of the registry), without reference counting.
+    static object immortal(hid_t id) {
+      object res{id};
+      res.is_immortal = true;
+      return res;
+    }
+
     /// Constructor from an owned id (or 0). It steals (take ownership) of the reference.
     object(hid_t id = 0) : id(id) {}
 
@@ -79,7 +114,10 @@ namespace h5 {
     object(object const &x);
 
     /// Steals the reference
-    object(object &&x) noexcept : id(x.id) { x.id = 0; }
+    object(object &&x) noexcept : id(x.id), is_immortal(x.is_immortal) {
+      x.id          = 0;
+      x.is_immortal = false;
+    }
 
     /// Copy the reference and incref
     object &operator=(object const &x) {
@@ -121,23 +159,79 @@ namespace h5 {
   namespace detail {
     template <typename T>
     hid_t hid_t_of();
-  }
+
+    // The C++ types with a predefined hdf5 type, in the order of the type registry.
+    // Some of them have equal hdf5 types (e.g. signed char and char, double and std::complex<double>) :
+    // find_registered_type returns the first one.
+    using registered_types = std::tuple<signed char, char, unsigned char, bool, short, unsigned short, int, unsigned int, long, unsigned long,
+                                        long long, unsigned long long, float, double, long double, std::complex<float>, std::complex<double>,
+                                        std::complex<long double>, std::string, dcplx_t>;
+
+    // Index of T in registered_types, or -1
+    template <typename T, typename Tuple = registered_types>
+    struct registry_index;
+
+    template <typename T, typename... Ts>
+    struct registry_index<T, std::tuple<Ts...>> {
+      static constexpr int value = []() {
+        int i = 0, r = -1;
+        ((r = (r < 0 and std::is_same_v<T, Ts>) ? i : r, ++i), ...);
+        return r;
+      }();
+    };
+
+    // C strings have the type of std::string
+    template <>
+    struct registry_index<char *> : registry_index<std::string> {};
+    template <>
+    struct registry_index<const char *> : registry_index<std::string> {};
+
+    // A type of the registry : created once, locked, never released
+    struct registered_type {
+      hid_t id;
+      char const *name;
+    };
+
+    // The registry of the types of registered_types, built on first use (thread safe)
+    std::array<registered_type, std::tuple_size_v<registered_types>> const &type_registry();
+
+    // Index in the registry of the first type equal to ty (cf. hdf5_type_equal), or -1.
+    // A lookup by class, size and sign : H5Tequal is only called for the enum (bool) and the compound (dcplx_t).
+    int find_registered_type(hid_t ty);
+  } // namespace detail
 
   template <typename T>
   datatype hdf5_type() {
-    return object::from_borrowed(detail::hid_t_of<T>());
+    constexpr int i = detail::registry_index<T>::value;
+    if constexpr (i >= 0)
+      return object::immortal(detail::type_registry()[i].id);
+    else
+      return object::from_borrowed(detail::hid_t_of<T>());
   }
 
   // ------------------------------
 
   // A function to get the name of a datatype in clear (for error messages)
-  std::string get_name_of_h5_type(datatype ty);
+  std::string get_name_of_h5_type(datatype const &ty);
 
   // Get hdf5 type of a dataset
-  object get_hdf5_type(dataset);
+  object get_hdf5_type(dataset const &);
 
   // Check equality of datatypes
-  bool hdf5_type_equal(datatype, datatype);
+  bool hdf5_type_equal(datatype const &, datatype const &);
+
+  // A member of a compound datatype : its name, its offset in bytes in the struct and its type
+  struct compound_member {
+    std::string name;
+    size_t offset;
+    datatype ty;
+  };
+
+  // Create a compound datatype of the given size in bytes, with the members
+  datatype make_compound_type(size_t size, std::vector<compound_member> const &members);
+
+  // Create an array datatype, of elements of type ty and dimensions dims
+  datatype make_array_type(datatype const &ty, v_t const &dims);
 
 } // namespace h5
 
@@ -0,0 +1,121 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./array_interface.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#if __has_include(<fcntl.h>)
+#include <fcntl.h>
+#endif
+
+namespace h5::array_interface {
+
+  namespace {
+
+    constexpr hsize_t no_address = std::numeric_limits<hsize_t>::max();
+
+    // Position of the data of ds in the file, and the size of its contiguous storage (0 if not contiguous)
+    std::pair<hsize_t, hsize_t> data_position(dataset const &ds) {
+      proplist dcpl = H5Dget_create_plist(ds);
+      auto layout   = H5Pget_layout(dcpl);
+
+      if (layout == H5D_CONTIGUOUS) {
+        haddr_t addr = H5Dget_offset(ds);
+        if (addr == HADDR_UNDEF) return {no_address, 0};
+        return {addr, H5Dget_storage_size(ds)};
+      }
+
+      if (layout == H5D_CHUNKED) {
+        dataspace dspace = H5Dget_space(ds);
+        hsize_t n_chunks = 0;
+        if (H5Dget_num_chunks(ds, dspace, &n_chunks) < 0 or n_chunks == 0) return {no_address, 0};
+        std::vector<hsize_t> offset(H5Sget_simple_extent_ndims(dspace));
+        unsigned filter_mask = 0;
+        haddr_t addr         = HADDR_UNDEF;
+        hsize_t size         = 0;
+        if (H5Dget_chunk_info(ds, dspace, 0, offset.data(), &filter_mask, &addr, &size) < 0 or addr == HADDR_UNDEF) return {no_address, 0};
+        return {addr, 0};
+      }
+      return {no_address, 0};
+    }
+
+    // Hint the OS to read the ranges ahead. Only for a file on disk with the default driver.
+    void readahead(group const &g, std::vector<std::pair<hsize_t, hsize_t>> const &ranges) {
+#ifdef POSIX_FADV_WILLNEED
+      if (ranges.empty()) return;
+      file f        = g.get_file();
+      proplist fapl = H5Fget_access_plist(f);
+      if (H5Pget_driver(fapl) != H5FD_SEC2) return;
+      void *handle = nullptr;
+      if (H5Fget_vfd_handle(f, fapl, &handle) < 0 or handle == nullptr) return;
+      int fd = *static_cast<int *>(handle);
+
+      for (auto const &[offset, size] : ranges) ::posix_fadvise(fd, off_t(offset), off_t(size), POSIX_FADV_WILLNEED);
+#endif
+    }
+
+  } // namespace
+
+  //-------------------------------------------------------
+
+  read_plan plan_read_batch(group const &g, std::vector<read_request> const &reqs, hsize_t max_gap) {
+    hdf5_lock lock;
+
+    // One pass on the metadata : the datasets are opened, and kept open for the reads
+    read_plan plan;
+    plan.lts.reserve(reqs.size());
+    std::vector<std::pair<hsize_t, hsize_t>> pos;
+    pos.reserve(reqs.size());
+    for (auto const &r : reqs) {
+      plan.lts.push_back(get_h5_lengths_type(g, r.name));
+      pos.push_back(data_position(plan.lts.back().ds));
+    }
+
+    plan.order.resize(reqs.size());
+    std::iota(plan.order.begin(), plan.order.end(), 0);
+    std::stable_sort(plan.order.begin(), plan.order.end(), [&pos](size_t i, size_t j) { return pos[i].first < pos[j].first; });
+
+    // The ranges of the contiguous datasets, merged if they are close
+    for (auto i : plan.order) {
+      auto [offset, size] = pos[i];
+      if (offset == no_address or size == 0) continue;
+      if (not plan.ranges.empty()) {
+        auto &[r_offset, r_size] = plan.ranges.back();
+        if (offset <= r_offset + r_size + max_gap) {
+          r_size = std::max(r_size, offset + size - r_offset);
+          continue;
+        }
+      }
+      plan.ranges.emplace_back(offset, size);
+    }
+    return plan;
+  }
+
+  //-------------------------------------------------------
+
+  void read_batch(group const &g, std::vector<read_request> const &reqs, read_batch_options const &opts) {
+    hdf5_lock lock;
+    auto plan = plan_read_batch(g, reqs, opts.max_gap);
+    if (opts.readahead) readahead(g, plan.ranges);
+    for (auto i : plan.order) read(g, reqs[i].name, reqs[i].v, plan.lts[i], reqs[i].sl);
+  }
+
+} // namespace h5::array_interface
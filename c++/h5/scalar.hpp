@@ -31,12 +31,12 @@ namespace h5 {
   } // namespace array_interface
 
   template <typename T>
-  void h5_write(group g, std::string const &name, T const &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T> or std::is_same_v<T, dcplx_t>) {
+  void h5_write(group const &g, std::string const &name, T const &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T> or std::is_same_v<T, dcplx_t>) {
     array_interface::write(g, name, array_interface::h5_array_view_from_scalar(x), false);
   }
 
   template <typename T>
-  void h5_read(group g, std::string const &name, T &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T> or std::is_same_v<T, dcplx_t>) {
+  void h5_read(group const &g, std::string const &name, T &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T> or std::is_same_v<T, dcplx_t>) {
 
     if constexpr (is_complex_v<T>) {
       // Backward compatibility to read complex stored the old way
@@ -51,26 +51,34 @@ namespace h5 {
       }
     }
 
+    // NB : a complex can also be read from a compound hdf5 datatype, cf. array_interface::read
     auto lt = array_interface::get_h5_lengths_type(g, name);
-
-    if constexpr (is_complex_v<T>) {
-      // Allow reading compound hdf5 dataype into complex
-      if (hdf5_type_equal(lt.ty, hdf5_type<dcplx_t>())) {
-        h5_read(g, name, reinterpret_cast<dcplx_t &>(x));
-        return;
-      }
-    }
-
     array_interface::read(g, name, array_interface::h5_array_view_from_scalar(x), lt);
   }
 
+  /**
+   * Append a scalar to the 1d dataset g[name].
+   * The dataset is created, with an unlimited length, if it does not exist.
+   *
+   * @param g The h5::group
+   * @param name Name of the dataset
+   * @param x The scalar to append
+   */
+  template <typename T>
+  void h5_append(group const &g, std::string const &name, T const &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
+    array_interface::h5_array_view v{hdf5_type<T>(), (void *)(&x), 1, is_complex_v<T>};
+    v.slab.count[0] = 1;
+    v.L_tot[0]      = 1;
+    array_interface::append(g, name, v);
+  }
+
   template <typename T>
-  void h5_write_attribute(object obj, std::string const &name, T const &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
+  void h5_write_attribute(object const &obj, std::string const &name, T const &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
     array_interface::write_attribute(obj, name, array_interface::h5_array_view_from_scalar(x));
   }
 
   template <typename T>
-  void h5_read_attribute(object obj, std::string const &name, T &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
+  void h5_read_attribute(object const &obj, std::string const &name, T &x) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
     array_interface::read_attribute(obj, name, array_interface::h5_array_view_from_scalar(x));
   }
 
@@ -21,13 +21,21 @@
 #include "./group.hpp"
 #include "./generic.hpp"
 
+#include <limits>
+
 namespace h5 {
 
+  /**
+   * Serialize an object into a byte buffer, through a file in memory
+   *
+   * @param x The object
+   * @param size_hint Expected size of the buffer, reserved before writing
+   */
   template <typename T>
-  std::vector<std::byte> serialize(T const &x) {
-    file f{};
+  std::vector<std::byte> serialize(T const &x, size_t size_hint = 0) {
+    file f{size_hint};
     h5_write(f, "object", x);
-    return f.as_buffer();
+    return f.release_buffer();
   }
 
   // -----------------------------
@@ -37,6 +45,61 @@ namespace h5 {
     file f{buf};
     return h5_read<T>(f, "object");
   }
+
+  /// Deserialize, adopting the buffer without copy
+  template <typename T>
+  T deserialize(std::vector<std::byte> &&buf) {
+    file f{std::move(buf)};
+    return h5_read<T>(f, "object");
+  }
+
+  // -----------------------------
+
+  /**
+   * Serialize objects repeatedly, e.g. the same-shaped objects in a loop, reusing the same file in memory and the same buffer.
+   *
+   * The datasets are stored contiguous, and overwritten in place (cf. write_policy::in_place_overwrite) :
+   * in the steady state, no file is created, the file does not grow and the buffer is not reallocated.
+   * The file is created again when its image grows beyond twice its first size, e.g. after a change of the type of the objects.
+   * The buffers are read with deserialize. A serializer is not thread safe : use one per thread.
+   */
+  class serializer {
+    size_t size_hint;
+    file f;
+    group root;
+    std::vector<std::byte> buf;
+    size_t first_size = 0;
+
+    void reset() {
+      f                      = file{size_hint};
+      auto p                 = f.get_write_policy();
+      p.in_place_overwrite   = true;
+      p.contiguous_threshold = std::numeric_limits<std::size_t>::max();
+      f.set_write_policy(p);
+      root       = group{f};
+      first_size = 0;
+    }
+
+    public:
+    /**
+     * @param size_hint Expected size of the buffers, reserved in the file
+     */
+    explicit serializer(size_t size_hint = 0) : size_hint{size_hint} { reset(); }
+
+    /// Serialize x. The buffer is overwritten by the next call.
+    template <typename T>
+    std::vector<std::byte> const &operator()(T const &x) {
+      h5_write(root, "object", x);
+      f.as_buffer(buf);
+      if (first_size == 0) {
+        first_size = buf.size();
+      } else if (buf.size() > 2 * first_size) {
+        reset();
+      }
+      return buf;
+    }
+  };
+
 } // namespace h5
 
 #endif // LIBH5_SERIALIZATION_HPP
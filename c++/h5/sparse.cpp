@@ -0,0 +1,63 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./array_interface.hpp"
+#include "./format.hpp"
+
+#include <stdexcept>
+
+namespace h5::array_interface {
+
+  namespace {
+
+    // Number of elements of the 1d view v, checked to be 1d
+    hsize_t length_1d(h5_array_view const &v, std::string const &what, std::string const &name) {
+      if (v.rank() != 1 + v.is_complex)
+        throw std::runtime_error("Error in write_sparse_csr : " + what + " of the sparse matrix " + name + " is not 1d");
+      return v.slab.count[0];
+    }
+
+  } // namespace
+
+  void write_sparse_csr(group const &g, std::string const &name, sparse_csr_view const &v, bool compress) {
+
+    if (v.indptr.is_complex or v.indices.is_complex)
+      throw std::runtime_error("Error in write_sparse_csr : the indices of the sparse matrix " + name + " must be integers");
+    if (v.shape[0] < 0 or v.shape[1] < 0) throw std::runtime_error("Error in write_sparse_csr : negative shape for the sparse matrix " + name);
+
+    auto n_indptr  = length_1d(v.indptr, "indptr", name);
+    auto n_indices = length_1d(v.indices, "indices", name);
+    auto n_data    = length_1d(v.data, "data", name);
+    if (n_indptr != hsize_t(v.shape[0]) + 1)
+      throw std::runtime_error("Error in write_sparse_csr : indptr of the sparse matrix " + name + " has " + std::to_string(n_indptr)
+                               + " elements for " + std::to_string(v.shape[0]) + " rows");
+    if (n_indices != n_data)
+      throw std::runtime_error("Error in write_sparse_csr : the sparse matrix " + name + " has " + std::to_string(n_indices) + " indices and "
+                               + std::to_string(n_data) + " values");
+
+    auto gr = g.create_group(name);
+    write_hdf5_format_as_string(gr, sparse_csr_format);
+
+    auto shape = v.shape;
+    h5_array_view shape_view{hdf5_type<long>(), shape.data(), 1, false};
+    shape_view.slab.count[0] = shape_view.L_tot[0] = 2;
+    write(gr, "shape", shape_view, false);
+    write(gr, "indptr", v.indptr, compress);
+    write(gr, "indices", v.indices, compress);
+    write(gr, "data", v.data, compress);
+  }
+
+} // namespace h5::array_interface
@@ -0,0 +1,129 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_SPARSE_HPP
+#define LIBH5_SPARSE_HPP
+
+#include "./array_interface.hpp"
+#include "./format.hpp"
+#include "./stl/vector.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace h5 {
+
+  /**
+   * A sparse matrix of T (arithmetic or complex) in compressed sparse row (CSR) format, as scipy.sparse.csr_matrix :
+   * the non-zero elements of row i are in the columns indices[indptr[i]:indptr[i+1]], with the values data[indptr[i]:indptr[i+1]].
+   *
+   * Format : a subgroup with the Format "SparseCSR" and the 1d datasets shape, indptr, indices and data (cf. array_interface::write_sparse_csr).
+   */
+  template <typename T, typename I = long>
+  struct sparse_csr {
+    std::array<long, 2> shape = {0, 0}; // number of rows and of columns
+    std::vector<I> indptr     = {0};    // number of rows + 1 offsets in indices and data
+    std::vector<I> indices;             // column of each non-zero element
+    std::vector<T> data;                // value of each non-zero element
+
+    [[nodiscard]] long n_rows() const { return shape[0]; }
+    [[nodiscard]] long n_cols() const { return shape[1]; }
+    [[nodiscard]] long nnz() const { return long(data.size()); }
+
+    bool operator==(sparse_csr const &) const = default;
+  };
+
+  template <typename T, typename I>
+  struct hdf5_format_impl<sparse_csr<T, I>> {
+    static std::string invoke() { return array_interface::sparse_csr_format; }
+  };
+
+  namespace detail {
+
+    // Read the elements [begin, begin + count) of the 1d dataset gr[name] into v
+    template <typename U>
+    void read_csr_range(group const &gr, std::string const &name, hsize_t begin, hsize_t count, std::vector<U> &v) {
+      auto lt = array_interface::get_h5_lengths_type(gr, name);
+      if (lt.rank() != 1 + lt.has_complex_attribute)
+        throw std::runtime_error("Error in h5_read : the dataset " + name + " of a sparse matrix is not 1d");
+      if (begin + count > lt.lengths[0])
+        throw std::runtime_error("Error in h5_read : the dataset " + name + " of a sparse matrix has only " + std::to_string(lt.lengths[0])
+                                 + " elements");
+      v.resize(count);
+      if (count == 0) return;
+      array_interface::hyperslab sl(1, lt.has_complex_attribute);
+      sl.offset[0] = begin;
+      sl.count[0]  = count;
+      array_interface::read(gr, name, array_interface::h5_array_view_from_vector(v), lt, sl);
+    }
+
+    // The subgroup g[name] of a sparse matrix, and its shape
+    inline std::pair<group, std::array<long, 2>> open_sparse_csr(group const &g, std::string const &name) {
+      auto gr = g.open_group(name);
+      assert_hdf5_format_as_string(gr, array_interface::sparse_csr_format);
+      std::vector<long> shape;
+      h5_read(gr, "shape", shape);
+      if (shape.size() != 2) throw std::runtime_error("Error in h5_read : the shape of the sparse matrix " + name + " is not 2d");
+      return {gr, {shape[0], shape[1]}};
+    }
+
+  } // namespace detail
+
+  template <typename T, typename I>
+  void h5_write(group const &g, std::string const &name, sparse_csr<T, I> const &m) {
+    using array_interface::h5_array_view_from_vector;
+    array_interface::write_sparse_csr(
+       g, name, {m.shape, h5_array_view_from_vector(m.indptr), h5_array_view_from_vector(m.indices), h5_array_view_from_vector(m.data)}, true);
+  }
+
+  template <typename T, typename I>
+  void h5_read(group const &g, std::string const &name, sparse_csr<T, I> &m) {
+    auto [gr, shape] = detail::open_sparse_csr(g, name);
+    m.shape          = shape;
+    h5_read(gr, "indptr", m.indptr);
+    h5_read(gr, "indices", m.indices);
+    h5_read(gr, "data", m.data);
+    if (shape[0] < 0 or m.indptr.size() != size_t(shape[0]) + 1 or m.indices.size() != m.data.size())
+      throw std::runtime_error("Error in h5_read : the sparse matrix " + name + " is inconsistent");
+  }
+
+  /**
+   * Read the rows [row_begin, row_end) of the sparse matrix g[name], without reading the others :
+   * the slice of indptr, then the slices of indices and data between its first and last offsets.
+   * The result has row_end - row_begin rows, and its indptr starts at 0.
+   */
+  template <typename T, typename I = long>
+  sparse_csr<T, I> read_csr_rows(group const &g, std::string const &name, long row_begin, long row_end) {
+    auto [gr, shape] = detail::open_sparse_csr(g, name);
+    if (row_begin < 0 or row_end < row_begin or row_end > shape[0])
+      throw std::runtime_error("Error in h5::read_csr_rows : the rows [" + std::to_string(row_begin) + ", " + std::to_string(row_end)
+                               + ") are not in the " + std::to_string(shape[0]) + " rows of the sparse matrix " + name);
+
+    sparse_csr<T, I> m;
+    m.shape = {row_end - row_begin, shape[1]};
+    detail::read_csr_range(gr, "indptr", row_begin, row_end - row_begin + 1, m.indptr);
+    auto nnz_begin = m.indptr.front(), nnz_end = m.indptr.back();
+    if (nnz_end < nnz_begin) throw std::runtime_error("Error in h5::read_csr_rows : indptr of the sparse matrix " + name + " is not sorted");
+    detail::read_csr_range(gr, "indices", nnz_begin, nnz_end - nnz_begin, m.indices);
+    detail::read_csr_range(gr, "data", nnz_begin, nnz_end - nnz_begin, m.data);
+    for (auto &p : m.indptr) p -= nnz_begin;
+    return m;
+  }
+
+} // namespace h5
+
+#endif // LIBH5_SPARSE_HPP
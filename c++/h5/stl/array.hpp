@@ -22,7 +22,6 @@
 #include <array>
 #include <algorithm>
 #include <type_traits>
-#include <iostream>
 
 namespace h5 {
 
@@ -35,7 +34,7 @@ namespace h5 {
    * @param a Array to save in the file
    */
   template <typename T, size_t N>
-  void h5_write(group g, std::string const &name, std::array<T, N> const &a) {
+  void h5_write(group const &g, std::string const &name, std::array<T, N> const &a) {
 
     if constexpr (std::is_same_v<T, std::string>) {
       auto char_arr = std::array<const char *, N>{};
@@ -70,7 +69,7 @@ namespace h5 {
    * @param a Array to read into
    */
   template <typename T, size_t N>
-  void h5_read(group g, std::string name, std::array<T, N> &a) {
+  void h5_read(group const &g, std::string const &name, std::array<T, N> &a) {
 
     if constexpr (std::is_same_v<T, std::string>) {
       auto char_arr = std::array<char *, N>{};
@@ -86,24 +85,7 @@ namespace h5 {
       H5_EXPECTS(lt.rank() == 1 + lt.has_complex_attribute);
       H5_EXPECTS(N == lt.lengths[0]);
 
-      if constexpr (is_complex_v<T>) {
-        // Allow reading compound hdf5 dataype into array<complex>
-        if (hdf5_type_equal(lt.ty, hdf5_type<dcplx_t>())) {
-          h5_read(g, name, reinterpret_cast<std::array<dcplx_t, N> &>(a));
-          return;
-        }
-
-        // Allow to read non-complex data into array<complex>
-        if (!lt.has_complex_attribute) {
-          std::cerr << "WARNING: Mismatching types in h5_read. Expecting a complex " + get_name_of_h5_type(hdf5_type<T>())
-                + " while the array stored in the hdf5 file has type " + get_name_of_h5_type(lt.ty) + "\n";
-          std::array<double, N> tmp{};
-          h5_read(g, name, tmp);
-          std::copy(begin(tmp), end(tmp), begin(a));
-          return;
-        }
-      }
-
+      // NB : array<complex> can also be read from a compound hdf5 datatype, or from real data, cf. array_interface::read
       array_interface::h5_array_view v{hdf5_type<T>(), (void *)(a.data()), 1 /*rank*/, is_complex_v<T>};
       v.slab.count[0]  = N;
       v.slab.stride[0] = 1;
@@ -20,7 +20,9 @@
 #include <map>
 #include <type_traits>
 #include "../group.hpp"
+#include "../format.hpp"
 #include "./string.hpp"
+#include "./vector.hpp"
 
 namespace h5 {
 
@@ -29,19 +31,54 @@ namespace h5 {
     static std::string invoke() { return "Dict"; }
   };
 
+  // Format of a map of scalars or strings, stored by columns
+  inline constexpr const char *columnar_map_format = "ColumnarDict";
+
+  namespace detail {
+    // The keys and values of the maps stored by columns (bool excluded : no std::vector<bool> view)
+    template <typename T>
+    constexpr bool is_columnar_map_key_v = (std::is_arithmetic_v<T> and not std::is_same_v<T, bool>) or std::is_same_v<T, std::string>;
+    template <typename T>
+    constexpr bool is_columnar_map_value_v = is_columnar_map_key_v<T> or is_complex_v<T>;
+  } // namespace detail
+
   /**
-   * Map of type keyT for the key and valueT for the value. keyT can be any 
-   * class as long as it is writeable to h5 (an operator "<" is needed to 
+   * Map of type keyT for the key and valueT for the value. keyT can be any
+   * class as long as it is writeable to h5 (an operator "<" is needed to
    * be used in a map in the first place).
+   *
+   * Format
+   *    * If keyT is arithmetic or std::string and valueT arithmetic, complex or std::string, and the map_layout
+   *      of the write_policy of f is columnar, a subgroup with the two 1d datasets "keys" and "values", in the order of the map
+   *    * Otherwise, if keyT is std::string, a subgroup with one element per key
+   *    * Otherwise, a subgroup with the subgroups 0,1,2,3 ..., each with the datasets "key" and "val"
   */
   template <typename keyT, typename valueT>
-  void h5_write(group f, std::string const &name, std::map<keyT, valueT> const &M) {
+  void h5_write(group const &f, std::string const &name, std::map<keyT, valueT> const &M) {
     auto gr = f.create_group(name);
-    write_hdf5_format(gr, M);
+
+    if constexpr (detail::is_columnar_map_key_v<keyT> and detail::is_columnar_map_value_v<valueT>) {
+      if (f.get_write_policy().map_layout == write_policy::map_layout_t::columnar) {
+        write_hdf5_format_as_string(gr, columnar_map_format);
+        std::vector<keyT> keys;
+        std::vector<valueT> values;
+        keys.reserve(M.size());
+        values.reserve(M.size());
+        for (auto const &[key, val] : M) {
+          keys.push_back(key);
+          values.push_back(val);
+        }
+        h5_write(gr, "keys", keys);
+        h5_write(gr, "values", values);
+        return;
+      }
+    }
 
     if constexpr (std::is_same_v<keyT, std::string>) {
+      write_hdf5_format(gr, M);
       for (auto const &[key, val] : M) h5_write(gr, key, val);
     } else {
+      write_hdf5_format(gr, M);
       int indx = 0;
       for (auto const &[key, val] : M) {
         auto element_gr = gr.create_group(std::to_string(indx));
@@ -53,11 +90,28 @@ namespace h5 {
   }
 
   template <typename keyT, typename valueT>
-  void h5_read(group f, std::string const &name, std::map<keyT, valueT> &M) {
+  void h5_read(group const &f, std::string const &name, std::map<keyT, valueT> &M) {
     auto gr = f.open_group(name);
     M.clear();
 
-    for (auto const &x : gr.get_all_subgroup_dataset_names()) {
+    if constexpr (detail::is_columnar_map_key_v<keyT> and detail::is_columnar_map_value_v<valueT>) {
+      if (read_hdf5_format(gr) == columnar_map_format) {
+        std::vector<keyT> keys;
+        std::vector<valueT> values;
+        h5_read(gr, "keys", keys);
+        h5_read(gr, "values", values);
+        if (keys.size() != values.size())
+          throw std::runtime_error("Error in h5_read : the map " + name + " has " + std::to_string(keys.size()) + " keys and "
+                                   + std::to_string(values.size()) + " values");
+        // The keys are sorted : each one is inserted at the end
+        for (size_t i = 0; i < keys.size(); ++i) M.emplace_hint(M.end(), std::move(keys[i]), std::move(values[i]));
+        return;
+      }
+    }
+
+    for (auto const &el : gr.get_all_elements()) {
+      if (not(el.is_group() or el.is_dataset())) continue;
+      auto const &x = el.name;
       valueT val;
       if constexpr (std::is_same_v<keyT, std::string>) {
         h5_read(gr, x, val);
@@ -32,7 +32,7 @@ namespace h5 {
    * Optional : write if the value is set.
    */
   template <typename T>
-  void h5_write(group gr, std::string const &name, std::optional<T> const &v) {
+  void h5_write(group const &gr, std::string const &name, std::optional<T> const &v) {
     if (bool(v)) h5_write(gr, name, *v);
   }
 
@@ -40,7 +40,7 @@ namespace h5 {
    * Read optional from the h5
    */
   template <typename T>
-  void h5_read(group gr, std::string name, std::optional<T> &v) {
+  void h5_read(group const &gr, std::string const &name, std::optional<T> &v) {
     v.reset();
     if (gr.has_key(name)) v.emplace(h5_read<T>(gr, name));
   }
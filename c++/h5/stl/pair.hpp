@@ -32,7 +32,7 @@ namespace h5 {
    * Write Pair of T1 and T2 as a subgroup with numbers
    */
   template <typename T1, typename T2>
-  void h5_write(group f, std::string const &name, std::pair<T1, T2> const &p) {
+  void h5_write(group const &f, std::string const &name, std::pair<T1, T2> const &p) {
     auto gr = f.create_group(name);
     write_hdf5_format(gr, p);
     h5_write(gr, "0", p.first);
@@ -43,7 +43,7 @@ namespace h5 {
    * Read Pair of T1 and T2 from group
    */
   template <typename T1, typename T2>
-  void h5_read(group f, std::string const &name, std::pair<T1, T2> &p) {
+  void h5_read(group const &f, std::string const &name, std::pair<T1, T2> &p) {
     auto gr = f.open_group(name);
     if (gr.get_all_subgroup_dataset_names().size() != 2)
       throw std::runtime_error("ERROR in std::pair h5_read: Incompatible number of group elements");
@@ -34,7 +34,8 @@ namespace h5 {
 
   // ------------------------------------------------------------------
 
-  void h5_write(group g, std::string const &name, std::string const &s) {
+  void h5_write(group const &g, std::string const &name, std::string const &s) {
+    hdf5_lock lock;
 
     datatype dt     = str_dtype();
     dataspace space = H5Screate(H5S_SCALAR);
@@ -47,7 +48,8 @@ namespace h5 {
 
   // -------------------- Read ----------------------------------------------
 
-  void h5_read(group g, std::string const &name, std::string &s) {
+  void h5_read(group const &g, std::string const &name, std::string &s) {
+    hdf5_lock lock;
     s = "";
 
     dataset ds       = g.open_dataset(name);
@@ -77,7 +79,8 @@ namespace h5 {
 
   // ------------------------------------------------------------------
 
-  void h5_write_attribute(object obj, std::string const &name, std::string const &s) {
+  void h5_write_attribute(object const &obj, std::string const &name, std::string const &s) {
+    hdf5_lock lock;
 
     datatype dt     = str_dtype();
     dataspace space = H5Screate(H5S_SCALAR);
@@ -90,14 +93,30 @@ namespace h5 {
     if (err < 0) throw std::runtime_error("Cannot write the attribute " + name);
   }
 
+  void h5_write_attribute_fixed_size(object const &obj, std::string const &name, std::string const &s) {
+    hdf5_lock lock;
+
+    if (H5Aexists(obj, name.c_str()) > 0 and H5Adelete(obj, name.c_str()) < 0) throw std::runtime_error("Cannot replace the attribute " + name);
+
+    datatype dt     = str_dtype(s.size() + 1); // null terminated
+    dataspace space = H5Screate(H5S_SCALAR);
+
+    attribute attr = H5Acreate2(obj, name.c_str(), dt, space, H5P_DEFAULT, H5P_DEFAULT);
+    if (!attr.is_valid()) throw std::runtime_error("Cannot create the attribute " + name);
+
+    herr_t err = H5Awrite(attr, dt, s.c_str());
+    if (err < 0) throw std::runtime_error("Cannot write the attribute " + name);
+  }
+
   // -------------------- Read ----------------------------------------------
 
   /// Return the attribute name of obj, and "" if the attribute does not exist.
-  void h5_read_attribute(object obj, std::string const &name, std::string &s) {
+  void h5_read_attribute(object const &obj, std::string const &name, std::string &s) {
+    hdf5_lock lock;
     s = "";
 
     // if the attribute is not present, return ""
-    if (H5LTfind_attribute(obj, name.c_str()) == 0) return;
+    if (H5Aexists(obj, name.c_str()) <= 0) return;
 
     attribute attr   = H5Aopen(obj, name.c_str(), H5P_DEFAULT);
     dataspace dspace = H5Aget_space(attr);
@@ -126,7 +145,8 @@ namespace h5 {
 
   // ------------------------------------------------------------------
 
-  void h5_write_attribute_to_key(group g, std::string const &key, std::string const &name, std::string const &s) {
+  void h5_write_attribute_to_key(group const &g, std::string const &key, std::string const &name, std::string const &s) {
+    hdf5_lock lock;
 
     datatype dt      = str_dtype();
     dataspace dspace = H5Screate(H5S_SCALAR);
@@ -141,7 +161,8 @@ namespace h5 {
   // -------------------- Read ----------------------------------------------
 
   /// Return the attribute name of key in group, and "" if the attribute does not exist.
-  void h5_read_attribute_from_key(group g, std::string const &key, std::string const &name, std::string &s) {
+  void h5_read_attribute_from_key(group const &g, std::string const &key, std::string const &name, std::string &s) {
+    hdf5_lock lock;
     s = "";
 
     // if the attribute is not present, return ""
@@ -174,6 +195,8 @@ namespace h5 {
 
   // --------------------------- char_buf -------------------------------------
 
+  datatype variable_str_dtype() { return str_dtype(); }
+
   datatype char_buf::dtype() const { return str_dtype(lengths.back()); }
 
   // the dataspace (without last dim, which is the string).
@@ -185,7 +208,8 @@ namespace h5 {
 
   // -----------   WRITE  ------------
 
-  void h5_write(group g, std::string const &name, char_buf const &cb) {
+  void h5_write(group const &g, std::string const &name, char_buf const &cb) {
+    hdf5_lock lock;
     auto dt     = cb.dtype();
     auto dspace = cb.dspace();
 
@@ -197,7 +221,8 @@ namespace h5 {
 
   // -----------  READ  ------------
 
-  void h5_read(group g, std::string const &name, char_buf &_cb) {
+  void h5_read(group const &g, std::string const &name, char_buf &_cb) {
+    hdf5_lock lock;
     dataset ds        = g.open_dataset(name);
     dataspace d_space = H5Dget_space(ds);
     datatype ty       = H5Dget_type(ds);
@@ -223,7 +248,8 @@ namespace h5 {
 
   // -----------   WRITE  ATTRIBUTE ------------
 
-  void h5_write_attribute(object obj, std::string const &name, char_buf const &cb) {
+  void h5_write_attribute(object const &obj, std::string const &name, char_buf const &cb) {
+    hdf5_lock lock;
     auto dt     = cb.dtype();
     auto dspace = cb.dspace();
 
@@ -236,7 +262,8 @@ namespace h5 {
 
   // ----- read attribute -----
 
-  void h5_read_attribute(object obj, std::string const &name, char_buf &_cb) {
+  void h5_read_attribute(object const &obj, std::string const &name, char_buf &_cb) {
+    hdf5_lock lock;
     attribute attr = H5Aopen(obj, name.c_str(), H5P_DEFAULT);
     if (!attr.is_valid()) throw make_runtime_error("Cannot open the attribute ", name);
 
@@ -39,10 +39,10 @@ namespace h5 {
    * @param name The name of the dataset
    * @param s String to be saved.
    */
-  void h5_write(group g, std::string const &name, std::string const &s);
+  void h5_write(group const &g, std::string const &name, std::string const &s);
 
   /// Write a const char array as a string
-  inline void h5_write(group g, std::string const &name, const char *s) { h5_write(g, name, std::string{s}); }
+  inline void h5_write(group const &g, std::string const &name, const char *s) { h5_write(g, name, std::string{s}); }
 
   /**
    * Read a string from an h5::group
@@ -51,10 +51,10 @@ namespace h5 {
    * @param name The name of the dataset
    * @param s The string to read into
    */
-  void h5_read(group g, std::string const &name, std::string &s);
+  void h5_read(group const &g, std::string const &name, std::string &s);
 
   // Explicitly forbidden.
-  inline void h5_read(group g, std::string const &name, char *s) = delete;
+  inline void h5_read(group const &g, std::string const &name, char *s) = delete;
 
   /**
    * Write a string attribute to an object
@@ -63,10 +63,18 @@ namespace h5 {
    * @param name The name of the attribute
    * @param s The string attribute
   */
-  void h5_write_attribute(object obj, std::string const &name, std::string const &s);
+  void h5_write_attribute(object const &obj, std::string const &name, std::string const &s);
 
   /// Write a const char array as a string attribute of an h5::object
-  inline void h5_write_attribute(object obj, std::string const &name, const char *s) { h5_write_attribute(obj, name, std::string{s}); }
+  inline void h5_write_attribute(object const &obj, std::string const &name, const char *s) { h5_write_attribute(obj, name, std::string{s}); }
+
+  /**
+   * Write a string attribute of a fixed size to an object, replacing the attribute if it exists.
+   *
+   * Unlike the variable length strings, the value is stored in the object header itself, not in the global heap :
+   * for the short tags read for many objects, e.g. the Format. It is read by h5_read_attribute as the other string attributes.
+   */
+  void h5_write_attribute_fixed_size(object const &obj, std::string const &name, std::string const &s);
 
   /**
    * Read a string attribute from an object
@@ -75,10 +83,10 @@ namespace h5 {
    * @param name The name of the attribute
    * @param value The string to read into
    */
-  void h5_read_attribute(object obj, std::string const &name, std::string &s);
+  void h5_read_attribute(object const &obj, std::string const &name, std::string &s);
 
   // Explicitly forbidden
-  inline void h5_read_attribute(object obj, std::string const &name, char *s) = delete;
+  inline void h5_read_attribute(object const &obj, std::string const &name, char *s) = delete;
 
   /**
    * Write a string attribute to a key in an h5::group
@@ -88,10 +96,10 @@ namespace h5 {
    * @param name The name of the attribute
    * @param s The string attribute
   */
-  void h5_write_attribute_to_key(group g, std::string const &key, std::string const &name, std::string const &s);
+  void h5_write_attribute_to_key(group const &g, std::string const &key, std::string const &name, std::string const &s);
 
   /// Write a const char array as a string attribute of a particular key
-  inline void h5_write_attribute_to_key(group g, std::string const &key, std::string const &name, const char *s) {
+  inline void h5_write_attribute_to_key(group const &g, std::string const &key, std::string const &name, const char *s) {
     h5_write_attribute_to_key(g, key, name, std::string{s});
   }
 
@@ -103,7 +111,7 @@ namespace h5 {
    * @param name The name of the attribute
    * @param s The string to read into
   */
-  void h5_read_attribute_from_key(group g, std::string const &key, std::string const &name, std::string &s);
+  void h5_read_attribute_from_key(group const &g, std::string const &key, std::string const &name, std::string &s);
 
   // ---------------------   char_buf -----------------------
 
@@ -120,11 +128,14 @@ namespace h5 {
     [[nodiscard]] dataspace dspace() const;
   };
 
+  // A variable-length UTF8 string datatype
+  datatype variable_str_dtype();
+
   // read/write for char_buf
-  void h5_write(group g, std::string const &name, char_buf const &cb);
-  void h5_write_attribute(object obj, std::string const &name, char_buf const &cb);
-  void h5_read(group g, std::string const &name, char_buf &_cb);
-  void h5_read_attribute(object obj, std::string const &name, char_buf &_cb);
+  void h5_write(group const &g, std::string const &name, char_buf const &cb);
+  void h5_write_attribute(object const &obj, std::string const &name, char_buf const &cb);
+  void h5_read(group const &g, std::string const &name, char_buf &_cb);
+  void h5_read_attribute(object const &obj, std::string const &name, char_buf &_cb);
 
 } // namespace h5
 
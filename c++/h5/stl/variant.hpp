@@ -33,12 +33,12 @@ namespace h5 {
   /**
    */
   template <typename... T>
-  void h5_write(group gr, std::string const &name, std::variant<T...> const &v) {
+  void h5_write(group const &gr, std::string const &name, std::variant<T...> const &v) {
     visit([&](auto const &x) { h5_write(gr, name, x); }, v);
   }
 
   template <typename VT, typename U, typename... T>
-  void h5_read_variant_helper(VT &v, datatype dt, group gr, std::string const &name) {
+  void h5_read_variant_helper(VT &v, datatype const &dt, group const &gr, std::string const &name) {
     if (hdf5_type_equal(hdf5_type<U>(), dt)) {
       v = VT{h5_read<U>(gr, name)};
       return;
@@ -53,7 +53,7 @@ namespace h5 {
    * Read variant from the h5
    */
   template <typename... T>
-  void h5_read(group gr, std::string const &name, std::variant<T...> &v) {
+  void h5_read(group const &gr, std::string const &name, std::variant<T...> &v) {
     // name is a group --> triqs object
     // assume for the moment, name is a dataset.
     dataset ds  = gr.open_dataset(name);
@@ -76,10 +76,9 @@ namespace h5 {
 
     long i = 0;
     for (auto &x : v) {
-      // Use full range from char_buf and remove null characters
+      // The string ends at the first null character, or fills the whole row
       const char *bptr = &cb.buffer[i * len_string];
-      x                = std::string(bptr, bptr + len_string);
-      x.erase(std::remove(begin(x), end(x), '\0'), end(x));
+      x.assign(bptr, strnlen(bptr, len_string));
       ++i;
     }
   }
@@ -95,32 +94,99 @@ namespace h5 {
     long i = 0;
     for (auto &v_inner : v) {
       for (int j = 0; j < inner_vec_size; ++j, ++i) {
-        // Use full range from char_buf and remove null characters
+        // The string ends at the first null character, or fills the whole row
         const char *bptr = &cb.buffer[i * len_string];
-        auto s           = std::string(bptr, bptr + len_string);
-        s.erase(std::remove(begin(s), end(s), '\0'), end(s));
-        v_inner.push_back(s);
+        v_inner.emplace_back(bptr, strnlen(bptr, len_string));
       }
     }
   }
 
+  // -----------  WRITE / READ  ------------
+
+  namespace detail {
+
+    // Is the vector better stored as variable-length strings, given the layout of the policy ?
+    static bool use_variable_length(std::vector<std::string> const &v, write_policy::string_layout_t layout) {
+      using layout_t = write_policy::string_layout_t;
+      if (layout != layout_t::automatic) return layout == layout_t::variable;
+      size_t total = 0, max_len = 0;
+      for (auto &x : v) {
+        total += x.size() + 1;
+        max_len = std::max(max_len, x.size() + 1);
+      }
+      return v.size() * max_len > 2 * total;
+    }
+
+    void write_strings(group const &g, std::string const &name, std::vector<std::string> const &v) {
+      hdf5_lock lock;
+      if (not use_variable_length(v, g.get_write_policy().string_layout)) {
+        h5_write(g, name, to_char_buf(v));
+        return;
+      }
+
+      // Only the pointers are gathered, the characters are written from the strings themselves
+      std::vector<const char *> ptrs(v.size());
+      std::transform(v.begin(), v.end(), ptrs.begin(), [](auto const &x) { return x.c_str(); });
+
+      datatype dt      = variable_str_dtype();
+      hsize_t n        = v.size();
+      dataspace dspace = H5Screate_simple(1, &n, nullptr);
+      dataset ds       = g.create_dataset(name, dt, dspace);
+
+      auto err = H5Dwrite(ds, dt, H5S_ALL, H5S_ALL, H5P_DEFAULT, ptrs.data());
+      if (err < 0) throw make_runtime_error("Error writing the vector<string> ", name, " in the group", g.name());
+    }
+
+    void read_strings(group const &g, std::string const &name, std::vector<std::string> &v) {
+      hdf5_lock lock;
+      dataset ds = g.open_dataset(name);
+      datatype ty = H5Dget_type(ds);
+
+      if (not H5Tis_variable_str(ty)) {
+        char_buf cb;
+        h5_read(g, name, cb);
+        from_char_buf(cb, v);
+        return;
+      }
+
+      dataspace dspace = H5Dget_space(ds);
+      if (H5Sget_simple_extent_ndims(dspace) != 1) throw make_runtime_error("h5 : reading a vector<string> and I got a variable-length string array of rank != 1");
+      hsize_t n = 0;
+      H5Sget_simple_extent_dims(dspace, &n, nullptr);
+      v.clear();
+      if (n == 0) return;
+
+      std::vector<char *> ptrs(n, nullptr);
+      auto err = H5Dread(ds, ty, H5S_ALL, H5S_ALL, H5P_DEFAULT, ptrs.data());
+      if (err < 0) throw make_runtime_error("Error reading the vector<string> ", name, " in the group", g.name());
+
+      v.resize(n);
+      for (size_t i = 0; i < n; ++i) v[i] = (ptrs[i] ? ptrs[i] : "");
+
+      // Free the resources allocated in the variable length read
+      err = H5Dvlen_reclaim(ty, dspace, H5P_DEFAULT, ptrs.data());
+      if (err < 0) throw std::runtime_error("Error in freeing resources in h5_read of variable-length string type");
+    }
+
+  } // namespace detail
+
   // -----------   WRITE  ATTRIBUTE ------------
 
-  void h5_write_attribute(object obj, std::string const &name, std::vector<std::string> const &v) { h5_write_attribute(obj, name, to_char_buf(v)); }
+  void h5_write_attribute(object const &obj, std::string const &name, std::vector<std::string> const &v) { h5_write_attribute(obj, name, to_char_buf(v)); }
 
-  void h5_write_attribute(object obj, std::string const &name, std::vector<std::vector<std::string>> const &v) {
+  void h5_write_attribute(object const &obj, std::string const &name, std::vector<std::vector<std::string>> const &v) {
     h5_write_attribute(obj, name, to_char_buf(v));
   }
 
   // -----------   READ  ATTRIBUTE ------------
 
-  void h5_read_attribute(object obj, std::string const &name, std::vector<std::string> &v) {
+  void h5_read_attribute(object const &obj, std::string const &name, std::vector<std::string> &v) {
     char_buf cb;
     h5_read_attribute(obj, name, cb);
     from_char_buf(cb, v);
   }
 
-  void h5_read_attribute(object obj, std::string const &name, std::vector<std::vector<std::string>> &v) {
+  void h5_read_attribute(object const &obj, std::string const &name, std::vector<std::vector<std::string>> &v) {
     char_buf cb;
     h5_read_attribute(obj, name, cb);
     from_char_buf(cb, v);
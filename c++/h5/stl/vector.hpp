@@ -19,10 +19,14 @@
 
 #include <vector>
 #include <complex>
+#include <optional>
+#include <tuple>
+#include <algorithm>
 #include "../group.hpp"
 #include "./string.hpp"
 #include "../format.hpp"
 #include "../scalar.hpp"
+#include "../compound.hpp"
 
 namespace h5 {
 
@@ -49,6 +53,105 @@ namespace h5 {
     static std::string invoke() { return "List"; }
   };
 
+  // Format of a vector of compound types, stored by columns
+  inline constexpr const char *columnar_vector_format = "ColumnarList";
+
+  // ----------------------------------------------------------------------------
+  // details for the columnar storage of a vector of compound types, one dataset per field
+  namespace detail {
+
+    // View on the field f of all the elements of v, as a strided array (rank 1, or rank 2 for a std::array of arithmetic)
+    // The elements of v must be a whole number of field scalars apart, otherwise there is no such view.
+    template <typename T, typename F>
+    std::optional<array_interface::h5_array_view> columnar_view(std::vector<T> const &v, F const &f) {
+      using M = std::remove_cvref_t<decltype(std::declval<T>().*f.member)>;
+      void *start = (v.empty() ? nullptr : (void *)(&(v[0].*f.member)));
+
+      if constexpr (std::is_arithmetic_v<M> or is_complex_v<M>) {
+        if (sizeof(T) % sizeof(M) != 0) return {};
+        array_interface::h5_array_view res{hdf5_type<M>(), start, 1, is_complex_v<M>};
+        res.slab.count[0]  = v.size();
+        res.slab.stride[0] = sizeof(T) / sizeof(M);
+        res.L_tot[0]       = v.size() * res.slab.stride[0];
+        return res;
+      } else if constexpr (_is_std_array<M>::value) {
+        using U = typename _is_std_array<M>::value_type;
+        if constexpr (std::is_arithmetic_v<U>) {
+          if (sizeof(T) % sizeof(U) != 0) return {};
+          // a row per element, the field being the first columns of the row
+          array_interface::h5_array_view res{hdf5_type<U>(), start, 2, false};
+          res.slab.count = {v.size(), _is_std_array<M>::size};
+          res.L_tot      = {v.size(), sizeof(T) / sizeof(U)};
+          return res;
+        }
+      }
+      return {};
+    }
+
+    // View on the contiguous buffer col, as a (n0, n1) array
+    template <typename U>
+    array_interface::h5_array_view contiguous_view_2d(std::vector<U> const &col, hsize_t n0, hsize_t n1) {
+      array_interface::h5_array_view res{hdf5_type<U>(), (void *)col.data(), 2, is_complex_v<U>};
+      res.slab.count[0] = res.L_tot[0] = n0;
+      res.slab.count[1] = res.L_tot[1] = n1;
+      return res;
+    }
+
+    // Write the field f of all the elements of v as the dataset (or subgroup) gr[f.name]
+    template <typename T, typename F>
+    void write_column(group const &gr, std::vector<T> const &v, F const &f) {
+      using M = std::remove_cvref_t<decltype(std::declval<T>().*f.member)>;
+      if (auto view = columnar_view(v, f); view) {
+        array_interface::write(gr, f.name, *view, true);
+        return;
+      }
+      // Fallback : gather the field in a contiguous buffer
+      if constexpr (_is_std_array<M>::value and not is_compound_v<typename _is_std_array<M>::value_type>) {
+        constexpr auto K = _is_std_array<M>::size;
+        std::vector<typename _is_std_array<M>::value_type> col(v.size() * K);
+        for (size_t i = 0; i < v.size(); ++i) std::copy_n((v[i].*f.member).begin(), K, col.begin() + i * K);
+        array_interface::write(gr, f.name, detail::contiguous_view_2d(col, v.size(), K), true);
+      } else {
+        std::vector<M> col(v.size());
+        for (size_t i = 0; i < v.size(); ++i) col[i] = v[i].*f.member;
+        h5_write(gr, f.name, col);
+      }
+    }
+
+    // Read the dataset (or subgroup) gr[f.name] into the field f of all the elements of v
+    template <typename T, typename F>
+    void read_column(group const &gr, std::vector<T> &v, F const &f) {
+      using M = std::remove_cvref_t<decltype(std::declval<T>().*f.member)>;
+      if (auto view = columnar_view(v, f); view) {
+        array_interface::read(gr, f.name, *view, array_interface::get_h5_lengths_type(gr, f.name));
+        return;
+      }
+      if constexpr (_is_std_array<M>::value and not is_compound_v<typename _is_std_array<M>::value_type>) {
+        constexpr auto K = _is_std_array<M>::size;
+        std::vector<typename _is_std_array<M>::value_type> col(v.size() * K);
+        array_interface::read(gr, f.name, detail::contiguous_view_2d(col, v.size(), K), array_interface::get_h5_lengths_type(gr, f.name));
+        for (size_t i = 0; i < v.size(); ++i) std::copy_n(col.begin() + i * K, K, (v[i].*f.member).begin());
+      } else {
+        std::vector<M> col;
+        h5_read(gr, f.name, col);
+        if (col.size() != v.size()) throw std::runtime_error("h5 read of a columnar vector : column " + std::string{f.name} + " has a wrong length");
+        for (size_t i = 0; i < v.size(); ++i) v[i].*f.member = std::move(col[i]);
+      }
+    }
+
+    // Number of elements of the columnar vector stored in gr, from the length of its first column
+    template <typename T>
+    long columnar_size(group const &gr) {
+      auto const &f = std::get<0>(hdf5_compound_impl<T>::fields());
+      using M       = std::remove_cvref_t<decltype(std::declval<T>().*f.member)>;
+      if constexpr (is_compound_v<M>)
+        return columnar_size<M>(gr.open_group(f.name));
+      else
+        return array_interface::get_h5_lengths_type(gr, f.name).lengths.at(0);
+    }
+
+  } // namespace detail
+
   // ----------------------------------------------------------------------------
   // details for string case
   char_buf to_char_buf(std::vector<std::string> const &v);
@@ -57,6 +160,12 @@ namespace h5 {
   void from_char_buf(char_buf const &cb, std::vector<std::string> &v);
   void from_char_buf(char_buf const &cb, std::vector<std::vector<std::string>> &v);
 
+  namespace detail {
+    // Write/read a vector of strings, with the string layout of the policy of g (fixed or variable length)
+    void write_strings(group const &g, std::string const &name, std::vector<std::string> const &v);
+    void read_strings(group const &g, std::string const &name, std::vector<std::string> &v);
+  } // namespace detail
+
   // ----------------------------------------------------------------------------
 
   /**
@@ -64,7 +173,10 @@ namespace h5 {
    *
    * Format 
    *    * If T is a simple type (int, double, complex), it is a 1d array.
-   *    * If T is std::string, it is a 2d array of char of dimensions (length of vector, max length of strings)
+   *    * If T is std::string, it is a 2d array of char of dimensions (length of vector, max length of strings),
+   *      or a 1d array of variable-length strings, depending on the string_layout of the write_policy of g
+   *    * If T is a compound (cf. hdf5_compound_impl), it opens a subgroup and writes each field of all the elements
+   *      as a dataset of the subgroup (columnar storage)
    *    * Otherwise, it opens a subgroup and writes each element as 0,1,2,3 ... in the subgroup
    *
    * @tparam T
@@ -73,16 +185,26 @@ namespace h5 {
    * @param v Vector to save in the file
    */
   template <typename T>
-  void h5_write(group g, std::string const &name, std::vector<T> const &v) {
+  void h5_write(group const &g, std::string const &name, std::vector<T> const &v) {
 
     if constexpr (std::is_arithmetic_v<T> or is_complex_v<T>) {
 
       array_interface::write(g, name, array_interface::h5_array_view_from_vector(v), true);
 
-    } else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::vector<std::string>>) {
+    } else if constexpr (std::is_same_v<T, std::string>) {
+
+      detail::write_strings(g, name, v);
+
+    } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
 
       h5_write(g, name, to_char_buf(v));
 
+    } else if constexpr (is_compound_v<T>) { // columnar
+
+      auto gr = g.create_group(name);
+      write_hdf5_format_as_string(gr, columnar_vector_format);
+      std::apply([&](auto const &...f) { (detail::write_column(gr, v, f), ...); }, hdf5_compound_impl<T>::fields());
+
     } else { // generic type
 
       auto gr = g.create_group(name);
@@ -98,7 +220,9 @@ namespace h5 {
    *
    * Format 
    *    * If T is a simple type (int, double, complex), it is a 1d array.
-   *    * If T is std::string, it is a 2d array of char of dimensions (length of vector, max length of strings)
+   *    * If T is std::string, it is a 2d array of char of dimensions (length of vector, max length of strings),
+   *      or a 1d array of variable-length strings
+   *    * If T is a compound, a subgroup with one dataset per field, or with the elements 0,1,2,3 ... as in the generic case
    *    * Otherwise, it opens a subgroup and writes each element as 0,1,2,3 ... in the subgroup
    *
    * @tparam T
@@ -107,16 +231,21 @@ namespace h5 {
    * @param v Vector to read into
    */
   template <typename T>
-  void h5_read(group g, std::string name, std::vector<T> &v) {
+  void h5_read(group const &g, std::string const &name, std::vector<T> &v) {
 
     if constexpr (std::is_arithmetic_v<T> or is_complex_v<T>) {
 
       auto lt = array_interface::get_h5_lengths_type(g, name);
-      if (lt.rank() != 1 + is_complex_v<T>) throw make_runtime_error("h5 : reading a vector and I got an array of rank", lt.rank());
+      // NB : vector<complex> can also be read from a compound hdf5 datatype, or from real data, cf. array_interface::read
+      if (lt.rank() != 1 + (is_complex_v<T> and lt.has_complex_attribute)) throw make_runtime_error("h5 : reading a vector and I got an array of rank", lt.rank());
       v.resize(lt.lengths[0]);
       array_interface::read(g, name, array_interface::h5_array_view_from_vector(v), lt);
 
-    } else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::vector<std::string>>) {
+    } else if constexpr (std::is_same_v<T, std::string>) {
+
+      detail::read_strings(g, name, v);
+
+    } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
 
       char_buf cb;
       h5_read(g, name, cb);
@@ -125,16 +254,41 @@ namespace h5 {
     } else { // generic type
 
       auto g2 = g.open_group(name);
-      v.resize(g2.get_all_dataset_names().size() + g2.get_all_subgroup_names().size());
+
+      if constexpr (is_compound_v<T>) {
+        if (read_hdf5_format(g2) == columnar_vector_format) {
+          v.resize(detail::columnar_size<T>(g2));
+          std::apply([&](auto const &...f) { (detail::read_column(g2, v, f), ...); }, hdf5_compound_impl<T>::fields());
+          return;
+        }
+      }
+
+      // one element per key
+      v.resize(g2.size());
       for (int i = 0; i < v.size(); ++i) { h5_read(g2, std::to_string(i), v[i]); }
     }
   }
 
-  void h5_write_attribute(object obj, std::string const &name, std::vector<std::vector<std::string>> const &V);
-  void h5_read_attribute(object obj, std::string const &name, std::vector<std::vector<std::string>> &V);
+  /**
+   * Append the elements of a std::vector to the 1d dataset g[name]
+   * The dataset is created, with an unlimited length, if it does not exist.
+   *
+   * @tparam T A simple type (int, double, complex)
+   * @param g HDF5 group
+   * @param name Name of the dataset in the HDF5 file
+   * @param v Vector of the elements to append
+   */
+  template <typename T>
+  void h5_append(group const &g, std::string const &name, std::vector<T> const &v) H5_REQUIRES(std::is_arithmetic_v<T> or is_complex_v<T>) {
+    if (v.empty()) return;
+    array_interface::append(g, name, array_interface::h5_array_view_from_vector(v));
+  }
+
+  void h5_write_attribute(object const &obj, std::string const &name, std::vector<std::vector<std::string>> const &V);
+  void h5_read_attribute(object const &obj, std::string const &name, std::vector<std::vector<std::string>> &V);
 
-  void h5_write_attribute(object obj, std::string const &name, std::vector<std::string> const &V);
-  void h5_read_attribute(object obj, std::string const &name, std::vector<std::string> &V);
+  void h5_write_attribute(object const &obj, std::string const &name, std::vector<std::string> const &V);
+  void h5_read_attribute(object const &obj, std::string const &name, std::vector<std::string> &V);
 
 } // namespace h5
 
@@ -0,0 +1,219 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./storage_report.hpp"
+#include "./json.hpp"
+
+#include <hdf5.h>
+
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace h5 {
+
+  namespace {
+
+#if H5_VERSION_GE(1, 12, 0)
+    using object_key = std::pair<unsigned long, std::string>;
+#else
+    using object_key = std::pair<unsigned long, haddr_t>;
+#endif
+
+    // The header and metadata sizes of an object, and a key identifying it in the file
+    struct object_info {
+      H5O_type_t type;
+      object_key key;
+      hsize_t header_bytes, index_bytes, attribute_bytes;
+    };
+
+    object_info get_object_info(hid_t loc, std::string const &name) {
+#if H5_VERSION_GE(1, 12, 0)
+      H5O_info2_t info;
+      H5O_native_info_t ninfo;
+      if (H5Oget_info_by_name3(loc, name.c_str(), &info, H5O_INFO_BASIC, H5P_DEFAULT) < 0
+          or H5Oget_native_info_by_name(loc, name.c_str(), &ninfo, H5O_NATIVE_INFO_HDR | H5O_NATIVE_INFO_META_SIZE, H5P_DEFAULT) < 0)
+        throw std::runtime_error("h5::storage_report : cannot get the info of the object " + name);
+      object_key key{info.fileno, std::string(reinterpret_cast<char const *>(&info.token), sizeof(info.token))};
+      auto const &hdr = ninfo.hdr;
+      auto const &ms  = ninfo.meta_size;
+#else
+      H5O_info_t info;
+      if (H5Oget_info_by_name2(loc, name.c_str(), &info, H5O_INFO_BASIC | H5O_INFO_HDR | H5O_INFO_META_SIZE, H5P_DEFAULT) < 0)
+        throw std::runtime_error("h5::storage_report : cannot get the info of the object " + name);
+      object_key key{info.fileno, info.addr};
+      auto const &hdr = info.hdr;
+      auto const &ms  = info.meta_size;
+#endif
+      return {info.type, key, hdr.space.total, ms.obj.index_size + ms.obj.heap_size, ms.attr.index_size + ms.attr.heap_size};
+    }
+
+    // The name of the type : the registered name, or the HDF5 class
+    std::string type_name(datatype const &ty) {
+      int i = detail::find_registered_type(ty);
+      if (i >= 0) return detail::type_registry()[i].name;
+      switch (H5Tget_class(ty)) {
+        case H5T_INTEGER: return "integer";
+        case H5T_FLOAT: return "float";
+        case H5T_STRING: return "string";
+        case H5T_BITFIELD: return "bitfield";
+        case H5T_OPAQUE: return "opaque";
+        case H5T_COMPOUND: return "compound";
+        case H5T_REFERENCE: return "reference";
+        case H5T_ENUM: return "enum";
+        case H5T_VLEN: return "vlen";
+        case H5T_ARRAY: return "array";
+        default: return "unknown";
+      }
+    }
+
+    std::string layout_name(H5D_layout_t l) {
+      switch (l) {
+        case H5D_COMPACT: return "compact";
+        case H5D_CONTIGUOUS: return "contiguous";
+        case H5D_CHUNKED: return "chunked";
+        case H5D_VIRTUAL: return "virtual";
+        default: return "unknown";
+      }
+    }
+
+    dataset_storage get_dataset_storage(group const &g, std::string const &key, std::string path, object_info const &oi) {
+      dataset_storage res;
+      res.path         = std::move(path);
+      res.header_bytes = oi.header_bytes + oi.attribute_bytes;
+
+      dataset ds       = g.open_dataset(key);
+      datatype ty      = H5Dget_type(ds);
+      dataspace dspace = H5Dget_space(ds);
+      res.type         = type_name(ty);
+      res.shape.resize(std::max(H5Sget_simple_extent_ndims(dspace), 0));
+      H5Sget_simple_extent_dims(dspace, res.shape.data(), nullptr);
+      res.logical_bytes = hsize_t(H5Sget_simple_extent_npoints(dspace)) * H5Tget_size(ty);
+      res.storage_bytes = H5Dget_storage_size(ds);
+
+      proplist dcpl = H5Dget_create_plist(ds);
+      auto layout   = H5Pget_layout(dcpl);
+      res.layout    = layout_name(layout);
+      if (layout == H5D_CHUNKED) {
+        res.chunk.resize(res.shape.size());
+        H5Pget_chunk(dcpl, int(res.chunk.size()), res.chunk.data());
+      }
+      for (int i = 0; i < H5Pget_nfilters(dcpl); ++i) {
+        unsigned flags = 0;
+        size_t n_cd    = 0;
+        char name[64]  = {};
+        auto id        = H5Pget_filter2(dcpl, i, &flags, &n_cd, nullptr, sizeof(name), name, nullptr);
+        res.filters.emplace_back(name[0] != 0 ? std::string{name} : std::to_string(id));
+      }
+      return res;
+    }
+
+    std::string child_path(std::string const &path, std::string const &key) { return (path == "/" ? path : path + "/") + key; }
+
+    extern "C" {
+    herr_t collect_hard_links(::hid_t, const char *name, const H5L_info_t *info, void *opdata) {
+      if (info->type == H5L_TYPE_HARD) static_cast<std::vector<std::string> *>(opdata)->emplace_back(name);
+      return 0;
+    }
+    }
+
+    // The names of the hard links of g
+    std::vector<std::string> hard_links(group const &g) {
+      std::vector<std::string> names;
+      if (H5Literate(g, H5_INDEX_NAME, H5_ITER_INC, nullptr, collect_hard_links, &names) < 0)
+        throw std::runtime_error("h5::storage_report : iteration over the group " + g.name() + " failed");
+      return names;
+    }
+
+    void report_group(group const &g, std::string const &path, object_info const &oi, bool recursive, std::set<object_key> &visited,
+                      storage_usage &res) {
+      res.groups.push_back({path, g.size(), oi.header_bytes, oi.index_bytes, oi.attribute_bytes});
+      for (auto const &key : hard_links(g)) {
+        auto child = get_object_info(g, key);
+        if (not visited.insert(child.key).second) continue;
+        if (child.type == H5O_TYPE_DATASET) res.datasets.push_back(get_dataset_storage(g, key, child_path(path, key), child));
+        if (child.type == H5O_TYPE_GROUP and recursive) report_group(g.open_group(key), child_path(path, key), child, true, visited, res);
+      }
+    }
+
+    template <typename V, typename F>
+    void json_list(std::ostream &out, V const &v, F f, const char *sep = ", ") {
+      out << '[';
+      for (size_t i = 0; i < v.size(); ++i) {
+        if (i > 0) out << sep;
+        f(v[i]);
+      }
+      out << ']';
+    }
+
+  } // namespace
+
+  //-------------------------------------------------------------
+
+  storage_usage storage_report(group const &g, bool recursive) {
+    hdf5_lock lock;
+
+    storage_usage res;
+    object f = H5Iget_file_id(g);
+    if (not f.is_valid() or H5Fget_filesize(f, &res.file_bytes) < 0) throw std::runtime_error("h5::storage_report : cannot get the size of the file");
+
+    auto oi = get_object_info(g, ".");
+    std::set<object_key> visited{oi.key};
+    report_group(g, g.name(), oi, recursive, visited, res);
+    return res;
+  }
+
+  hsize_t storage_usage::storage_bytes() const {
+    hsize_t r = 0;
+    for (auto const &d : datasets) r += d.storage_bytes;
+    return r;
+  }
+
+  hsize_t storage_usage::metadata_bytes() const {
+    hsize_t r = 0;
+    for (auto const &gr : groups) r += gr.metadata_bytes();
+    for (auto const &d : datasets) r += d.header_bytes;
+    return r;
+  }
+
+  std::string storage_usage::to_json() const {
+    std::ostringstream out;
+    auto number = [&out](auto x) { out << x; };
+    out.precision(6);
+
+    out << "{\"file_bytes\": " << file_bytes << ", \"storage_bytes\": " << storage_bytes() << ", \"metadata_bytes\": " << metadata_bytes();
+    out << ",\n \"groups\": ";
+    json_list(out, groups, [&](group_storage const &gr) {
+      out << "\n  {\"path\": " << detail::json_quote(gr.path) << ", \"n_links\": " << gr.n_links << ", \"header_bytes\": " << gr.header_bytes
+          << ", \"index_bytes\": " << gr.index_bytes << ", \"attribute_bytes\": " << gr.attribute_bytes
+          << ", \"metadata_bytes\": " << gr.metadata_bytes() << '}';
+    }, ",");
+    out << ",\n \"datasets\": ";
+    json_list(out, datasets, [&](dataset_storage const &d) {
+      out << "\n  {\"path\": " << detail::json_quote(d.path) << ", \"type\": " << detail::json_quote(d.type) << ", \"shape\": ";
+      json_list(out, d.shape, number);
+      out << ", \"layout\": " << detail::json_quote(d.layout) << ", \"chunk\": ";
+      json_list(out, d.chunk, number);
+      out << ", \"filters\": ";
+      json_list(out, d.filters, [&](std::string const &f) { out << detail::json_quote(f); });
+      out << ", \"logical_bytes\": " << d.logical_bytes << ", \"storage_bytes\": " << d.storage_bytes << ", \"header_bytes\": " << d.header_bytes
+          << ", \"compression_ratio\": " << d.compression_ratio() << '}';
+    }, ",");
+    out << "}\n";
+    return out.str();
+  }
+
+} // namespace h5
@@ -0,0 +1,82 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_STORAGE_REPORT_HPP
+#define LIBH5_STORAGE_REPORT_HPP
+
+#include "./group.hpp"
+
+#include <string>
+#include <vector>
+
+namespace h5 {
+
+  /// The storage of a dataset in the file (cf. storage_report)
+  struct dataset_storage {
+    std::string path;                 // path of the dataset in the file
+    std::string type;                 // name of its type (cf. get_name_of_h5_type), or its HDF5 class if not a registered type
+    v_t shape;                        // lengths of the dataset, incl. the trailing 2 of the complex arrays
+    std::string layout;               // "compact", "contiguous", "chunked" or "virtual"
+    v_t chunk;                        // lengths of the chunks, if chunked
+    std::vector<std::string> filters; // names of the filters of the chunks, in their order, e.g. {"shuffle", "deflate"}
+    hsize_t logical_bytes = 0;        // number of elements * size of the type in the file (the pointers, for variable length types)
+    hsize_t storage_bytes = 0;        // size of the data allocated in the file (H5Dget_storage_size)
+    hsize_t header_bytes  = 0;        // object header and dense storage of the attributes
+
+    /// logical_bytes / storage_bytes, i.e. > 1 if compressed. 0 if no storage is allocated.
+    [[nodiscard]] double compression_ratio() const { return storage_bytes == 0 ? 0 : double(logical_bytes) / double(storage_bytes); }
+  };
+
+  /// The metadata of a group in the file (cf. storage_report)
+  struct group_storage {
+    std::string path;            // path of the group in the file
+    long n_links            = 0; // number of links in the group
+    hsize_t header_bytes    = 0; // object header, including its compact links and attributes
+    hsize_t index_bytes     = 0; // B-trees and heaps of the links, if not compact
+    hsize_t attribute_bytes = 0; // B-trees and heaps of the attributes, if not compact
+
+    /// All the metadata bytes of the group
+    [[nodiscard]] hsize_t metadata_bytes() const { return header_bytes + index_bytes + attribute_bytes; }
+  };
+
+  /// Where the bytes of a file are, by group and by dataset (cf. storage_report)
+  struct storage_usage {
+    hsize_t file_bytes = 0; // size of the whole file (H5Fget_filesize)
+    std::vector<group_storage> groups;
+    std::vector<dataset_storage> datasets;
+
+    /// Sum of the storage_bytes of the datasets
+    [[nodiscard]] hsize_t storage_bytes() const;
+
+    /// Sum of the metadata of the groups and of the headers of the datasets
+    [[nodiscard]] hsize_t metadata_bytes() const;
+
+    /// The report as a JSON object {"file_bytes", "storage_bytes", "metadata_bytes", "groups" : [...], "datasets" : [...]},
+    /// with the fields of group_storage and dataset_storage, incl. compression_ratio and metadata_bytes.
+    [[nodiscard]] std::string to_json() const;
+  };
+
+  /**
+   * Report the storage of the group g, of its datasets and, if recursive, of all its subgroups.
+   *
+   * Only the hard links are followed, and an object reached by several of them is reported once.
+   * Cf. the command line tool h5_storage_report, which prints it as JSON.
+   */
+  storage_usage storage_report(group const &g, bool recursive = true);
+
+} // namespace h5
+
+#endif // LIBH5_STORAGE_REPORT_HPP
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_WRITE_POLICY_HPP
+#define LIBH5_WRITE_POLICY_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace h5 {
+
+  /**
+   * How the datasets are written : chunk shape, filters and precision of the compressed datasets,
+   * layout of the strings and maps, in place overwrite and skip of the unchanged datasets.
+   *
+   * Set on a file, it is copied into the groups opened from it afterwards,
+   * and a group passes its policy to its subgroups.
+   * The chunk, filter and precision fields only apply to the compressed datasets : the datasets written
+   * without compression (e.g. scalars) are not affected by them. The other fields apply to every write.
+   */
+  struct write_policy {
+
+    /// The filter pipeline applied to the chunks
+    enum class filter_t {
+      none,            ///< Chunked, no filter
+      deflate,         ///< zlib, with deflate_level
+      shuffle_deflate, ///< byte shuffle, then zlib with deflate_level
+      registered       ///< A dynamically registered HDF5 filter, see filter_id
+    };
+
+    /// Some registered filter ids, cf. https://portal.hdfgroup.org/display/support/Registered+Filter+Plugins
+    static constexpr unsigned filter_blosc = 32001;
+    static constexpr unsigned filter_lz4   = 32004;
+    static constexpr unsigned filter_zstd  = 32015;
+    static constexpr unsigned filter_zfp   = 32013;
+    static constexpr unsigned filter_sz    = 32017;
+
+    /// The filter
+    filter_t filter = filter_t::deflate;
+
+    /// Compression level for deflate [0-9]
+    unsigned deflate_level = 1;
+
+    /// Id of the registered filter, and its client data. If it is not available, deflate is used instead.
+    unsigned filter_id = 0;
+    std::vector<unsigned> cd_values = {};
+
+    /// How the floating point arrays wider than float (double, long double, and their complex) are stored, when compressed
+    enum class precision_t {
+      native,  ///< The type of the array
+      float32, ///< Single precision : HDF5 converts the data on write, and back to the type of the array on read
+      zfp      ///< The type of the array, with the error-bounded ZFP filter (filter_zfp) of absolute accuracy zfp_accuracy, instead of filter.
+               ///< For double arrays of rank <= 4 (complex included), when the filter is available. float32 otherwise.
+    };
+
+    /// The precision of the floating point arrays
+    precision_t precision = precision_t::native;
+
+    /// Absolute error bound of the ZFP filter
+    double zfp_accuracy = 1e-7;
+
+    /// Target size in bytes of a chunk. The chunks span the trailing dimensions first.
+    std::size_t chunk_bytes = std::size_t{1} << 20;
+
+    /// Datasets smaller than this size in bytes are stored contiguous and unfiltered
+    std::size_t contiguous_threshold = 0;
+
+    /**
+     * Number of threads running deflate and shuffle on the chunks of an array, when it is written or read whole
+     * (cf. array_interface::write_chunks and read_chunks). 0 : all hardware threads. 1 : the filters are run by HDF5.
+     */
+    unsigned n_threads = 1;
+
+    /// How a std::vector<std::string> is stored
+    enum class string_layout_t {
+      fixed,    ///< 2d array of char, each string padded to the longest one
+      variable, ///< 1d array of variable-length strings
+      automatic ///< variable if padding would more than double the size, fixed otherwise
+    };
+
+    /// The layout of the std::vector<std::string>. The default, fixed, is the format read by older versions of h5.
+    string_layout_t string_layout = string_layout_t::fixed;
+
+    /// How a std::map of arithmetic or string keys and arithmetic, complex or string values is stored
+    enum class map_layout_t {
+      per_element, ///< a subgroup with one element per key (string keys), or one subgroup with "key" and "val" per element
+      columnar     ///< a subgroup with the two 1d datasets "keys" and "values", in the order of the map (format ColumnarDict)
+    };
+
+    /// The layout of these std::map. The default, per_element, is the format read by older versions of h5.
+    map_layout_t map_layout = map_layout_t::per_element;
+
+    /**
+     * Overwrite an existing dataset in place when it has the same type, shape and layout (chunks, filters and their parameters)
+     * as the new one, instead of unlinking it and creating a new one. Its attributes are rewritten.
+     * The file does not grow when the same arrays are written again, e.g. at every iteration.
+     */
+    bool in_place_overwrite = false;
+
+    /**
+     * Incremental checkpointing : array_interface::write stores a hash of the content of each dataset in its attribute
+     * "__xxh64__", and does not write it again if the dataset in the file has the same hash, type and shape.
+     * The skipped writes are recorded in the io_counters (writes_skipped).
+     */
+    bool skip_unchanged = false;
+  };
+
+} // namespace h5
+
+#endif // LIBH5_WRITE_POLICY_HPP
@@ -0,0 +1,91 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./write_session.hpp"
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace h5 {
+
+  namespace {
+    // The largest metadata cache of HDF5 (H5C__MAX_MAX_CACHE_SIZE, not in the public headers)
+    constexpr size_t max_cache_bytes = size_t{128} << 20;
+
+    // The metadata cache before the sessions (cf. detail::write_session_state::saved)
+    struct saved_config {
+      H5AC_cache_config_t config;
+      size_t max_size;
+    };
+  } // namespace
+
+  write_session::write_session(file f_, std::size_t cache_bytes) : f(std::move(f_)) {
+    hdf5_lock lock;
+    if (not f.is_valid()) throw std::runtime_error("h5::write_session : the file is not open");
+    unsigned intent = 0;
+    if (H5Fget_intent(f, &intent) < 0 or not(intent & H5F_ACC_RDWR)) throw std::runtime_error("h5::write_session : the file is read-only");
+
+    if (f.session->depth++ > 0) return;
+
+    auto saved            = std::make_shared<saved_config>();
+    saved->config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+    size_t min_clean = 0, cur_size = 0;
+    int n_entries    = 0;
+    if (H5Fget_mdc_config(f, &saved->config) < 0 or H5Fget_mdc_size(f, &saved->max_size, &min_clean, &cur_size, &n_entries) < 0) {
+      --f.session->depth;
+      throw std::runtime_error("h5::write_session : cannot get the metadata cache configuration of " + f.name());
+    }
+
+    // A fixed size cache. Its evictions stay enabled : if the metadata of the session outgrow it, the oldest ones are written
+    // to the file, instead of an unbounded growth of the cache.
+    H5AC_cache_config_t config = saved->config;
+    config.set_initial_size    = true;
+    config.initial_size        = std::min(std::max(cache_bytes, saved->max_size), max_cache_bytes);
+    config.max_size            = std::max(config.max_size, config.initial_size);
+    config.min_size            = std::min(config.min_size, config.initial_size);
+    config.incr_mode           = H5C_incr__off;
+    config.flash_incr_mode     = H5C_flash_incr__off;
+    config.decr_mode           = H5C_decr__off;
+    config.evictions_enabled   = true;
+    if (H5Fset_mdc_config(f, &config) < 0) {
+      --f.session->depth;
+      throw std::runtime_error("h5::write_session : cannot set the metadata cache configuration of " + f.name());
+    }
+    f.session->saved = std::move(saved);
+  }
+
+  //-------------------------------------------------------------
+
+  void write_session::commit() { f.flush(); }
+
+  //-------------------------------------------------------------
+
+  write_session::~write_session() {
+    hdf5_lock lock;
+    if (--f.session->depth > 0) return;
+
+    // The single flush of the session, then the cache as before (with the current size of the cache before the session)
+    H5Fflush(f, H5F_SCOPE_GLOBAL);
+    auto saved = std::static_pointer_cast<saved_config>(std::move(f.session->saved));
+    if (not saved) return;
+    saved->config.set_initial_size = true;
+    saved->config.initial_size     = std::clamp(saved->max_size, saved->config.min_size, saved->config.max_size);
+    H5Fset_mdc_config(f, &saved->config);
+  }
+
+} // namespace h5
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#ifndef LIBH5_WRITE_SESSION_HPP
+#define LIBH5_WRITE_SESSION_HPP
+
+#include "./file.hpp"
+
+#include <cstddef>
+
+namespace h5 {
+
+  /**
+   * RAII : a phase of many writes to a file, e.g. a checkpoint of a large tree of objects with the recursive h5_write.
+   *
+   * While the session is alive :
+   *   - the metadata cache of the file is given the fixed size cache_bytes, so that the metadata (object headers, B-trees, heaps)
+   *     stay in memory instead of being written in small pieces between the raw data,
+   *   - file::flush_if_not_in_session is deferred, e.g. the flush of HDFArchive after each key.
+   *
+   * The metadata are written at once by commit() (or file::flush) and at the end of the session, which restores the former cache configuration.
+   * The sessions of a file (and of its copies) nest : the first one changes the cache, and the last one to end flushes and restores it.
+   *
+   * The cache does not grow beyond cache_bytes : when the metadata written during the session outgrow it,
+   * HDF5 evicts the least recently used ones, i.e. writes them to the file before the end of the session.
+   * To write them in large blocks, open the file with file_options::meta_block_size (and small_data_block_size) :
+   * these are properties of the opening of the file, which the session can not change.
+   */
+  class write_session {
+    file f;
+
+    public:
+    /**
+     * Start a session on the file f, opened for writing
+     *
+     * @param f            The file
+     * @param cache_bytes  Size of the metadata cache during the session (at least its current size, clamped to 128 MB, the limit of HDF5)
+     */
+    explicit write_session(file f, std::size_t cache_bytes = std::size_t{128} << 20);
+
+    write_session(write_session const &)            = delete;
+    write_session &operator=(write_session const &) = delete;
+
+    /// Commit and end the session. Errors are ignored : call commit() before to check them.
+    ~write_session();
+
+    /// Write all the metadata and data to the file now, e.g. at a consistent point of a long session (cf. file::flush)
+    void commit();
+  };
+
+} // namespace h5
+
+#endif // LIBH5_WRITE_SESSION_HPP
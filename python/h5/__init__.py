@@ -19,4 +19,5 @@ DOC
 """
 
 from .archive import HDFArchive, HDFArchiveGroup, HDFArchiveInert
-__all__ = ['HDFArchive', 'HDFArchiveGroup', 'HDFArchiveInert']
+from .lazy_array import LazyArray
+__all__ = ['HDFArchive', 'HDFArchiveGroup', 'HDFArchiveInert', 'LazyArray']
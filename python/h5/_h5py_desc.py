@@ -1,5 +1,5 @@
 # Generated automatically using the command :
-# c++2py h5py_io.hpp --members_read_only -N h5 -a _h5py -m _h5py -o _h5py --moduledoc="A lightweight hdf5 python interface" --cxxflags="-std=c++20" --includes=./../../c++ --only="object file group h5_read_bare h5_write_bare"
+# c++2py h5py_io.hpp --members_read_only -N h5 -a _h5py -m _h5py -o _h5py --moduledoc="A lightweight hdf5 python interface" --cxxflags="-std=c++20" --includes=./../../c++ --only="object file group h5_read_bare h5_write_bare h5_read_many h5_array_info h5_read_slice h5_write_tree"
 from cpp2py.wrap_generator import *
 
 # The module
@@ -13,13 +13,55 @@ module.add_include("<h5py_io.hpp>")
 # Add here anything to add in the C++ code at the start, e.g. namespace using
 module.add_preamble("""
 #include <cpp2py/converters/span.hpp>
+#include <cpp2py/converters/map.hpp>
+#include <cpp2py/converters/optional.hpp>
 #include <cpp2py/converters/string.hpp>
+#include <cpp2py/converters/tuple.hpp>
 #include <cpp2py/converters/vector.hpp>
 
 using namespace h5;
 """)
 
 
+# Converter for the struct file_options (from a dict)
+c = converter_(
+        c_type = "h5::file_options",
+        doc = r"""Access and creation properties of a file on disk""",
+)
+c.add_member(c_name = "latest_format", c_type = "bool", initializer = """ false """,
+             doc = r"""Use the latest file format""")
+c.add_member(c_name = "alignment", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Align the objects larger than alignment_threshold bytes on a multiple of alignment bytes""")
+c.add_member(c_name = "alignment_threshold", c_type = "size_t", initializer = """ 1 """,
+             doc = r"""""")
+c.add_member(c_name = "meta_block_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Size in bytes of the blocks in which the metadata are aggregated""")
+c.add_member(c_name = "small_data_block_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Size in bytes of the blocks in which the small raw data are aggregated""")
+c.add_member(c_name = "metadata_cache_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Initial and maximal size in bytes of the metadata cache""")
+c.add_member(c_name = "chunk_cache_bytes", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Default size in bytes of the chunk cache of the datasets""")
+c.add_member(c_name = "chunk_cache_slots", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Default number of slots of the chunk cache (a prime)""")
+c.add_member(c_name = "chunk_cache_w0", c_type = "double", initializer = """ -1 """,
+             doc = r"""Default preemption policy of the chunk cache, in [0, 1] (negative : the HDF5 default)""")
+c.add_member(c_name = "sieve_buf_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Size in bytes of the sieve buffer""")
+c.add_member(c_name = "paged_aggregation", c_type = "bool", initializer = """ false """,
+             doc = r"""Creation : allocate the file space by pages""")
+c.add_member(c_name = "file_space_page_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Creation : size in bytes of the pages""")
+c.add_member(c_name = "persist_free_space", c_type = "bool", initializer = """ false """,
+             doc = r"""Creation : track the free space in the file, so that the space of the unlinked objects is reused after the file is reopened""")
+c.add_member(c_name = "free_space_threshold", c_type = "size_t", initializer = """ 1 """,
+             doc = r"""Creation : the smallest free section tracked, in bytes""")
+c.add_member(c_name = "page_buffer_size", c_type = "size_t", initializer = """ 0 """,
+             doc = r"""Size in bytes of the page buffer. Only for files created with paged_aggregation.""")
+c.add_member(c_name = "swmr", c_type = "bool", initializer = """ false """,
+             doc = r"""Single writer / multiple readers : open with H5F_ACC_SWMR_READ in mode 'r', H5F_ACC_SWMR_WRITE otherwise""")
+module.add_converter(c)
+
 # The class file
 c = class_(
         py_type = "File",  # name of the python class
@@ -34,6 +76,8 @@ c.add_constructor("""()""", doc = r"""Open a file in memory""")
 
 c.add_constructor("""(std::string name, char mode)""", doc = r"""""")
 
+c.add_constructor("""(std::string name, char mode, h5::file_options opts)""", doc = r"""Open the file on disk, with some access and creation properties""")
+
 c.add_constructor("""(std::span<std::byte> buf)""", doc = r"""Create a file in memory from a byte buffer""")
 
 c.add_property(name = "name", getter = cfunction("""std::string name ()"""),
@@ -42,9 +86,27 @@ c.add_property(name = "name", getter = cfunction("""std::string name ()"""),
 c.add_method("""void flush ()""",
              doc = r"""Flush the file""")
 
+c.add_method("""void flush_if_not_in_session ()""",
+             doc = r"""Flush the file, except during a write session of the file, where the flush is left to the end of the session""")
+
 c.add_method("""std::vector<std::byte> as_buffer ()""",
              doc = r"""Get a copy of the associated byte buffer""")
 
+c.add_property(name = "is_swmr", getter = cfunction("""bool is_swmr ()"""),
+             doc = r"""True iff the file is opened in SWMR mode, as the writer or as a reader""")
+
+c.add_method("""void start_swmr_write ()""",
+             doc = r"""Switch a file opened for writing, with the latest format, to the SWMR mode""")
+
+c.add_method("""void compact (std::string dest)""",
+             doc = r"""Copy the live objects of the file into the new, tightly packed file dest""")
+
+c.add_method("""void compact (std::string dest, h5::file_options opts)""",
+             doc = r"""Copy the live objects of the file into the new, tightly packed file dest, created with the options opts""")
+
+c.add_method("""void refresh ()""",
+             doc = r"""For a SWMR reader : refresh the metadata of the open groups and datasets of the file""")
+
 module.add_class(c)
 
 # The class group
@@ -97,6 +159,33 @@ delete_if_exists
 c.add_method("""std::vector<std::string> get_all_subgroup_dataset_names ()""", name='keys',
              doc = r"""Returns all names of dataset of G""")
 
+c.add_method("""std::map<std::string, std::string> key_types ()""",
+             calling_pattern = """std::map<std::string, std::string> result;
+               for (auto const &el : self_c.get_all_elements()) {
+                 if (el.is_group()) result[el.name] = "group";
+                 else if (el.is_dataset()) result[el.name] = "data";
+               }""",
+             doc = r"""The names of the subgroups and datasets of G, with their kind ('group' or 'data'), in a single iteration""")
+
+c.add_method("""std::map<std::string, std::tuple<std::string, std::optional<std::string>>> key_types_and_formats ()""",
+             calling_pattern = """std::map<std::string, std::tuple<std::string, std::optional<std::string>>> result;
+               for (auto const &el : self_c.get_all_elements(false, true)) {
+                 auto fmt = (el.format_unread ? std::optional<std::string>{} : el.format);
+                 if (el.is_group()) result[el.name] = {"group", fmt};
+                 else if (el.is_dataset()) result[el.name] = {"data", fmt};
+               }""",
+             doc = r"""The names of the subgroups and datasets of G, with their kind and their Format tag ("" if none, None if it could not be read with the listing), in a single iteration""")
+
+c.add_method("""void unlink (std::string key, bool error_if_absent = false)""",
+             doc = r"""Unlinks the subgroup or dataset key (the space in the file is not freed)
+
+Parameters
+----------
+key
+
+error_if_absent
+     If True, an error is raised if the key is absent""")
+
 c.add_property(name = "file", getter = cfunction("""file get_file ()"""),
              doc = r"""The parent file""")
 
@@ -118,6 +207,8 @@ c.add_method("void write_attribute(std::string key, std::string val)", calling_p
 
 c.add_method("std::string read_attribute(std::string name)", calling_pattern = "std::string result = h5_read_attribute<std::string>(self_c, name)", doc = "Read an attribute")
 
+c.add_method("void write_hdf5_format(std::string fmt)", calling_pattern = "write_hdf5_format_as_string(self_c, fmt)", doc = "Write the format string of the group, in its object header")
+
 c.add_method("std::string read_hdf5_format_from_key(std::string key)", calling_pattern = "std::string result; read_hdf5_format_from_key(self_c, key, result);", doc = "Read the format string from the key in the group")
 
 module.add_class(c)
@@ -126,6 +217,22 @@ module.add_function (name = "h5_write", signature = "void h5_write_bare (group g
 
 module.add_function (name = "h5_read", signature = "PyObject * h5_read_bare (group g, std::string name)", doc = r"""""")
 
+module.add_function (name = "h5_read", signature = "PyObject * h5_read_bare (group g, std::string name, PyObject * out)",
+                     doc = r"""Read the array dataset name into the numpy array out (of the same shape), without allocation, and return out""")
+
+module.add_function (name = "h5_read_many", signature = "PyObject * h5_read_many (group g, std::vector<std::string> keys)",
+                     doc = r"""Read the datasets keys of g, in a list. All the reads are made in a single section without the GIL.""")
+
+module.add_function (name = "h5_write_tree", signature = "bool h5_write_tree (group g, std::string name, PyObject * tree)",
+                     doc = r"""Write the dict tree of numpy arrays, scalars, strings and such dicts in the group name, with the Format attributes, in one call.
+Returns False, without writing anything, if the tree has other values.""")
+
+module.add_function (name = "h5_array_info", signature = "PyObject * h5_array_info (group g, std::string name)",
+                     doc = r"""(shape, dtype) of the numeric array dataset name, without reading it. None for a scalar or a string dataset.""")
+
+module.add_function (name = "h5_read_slice", signature = "PyObject * h5_read_slice (group g, std::string name, std::vector<long> offsets, std::vector<long> counts, std::vector<long> strides)",
+                     doc = r"""Read the hyperslab (offsets, counts, strides) of the array dataset name, in a new numpy array of shape counts""")
+
 
 
 module.generate_code()
@@ -14,8 +14,10 @@
 
 
 import sys,numpy
+from collections.abc import ValuesView, ItemsView
 from importlib import import_module
 from .archive_basic_layer import HDFArchiveGroupBasicLayer
+from .lazy_array import LazyArray
 from .formats import register_class, register_backward_compatibility_method, get_format_info
 
 # -------------------------------------------
@@ -50,9 +52,48 @@ class Dict:
     def __factory_from_dict__(cls, name, D) :
         return {n:x for n,x in list(D.items())}
 
+class ColumnarList:
+    """A list of records stored by columns (one array per field), as written from C++ for a std::vector of compound"""
+    @classmethod
+    def __factory_from_dict__(cls, name, D) :
+        n = len(next(iter(D.values()))) if D else 0
+        return [{k: v[i] for k, v in D.items()} for i in range(n)]
+
+class ColumnarDict:
+    """A dict stored by columns, as the datasets keys and values, as written from C++ for a std::map of scalars or strings"""
+    @classmethod
+    def __factory_from_dict__(cls, name, D) :
+        keys, values = D['keys'], D['values']
+        keys = keys.tolist() if hasattr(keys, 'tolist') else keys
+        values = values.tolist() if hasattr(values, 'tolist') else values
+        return dict(zip(keys, values))
+
+class SparseCSR:
+    """A scipy.sparse matrix, stored in compressed sparse row format as the datasets shape, indptr, indices and data.
+    It is read back as a scipy.sparse.csr_matrix, the rows of which can also be read from C++ (cf. h5::read_csr_rows)"""
+    _hdf5_format_ = 'SparseCSR'
+    def __init__(self,ob) :
+        self.ob = ob.tocsr()
+    def __reduce_to_dict__(self) :
+        m = self.ob
+        return {'shape': numpy.array(m.shape, dtype=numpy.int64), 'indptr': m.indptr, 'indices': m.indices, 'data': m.data}
+    @classmethod
+    def __factory_from_dict__(cls, name, D) :
+        from scipy.sparse import csr_matrix
+        return csr_matrix((D['data'], D['indices'], D['indptr']), shape=tuple(int(n) for n in D['shape']))
+
+def _is_sparse(val) :
+    """True iff val is a scipy.sparse matrix (scipy is not imported if it was not already)"""
+    sp = sys.modules.get('scipy.sparse')
+    return sp is not None and sp.issparse(val)
+
 register_class(List)
 register_backward_compatibility_method('PythonListWrap', 'List')
 
+register_class(ColumnarList)
+register_class(ColumnarDict)
+register_class(SparseCSR)
+
 register_class(Tuple)
 register_backward_compatibility_method('PythonTupleWrap', 'Tuple')
 
@@ -88,40 +129,33 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
 
     #-------------------------------------------------------------------------
     def __contains__(self,key) :
-        return key in list(self.keys())
+        return key in self._index()
 
     #-------------------------------------------------------------------------
     def values(self) :
         """
-        Generator returning the values in the group
+        A view of the values in the group, like a dictionary.
+        A value is only read when the iteration reaches it.
         """
-        def res() :
-            for name in list(self.keys()) :
-                yield self[name]
-        return res()
+        return ValuesView(self)
 
    #-------------------------------------------------------------------------
     def items(self) :
         """
-        Generator returning couples (key, values) in the group.
+        A view of the couples (key, values) in the group, like a dictionary.
+        A value is only read when the iteration reaches it.
         """
-        def res() :
-            for name in list(self.keys()):
-                yield name, self[name]
-        return res()
+        return ItemsView(self)
 
     #-------------------------------------------------------------------------
     def __iter__(self) :
         """Returns the keys, like a dictionary"""
-        def res() :
-            for name in list(self.keys()) :
-                yield name
-        return res()
+        return iter(self.keys())
 
     #-------------------------------------------------------------------------
     def __len__(self) :
         """Returns the length of the keys list """
-        return  len(list(self.keys()))
+        return len(self._index())
 
     #-------------------------------------------------------------------------
     def update(self,object_with_dict_protocol):
@@ -135,12 +169,19 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
     def __setitem__(self,key,val) :
         assert '/' not in key, "/ can not be part of a key"
 
-        if key in list(self.keys()) :
+        if key in self :
             if self.options['do_not_overwrite_entries'] : raise KeyError("key %s already exist."%key)
             self._clean_key(key) # clean things
 
+        # A dict of arrays, scalars, strings and such dicts is written in a single native call
+        if type(val) is dict and self._write_tree(key, val):
+            self._add_key(key, 'group')
+            self._flush_key()
+            return
+
         # Transform list, dict, etc... into a wrapped type that will allow HDF reduction
         if type(val) in self._wrappedType: val = self._wrappedType[type(val)](val)
+        elif _is_sparse(val): val = SparseCSR(val) # any sparse format is stored as CSR
 
         # write the attributes
         def write_attributes(g) :
@@ -155,11 +196,11 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
                Didn't you forget to register your class in h5.formats?
                """ %(val.__class__.__name__,ds)
              raise IOError(err)
-           g.write_attr("Format", ds)
+           g._write_format(ds)
 
         if hasattr(val,'__write_hdf5__') : # simplest protocol
             val.__write_hdf5__(self._group,key)
-            self.cached_keys.append(key) # I need to do this here
+            self._invalidate_index() # the kind of the new key is not known here
             # Should be done in the __write_hdf5__ function
             #SubGroup = HDFArchiveGroup(self,key)
             #write_attributes(SubGroup)
@@ -185,7 +226,7 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
                self._write( key, val)
             except:
                raise #ValueError, "Value %s\n is not of a type suitable to storage in HDF file"%val
-        self._flush()
+        self._flush_key()
 
     #-------------------------------------------------------------------------
     def get_raw (self,key):
@@ -193,6 +234,29 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
         it presents it as a subgroup"""
         return self.__getitem1__(key,False)
 
+    #-------------------------------------------------------------------------
+    def _read_lazy(self, key):
+        """A LazyArray for a numeric array dataset, the value for a scalar or string dataset"""
+        info = self._array_info(key)
+        if info is None: return self._read(key)
+        return LazyArray(self, key, *info)
+
+    #-------------------------------------------------------------------------
+    def get_lazy(self, key):
+        """
+        A LazyArray for the array dataset key : its shape and dtype, and only the slices of it which are indexed are read.
+        """
+        if '/' in key:
+            a,l =self, key.split('/')
+            for s in l[:-1]: a = a.get_raw(s)
+            return a.get_lazy(l[-1])
+        if not self.is_data(key) :
+            raise KeyError("Key %s is not a dataset of the archive."%key)
+        info = self._array_info(key)
+        if info is None :
+            raise TypeError("Key %s is not a numeric array."%key)
+        return LazyArray(self, key, *info)
+
     #-------------------------------------------------------------------------
     def __getitem__(self,key) :
         """Return the object key, possibly reconstructed as a python object if
@@ -214,7 +278,7 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
             SubGroup = HDFArchiveGroup(self,key) # View of the subgroup
             bare_return = lambda: SubGroup
         elif self.is_data(key) :
-            bare_return = lambda: self._read(key)
+            bare_return = lambda: self._read_lazy(key) if self.options['lazy_arrays'] else self._read(key)
         else :
             raise KeyError("Key %s is of unknown type !!"%Key)
 
@@ -222,7 +286,7 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
 
         # try to find the format
         if hdf5_format is None:
-            hdf5_format = self._group.read_hdf5_format_from_key(key)
+            hdf5_format = self._format_of(key)
             if hdf5_format == "":
                 return bare_return()
 
@@ -261,7 +325,7 @@ class HDFArchiveGroup(HDFArchiveGroupBasicLayer):
                 raise ValueError("oopps %s"%name)
 
         s= "HDFArchive%s with the following content:\n"%(" (partial view)" if self.is_top_level else '')
-        s+='\n'.join([ '  '+ pr(n) for n in list(self.keys()) ])
+        s+='\n'.join([ '  '+ pr(n) for n in self ])
         return s
 
     #-------------------------------------------------------------------------
@@ -302,7 +366,7 @@ class HDFArchive(HDFArchiveGroup):
     _class_version = 1
 
     def __init__(self, descriptor = None, open_flag = 'a', key_as_string_only = True,
-            reconstruct_python_object = True, init = {}):
+            reconstruct_python_object = True, init = {}, file_options = None, lazy_arrays = False):
         r"""
            Parameters
            -----------
@@ -326,6 +390,12 @@ class HDFArchive(HDFArchiveGroup):
            key_as_string_only : True (default)
            init : any generator of tuple (key,val), e.g. a dict.items().
              It will fill the archive with these values.
+           file_options : dict, optional
+             Access and creation properties of a file on disk, cf. h5::file_options,
+             e.g. ``{'alignment' : 1 << 20, 'metadata_cache_size' : 64 << 20}``.
+           lazy_arrays : False (default)
+             If True, the numeric array datasets are returned as LazyArray, which are only read when sliced.
+             Cf. also get_lazy(key).
 
            Attributes
            ----------
@@ -380,17 +450,35 @@ class HDFArchive(HDFArchiveGroup):
                 try: os.remove(os.path.abspath(LocalFileName))
                 except OSError: pass
 
-            self._init_root(LocalFileName, open_flag)
+            self._init_root(LocalFileName, open_flag, file_options)
 
         self.options = {'key_as_string_only' : key_as_string_only,
                         'do_not_overwrite_entries' : False,
                         'reconstruct_python_object': reconstruct_python_object,
-                        'UseAlpsNotationForComplex'  : True
+                        'UseAlpsNotationForComplex'  : True,
+                        'lazy_arrays' : lazy_arrays
                         }
         HDFArchiveGroup.__init__(self,self,"")
         self.is_top_level = True
         for k,v in init : self[k]=v
 
+    def compact(self, dest, file_options = None):
+      """
+      Copy the live content of the archive into the new file dest, tightly packed : the space
+      of the entries deleted or overwritten is not copied (cf. h5repack).
+
+      Parameters
+      ----------
+      dest : string
+        The name of the new file, overwritten if it exists
+      file_options : dict, optional
+        Access and creation properties of the new file, cf. h5::file_options
+      """
+      self._flush()
+      f = self._group.file
+      if file_options is None: f.compact(dest)
+      else: f.compact(dest, file_options)
+
     def as_bytes(self):
       """
       Return a copy of the hdf5 file as bytes
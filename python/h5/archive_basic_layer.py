@@ -25,9 +25,36 @@ class HDFArchiveGroupBasicLayer:
         self.options = parent.options
         self._group = parent._group.open_group(subpath) if subpath else parent._group
         self.ignored_keys = [] 
-        self.cached_keys = list(self._group.keys())
-
-    def _init_root(self, descriptor, open_flag) :
+        self._key_index = None # key -> 'group' or 'data', filled on first use by _index()
+        self._format_index = None # key -> Format tag, filled with the key index on first use by _format_of()
+
+    def _index(self) :
+        """The key index of the group, filled with a single listing of the group"""
+        if self._key_index is None :
+            self._key_index = dict(self._group.key_types())
+        return self._key_index
+
+    def _format_of(self, key) :
+        """The Format tag of key ("" if none). The tags of all the keys are read with the key index, in a single listing of the group"""
+        if self._format_index is None :
+            listing = self._group.key_types_and_formats()
+            self._key_index = {k: kind for k, (kind, fmt) in listing.items()}
+            self._format_index = {k: fmt for k, (kind, fmt) in listing.items()}
+        fmt = self._format_index.get(key)
+        # a key written since the listing (its Format is written after the key itself),
+        # or a key whose Format could not be read with the listing (None) : read it alone
+        return self._group.read_hdf5_format_from_key(key) if fmt is None else fmt
+
+    def _invalidate_index(self) :
+        """The next access to the keys will list the group again"""
+        self._key_index = None
+        self._format_index = None
+
+    def _add_key(self, key, kind) :
+        if self._key_index is not None : self._key_index[key] = kind
+        if self._format_index is not None : self._format_index.pop(key, None)
+
+    def _init_root(self, descriptor, open_flag, file_options = None) :
         if descriptor is None:
             try :
                 fich = h5.File()
@@ -43,7 +70,7 @@ class HDFArchiveGroupBasicLayer:
         else:
             assert(isinstance(descriptor, str))
             try :
-                fich = h5.File(descriptor, open_flag)
+                fich = h5.File(descriptor, open_flag) if file_options is None else h5.File(descriptor, open_flag, file_options)
             except :
                 print("Cannot open the HDF file %s"%descriptor)
                 raise
@@ -63,42 +90,63 @@ class HDFArchiveGroupBasicLayer:
     def is_group(self,p) :
         """Is p a subgroup ?"""
         assert len(p)>0 and p[0]!='/'
-        return p in self.cached_keys and self._group.has_subgroup(p)
+        return self._index().get(p) == 'group'
 
     def is_data(self,p) :
         """Is p a leaf ?"""
         assert len(p)>0 and p[0]!='/'
-        return p in self.cached_keys and self._group.has_dataset(p)
+        return self._index().get(p) == 'data'
 
     def write_attr (self, key, val) :
         self._group.write_attribute(key, val)
 
+    def _write_format (self, fmt) :
+        """Write the Format tag of the group, as a string of fixed size in the object header of the group"""
+        self._group.write_hdf5_format(fmt)
+
     def _read (self, key):
         return h5.h5_read(self._group, key)
 
+    def _read_many (self, keys):
+        return h5.h5_read_many(self._group, list(keys))
+
+    def _write_tree(self, key, tree) :
+        """Write the dict tree natively, False if it has values which are not arrays, scalars, strings or dicts"""
+        return h5.h5_write_tree(self._group, key, tree)
+
+    def _array_info (self, key):
+        return h5.h5_array_info(self._group, key)
+
+    def _read_slice (self, key, offsets, counts, strides):
+        return h5.h5_read_slice(self._group, key, offsets, counts, strides)
+
     def _write(self, key, val) :
         h5.h5_write(self._group, key, val)
+        self._add_key(key, 'data')
 
     def _flush(self):
         if bool(self._group): self._group.file.flush()
 
+    def _flush_key(self):
+        """The flush after writing a key, left to the end of a write session of the file"""
+        if bool(self._group): self._group.file.flush_if_not_in_session()
+
     def create_group (self,key):
         self._group.create_group(key)
-        self.cached_keys.append(key)
+        self._add_key(key, 'group')
 
     def create_softlink (self,target_key,key,delete_if_exists=True):
         self._group.create_softlink(target_key,key,delete_if_exists)
-        self.cached_keys.append(key)
+        self._invalidate_index() # the kind of key is the one of its target
 
     def keys(self) :
-        return self.cached_keys
+        return list(self._index())
 
     def _clean_key(self,key, report_error=False) :
-        if report_error and key not in self.cached_keys :
+        index = self._index()
+        if key not in index :
              raise KeyError("Key %s is not in archive !!"%key)
-        if key in self.cached_keys :
-          # FIXME
-          # del self._group[key]
-          self.cached_keys.remove(key)
-        else: raise KeyError("Key %s is not in archive !!"%key)
+        self._group.unlink(key)
+        del index[key]
+        if self._format_index is not None : self._format_index.pop(key, None)
 
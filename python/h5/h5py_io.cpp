@@ -6,6 +6,7 @@
 #include <h5/scalar.hpp>
 #include <h5/stl/string.hpp>
 #include <h5/array_interface.hpp>
+#include <h5/format.hpp>
 
 #include <cpp2py/cpp2py.hpp>
 #include <cpp2py/converters/vector.hpp>
@@ -15,96 +16,48 @@
 #include <hdf5_hl.h>
 
 #include <algorithm>
+#include <array>
+#include <optional>
+#include <variant>
 
 namespace h5 {
 
-  struct h5_c_size_t {
-    datatype hdf5_type; // type in hdf5
-    int c_size;         // size of the corresponding C object
+  // The numpy types of the types of the registry, in the order of detail::registered_types (-1 : no numpy type)
+  static constexpr std::array<int, std::tuple_size_v<detail::registered_types>> registered_npy_types = {
+     NPY_BYTE,        // signed char
+     NPY_STRING,      // char
+     NPY_UBYTE,       // unsigned char
+     NPY_BOOL,        // bool
+     NPY_SHORT,       // short
+     NPY_USHORT,      // unsigned short
+     NPY_INT,         // int
+     NPY_UINT,        // unsigned int
+     NPY_LONG,        // long
+     NPY_ULONG,       // unsigned long
+     NPY_LONGLONG,    // long long
+     NPY_ULONGLONG,   // unsigned long long
+     NPY_FLOAT,       // float
+     NPY_DOUBLE,      // double
+     NPY_LONGDOUBLE,  // long double
+     NPY_CFLOAT,      // std::complex<float>
+     NPY_CDOUBLE,     // std::complex<double>
+     NPY_CLONGDOUBLE, // std::complex<long double>
+     -1,              // std::string
+     -1               // dcplx_t
   };
 
-  std::vector<h5_c_size_t> h5_c_size_table;
-
-  static void init_h5_c_size_table() {
-    h5_c_size_table = std::vector<h5_c_size_t>{
-       {hdf5_type<char>(), sizeof(char)},
-       {hdf5_type<signed char>(), sizeof(signed char)},
-       {hdf5_type<unsigned char>(), sizeof(unsigned char)},
-       {hdf5_type<bool>(), sizeof(bool)},
-       {hdf5_type<short>(), sizeof(short)},
-       {hdf5_type<unsigned short>(), sizeof(unsigned short)},
-       {hdf5_type<int>(), sizeof(int)},
-       {hdf5_type<unsigned int>(), sizeof(unsigned int)},
-       {hdf5_type<long>(), sizeof(long)},
-       {hdf5_type<unsigned long>(), sizeof(unsigned long)},
-       {hdf5_type<long long>(), sizeof(long long)},
-       {hdf5_type<unsigned long long>(), sizeof(unsigned long long)},
-       {hdf5_type<float>(), sizeof(float)},
-       {hdf5_type<double>(), sizeof(double)},
-       {hdf5_type<long double>(), sizeof(long double)},
-       {hdf5_type<std::complex<float>>(), sizeof(std::complex<float>)},
-       {hdf5_type<std::complex<double>>(), sizeof(std::complex<double>)},
-       {hdf5_type<std::complex<long double>>(), sizeof(std::complex<long double>)} //
-    };
-  }
-
-  // h5 -> numpy type conversion
-  //FIXME we could sort the table and use binary_search
-  int h5_c_size(datatype t) {
-    if (h5_c_size_table.empty()) init_h5_c_size_table();
-    auto _end = h5_c_size_table.end();
-    auto pos  = std::find_if(h5_c_size_table.begin(), _end, [t](auto const &x) { return hdf5_type_equal(x.hdf5_type, t); });
-    if (pos == _end) std::runtime_error("HDF5/Python Internal Error : can not find the numpy type from the HDF5 type");
-    return pos->c_size;
-  }
-
-  //---------------------------------------
-
-  struct h5_py_type_t {
-    datatype hdf5_type; // type in hdf5
-    int numpy_type;     // For a Python object, we will always use the numpy type
-    size_t size;
-  };
-
-  //--------------------------------------
-
-  std::vector<h5_py_type_t> h5_py_type_table;
-
-  //--------------------------------------
-
-  static void init_h5py() {
-    h5_py_type_table = std::vector<h5_py_type_t>{
-       {hdf5_type<char>(), NPY_STRING, sizeof(char)},
-       {hdf5_type<signed char>(), NPY_BYTE, sizeof(signed char)},
-       {hdf5_type<unsigned char>(), NPY_UBYTE, sizeof(unsigned char)},
-       {hdf5_type<bool>(), NPY_BOOL, sizeof(bool)},
-       {hdf5_type<short>(), NPY_SHORT, sizeof(short)},
-       {hdf5_type<unsigned short>(), NPY_USHORT, sizeof(unsigned short)},
-       {hdf5_type<int>(), NPY_INT, sizeof(int)},
-       {hdf5_type<unsigned int>(), NPY_UINT, sizeof(unsigned int)},
-       {hdf5_type<long>(), NPY_LONG, sizeof(long)},
-       {hdf5_type<unsigned long>(), NPY_ULONG, sizeof(unsigned long)},
-       {hdf5_type<long long>(), NPY_LONGLONG, sizeof(long long)},
-       {hdf5_type<unsigned long long>(), NPY_ULONGLONG, sizeof(unsigned long long)},
-       {hdf5_type<float>(), NPY_FLOAT, sizeof(float)},
-       {hdf5_type<double>(), NPY_DOUBLE, sizeof(double)},
-       {hdf5_type<long double>(), NPY_LONGDOUBLE, sizeof(long double)},
-       {hdf5_type<std::complex<float>>(), NPY_CFLOAT, sizeof(std::complex<float>)},
-       {hdf5_type<std::complex<double>>(), NPY_CDOUBLE, sizeof(std::complex<double>)},
-       {hdf5_type<std::complex<long double>>(), NPY_CLONGDOUBLE, sizeof(std::complex<long double>)} //
-    };
-  }
-
   //--------------------------------------
 
   // h5 -> numpy type conversion
+  // The registry finds the first type with the class, size and sign of t, e.g. NPY_BYTE for a 1 byte signed integer.
+  // The byte order is converted by HDF5 on reading.
   int h5_to_npy(datatype t, bool is_complex) {
 
-    if (h5_py_type_table.empty()) init_h5py();
-    auto _end = h5_py_type_table.end();
-    auto pos  = std::find_if(h5_py_type_table.begin(), _end, [t](auto const &x) { return hdf5_type_equal(x.hdf5_type, t); });
-    if (pos == _end) throw std::runtime_error("HDF5/Python Internal Error : can not find the numpy type from the HDF5 type");
-    int res = pos->numpy_type;
+    int i = detail::find_registered_type(t);
+    if (i < 0 or registered_npy_types[i] < 0)
+      throw std::runtime_error("HDF5/Python Internal Error : can not find the numpy type from the HDF5 type");
+
+    int res = registered_npy_types[i];
     if (is_complex) {
       if (res == NPY_DOUBLE) res = NPY_CDOUBLE;
       if (res == NPY_FLOAT) res = NPY_CFLOAT;
@@ -117,11 +70,10 @@ namespace h5 {
 
   // numpy -> h5 type conversion
   datatype npy_to_h5(int t) {
-    if (h5_py_type_table.empty()) init_h5py();
-    auto _end = h5_py_type_table.end();
-    auto pos  = std::find_if(h5_py_type_table.begin(), _end, [t](auto const &x) { return x.numpy_type == t; });
-    if (pos == _end) std::runtime_error("HDF5/Python Internal Error : can not find the numpy type from the HDF5 type");
-    return pos->hdf5_type;
+    auto _end = registered_npy_types.end();
+    auto pos  = std::find(registered_npy_types.begin(), _end, t);
+    if (pos == _end) throw std::runtime_error("HDF5/Python Internal Error : can not find the HDF5 type from the numpy type");
+    return object::immortal(detail::type_registry()[pos - registered_npy_types.begin()].id);
   }
 
   //--------------------------------------
@@ -138,6 +90,8 @@ namespace h5 {
 #endif
     datatype dt           = npy_to_h5(elementsType);
     const bool is_complex = (elementsType == NPY_CDOUBLE) or (elementsType == NPY_CLONGDOUBLE) or (elementsType == NPY_CFLOAT);
+    // size of the corresponding C object, from numpy rather than H5Tget_size, which would need the hdf5_lock with the GIL held
+    long c_size = long(PyArray_ITEMSIZE(arr_obj)) / (is_complex ? 2 : 1);
 
     array_interface::h5_array_view res{dt, PyArray_DATA(arr_obj), rank, is_complex};
     std::vector<long> c_strides(rank + is_complex, 0);
@@ -146,10 +100,10 @@ namespace h5 {
     for (int i = 0; i < rank; ++i) {
 #ifdef PYTHON_NUMPY_VERSION_LT_17
       res.slab.count[i] = size_t(arr_obj->dimensions[i]);
-      c_strides[i]      = std::ptrdiff_t(arr_obj->strides[i]) / h5_c_size(dt);
+      c_strides[i]      = std::ptrdiff_t(arr_obj->strides[i]) / c_size;
 #else
       res.slab.count[i] = size_t(PyArray_DIMS(arr_obj)[i]);
-      c_strides[i]      = std::ptrdiff_t(PyArray_STRIDES(arr_obj)[i]) / h5_c_size(dt);
+      c_strides[i]      = std::ptrdiff_t(PyArray_STRIDES(arr_obj)[i]) / c_size;
 #endif
       total_size *= res.slab.count[i];
     }
@@ -174,27 +128,51 @@ namespace h5 {
   }
   // -------------------------
 
+  // Releases the GIL in its scope, for the HDF5 calls, which do not touch any Python object.
+  // Other Python threads run during the I/O and the compression. The GIL is taken back if the HDF5 call throws.
+  class gil_release {
+    PyThreadState *state = PyEval_SaveThread();
+
+    public:
+    gil_release() = default;
+    ~gil_release() { PyEval_RestoreThread(state); }
+
+    gil_release(gil_release const &)            = delete;
+    gil_release &operator=(gil_release const &) = delete;
+  };
+
+  // h5_write of a C++ scalar without the GIL
+  template <typename T> static void h5_write_nogil(group const &g, std::string const &name, T const &x) {
+    gil_release nogil;
+    h5_write(g, name, x);
+  }
+
+  // -------------------------
+
   void h5_write_bare(group g, std::string const &name, PyObject *ob) {
 
     import_numpy();
 
     if (PyArray_Check(ob)) {
+      // The view is made with the GIL, ob is kept alive by the caller during the write
       PyArrayObject *arr_obj = (PyArrayObject *)ob;
-      write(g, name, make_av_from_npy(arr_obj), true);
+      auto av                = make_av_from_npy(arr_obj);
+      gil_release nogil;
+      write(g, name, av, true);
     } else if (PyArray_CheckScalar(ob)) {
       // Treat numpy scalars as 0-dimensional ndarrays
       cpp2py::pyref obsc = PyArray_FromScalar(ob, NULL);
       h5_write_bare(g, name, obsc);
     } else if (PyFloat_Check(ob)) {
-      h5_write(g, name, PyFloat_AsDouble(ob));
+      h5_write_nogil(g, name, PyFloat_AsDouble(ob));
     } else if (PyBool_Check(ob)) {
-      h5_write(g, name, bool(PyLong_AsLong(ob)));
+      h5_write_nogil(g, name, bool(PyLong_AsLong(ob)));
     } else if (PyLong_Check(ob)) {
-      h5_write(g, name, long(PyLong_AsLong(ob)));
+      h5_write_nogil(g, name, long(PyLong_AsLong(ob)));
     } else if (PyUnicode_Check(ob)) {
-      h5_write(g, name, (const char *)PyUnicode_AsUTF8(ob));
+      h5_write_nogil(g, name, (const char *)PyUnicode_AsUTF8(ob));
     } else if (PyComplex_Check(ob)) {
-      h5_write(g, name, std::complex<double>{PyComplex_RealAsDouble(ob), PyComplex_ImagAsDouble(ob)});
+      h5_write_nogil(g, name, std::complex<double>{PyComplex_RealAsDouble(ob), PyComplex_ImagAsDouble(ob)});
     } else {
       PyErr_SetString(PyExc_RuntimeError, "The Python object can not be written in HDF5");
       return;
@@ -203,81 +181,418 @@ namespace h5 {
 
   // -------------------------
 
+  // A dataset read to Python in 4 steps, so that all the HDF5 calls are made without the GIL :
+  //  - open (no GIL) : the shape and type of the dataset, and the C++ type of a scalar or string dataset,
+  //  - allocate (GIL) : the numpy array of an array dataset,
+  //  - load (no GIL) : read the data,
+  //  - to_python (GIL) : the Python object.
+  class py_read {
+    using value_t = std::variant<std::monostate, double, long, bool, std::string, dcplx_t, std::complex<double>, std::vector<std::string>,
+                                 std::vector<std::vector<std::string>>>;
+
+    group g;
+    std::string name;
+    array_interface::h5_lengths_type lt;
+    value_t value;                                // a scalar or string dataset
+    cpp2py::pyref arr;                            // an array dataset
+    std::optional<array_interface::h5_array_view> av; // view on arr
+    const char *error = nullptr;                  // the dataset can not be read
+
+    public:
+    py_read(group g_, std::string name_) : g(std::move(g_)), name(std::move(name_)) {}
+
+    void open() {
+      lt = array_interface::get_h5_lengths_type(g, name);
+      hdf5_lock lock; // the GIL is released, cf. hdf5_lock
+      auto klass = H5Tget_class(lt.ty);
+
+      // First case, we have a scalar
+      if (lt.rank() == 0) {
+        if (klass == H5T_FLOAT)
+          value = double{};
+        else if (klass == H5T_INTEGER)
+          value = long{};
+        else if (H5Tequal(lt.ty, h5::hdf5_type<bool>()))
+          value = bool{};
+        else if (klass == H5T_STRING)
+          value = std::string{};
+        else if (H5Tequal(lt.ty, hdf5_type<dcplx_t>()))
+          value = dcplx_t{};
+        else // Default case : error, we can not read
+          error = "h5_read to Python: unknown scalar type";
+      } else if ((lt.rank() == 1) and lt.has_complex_attribute) { // A scalar complex is a special case
+        value = std::complex<double>{};
+      } else if (klass == H5T_STRING) {
+        if (lt.rank() == 1)
+          value = std::vector<std::string>{};
+        else if (lt.rank() == 2)
+          value = std::vector<std::vector<std::string>>{};
+        else
+          error = "Unknown string dataset format";
+      }
+    }
+
+    // false if a Python error is set
+    bool allocate() {
+      if (error) {
+        PyErr_SetString(PyExc_RuntimeError, error);
+        return false;
+      }
+      if (value.index() != 0) return true;
+
+      // Last case : it is an array
+      std::vector<npy_intp> L(lt.rank());                            // Make the lengths
+      std::copy(lt.lengths.begin(), lt.lengths.end(), L.begin());    //npy_intp and size_t may differ, so I can not use =
+      int elementsType = h5_to_npy(lt.ty, lt.has_complex_attribute); // element_type in Python from the hdf5 type and complex tag
+      if (lt.has_complex_attribute)
+        L.pop_back(); // remove the last dim which is 2 in complex case,
+                      // since we are going to build a array of complex
+
+      // make a new numpy array
+      arr = PyArray_SimpleNewFromDescr(int(L.size()), &L[0], PyArray_DescrFromType(elementsType));
+      if (arr.is_null() or PyErr_Occurred()) return false; // in case of allocation error
+      av = make_av_from_npy((PyArrayObject *)(PyObject *)arr);
+      return true;
+    }
+
+    void load() {
+      if (av) {
+        read(g, name, *av, lt);
+      } else {
+        std::visit(
+           [this](auto &x) {
+             if constexpr (not std::is_same_v<std::decay_t<decltype(x)>, std::monostate>) h5_read(g, name, x);
+           },
+           value);
+      }
+    }
+
+    PyObject *to_python() {
+      if (av) return arr.new_ref();
+      return std::visit(
+         []<typename T>(T const &x) -> PyObject * {
+           if constexpr (std::is_same_v<T, double>)
+             return PyFloat_FromDouble(x);
+           else if constexpr (std::is_same_v<T, long>)
+             return PyLong_FromLong(x);
+           else if constexpr (std::is_same_v<T, bool>)
+             return PyBool_FromLong(long(x));
+           else if constexpr (std::is_same_v<T, std::string>)
+             return PyUnicode_FromString(x.c_str());
+           else if constexpr (std::is_same_v<T, dcplx_t>)
+             return PyComplex_FromDoubles(x.r, x.i);
+           else if constexpr (std::is_same_v<T, std::complex<double>>)
+             return PyComplex_FromDoubles(x.real(), x.imag());
+           else if constexpr (std::is_same_v<T, std::monostate>)
+             return NULL;
+           else
+             return cpp2py::convert_to_python(x);
+         },
+         value);
+    }
+  };
+
+  // -------------------------
+
   PyObject *h5_read_bare(group g, std::string const &name) { // There should be no errors from h5 reading
     import_numpy();
 
-    array_interface::h5_lengths_type lt = array_interface::get_h5_lengths_type(g, name);
+    py_read r{std::move(g), name};
+    {
+      gil_release nogil;
+      r.open();
+    }
+    if (!r.allocate()) return NULL;
+    {
+      gil_release nogil;
+      r.load();
+    }
+    return r.to_python();
+  }
 
-    // First case, we have a scalar
-    if (lt.rank() == 0) {
-      if (H5Tget_class(lt.ty) == H5T_FLOAT) {
-        double x;
-        h5_read(g, name, x);
-        return PyFloat_FromDouble(x);
-      }
-      if (H5Tget_class(lt.ty) == H5T_INTEGER) {
-        long x;
-        h5_read(g, name, x);
-        return PyLong_FromLong(x);
-      }
-      if (H5Tequal(lt.ty, h5::hdf5_type<bool>())) {
-        bool x;
-        h5_read(g, name, x);
-        return PyBool_FromLong(long(x));
+  // -------------------------
+
+  PyObject *h5_read_many(group g, std::vector<std::string> const &keys) {
+    import_numpy();
+
+    std::vector<py_read> reads;
+    reads.reserve(keys.size());
+    for (auto const &k : keys) reads.emplace_back(g, k);
+
+    // The metadata of all the datasets, then all the data, each in a single section without the GIL
+    {
+      gil_release nogil;
+      for (auto &r : reads) r.open();
+    }
+    for (auto &r : reads)
+      if (!r.allocate()) return NULL;
+    {
+      gil_release nogil;
+      for (auto &r : reads) r.load();
+    }
+
+    cpp2py::pyref res = PyList_New(Py_ssize_t(reads.size()));
+    if (res.is_null()) return NULL;
+    for (size_t i = 0; i < reads.size(); ++i) {
+      PyObject *x = reads[i].to_python();
+      if (x == NULL) return NULL;
+      PyList_SET_ITEM((PyObject *)res, Py_ssize_t(i), x); // steals x
+    }
+    return res.new_ref();
+  }
+
+  // -------------------------
+
+  // A node of the tree of h5_write_tree : a group (the dict) or a leaf.
+  // A numpy leaf is kept as a C ordered array, and its view.
+  struct tree_node {
+    int parent; // index of the group of the node, -1 for the root
+    std::string name;
+    std::variant<std::monostate, double, bool, long, std::string, std::complex<double>> value; // monostate : a group or an array
+    cpp2py::pyref arr;
+    std::optional<array_interface::h5_array_view> av;
+    [[nodiscard]] bool is_group() const { return value.index() == 0 and not av; }
+  };
+
+  // Append the nodes of the dict d to nodes, with the GIL. False if the tree can not be written natively.
+  static bool flatten_tree(PyObject *d, int parent, std::string name, std::vector<tree_node> &nodes) {
+    int self = int(nodes.size());
+    nodes.push_back({parent, std::move(name), {}, {}, {}});
+
+    PyObject *k = NULL, *v = NULL; // borrowed
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(d, &pos, &k, &v)) {
+      // The keys are written as str(k), cf. Dict.__reduce_to_dict__
+      cpp2py::pyref ks = PyObject_Str(k);
+      if (ks.is_null()) return false;
+      const char *kc = PyUnicode_AsUTF8(ks);
+      if (kc == NULL) return false;
+      std::string key = kc;
+      if (key.find('/') != std::string::npos) return false;
+
+      if (PyDict_CheckExact(v)) {
+        if (not flatten_tree(v, self, key, nodes)) return false;
+        continue;
       }
-      if (H5Tget_class(lt.ty) == H5T_STRING) {
-        std::string x;
-        h5_read(g, name, x);
-        return PyUnicode_FromString(x.c_str());
+
+      tree_node n{self, key, {}, {}, {}};
+      if (PyArray_Check(v) or PyArray_CheckScalar(v)) {
+        // The numpy type must be in the registry, cf. npy_to_h5
+        cpp2py::pyref arr = PyArray_Check(v) ? PyArray_FromAny(v, NULL, 0, 0, NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED, NULL) : PyArray_FromScalar(v, NULL);
+        if (arr.is_null()) return false;
+        int type_num = PyArray_DESCR((PyArrayObject *)(PyObject *)arr)->type_num;
+        if (std::find(registered_npy_types.begin(), registered_npy_types.end(), type_num) == registered_npy_types.end()) return false;
+        n.av  = make_av_from_npy((PyArrayObject *)(PyObject *)arr);
+        n.arr = std::move(arr);
+      } else if (PyFloat_Check(v)) {
+        n.value = PyFloat_AsDouble(v);
+      } else if (PyBool_Check(v)) {
+        n.value = bool(PyLong_AsLong(v));
+      } else if (PyLong_Check(v)) {
+        long x = PyLong_AsLong(v);
+        if (x == -1 and PyErr_Occurred()) {
+          PyErr_Clear(); // overflow : the slow path reports it
+          return false;
+        }
+        n.value = x;
+      } else if (PyUnicode_Check(v)) {
+        const char *c = PyUnicode_AsUTF8(v);
+        if (c == NULL) return false;
+        n.value = std::string{c};
+      } else if (PyComplex_Check(v)) {
+        n.value = std::complex<double>{PyComplex_RealAsDouble(v), PyComplex_ImagAsDouble(v)};
+      } else {
+        return false;
       }
-      if (H5Tequal(lt.ty, hdf5_type<dcplx_t>())) {
-        dcplx_t x;
-        h5_read(g, name, x);
-        return PyComplex_FromDoubles(x.r, x.i);
+      nodes.push_back(std::move(n));
+    }
+    return true;
+  }
+
+  // -------------------------
+
+  bool h5_write_tree(group g, std::string const &name, PyObject *tree) {
+    import_numpy();
+
+    if (!PyDict_CheckExact(tree)) return false;
+    std::vector<tree_node> nodes;
+    if (not flatten_tree(tree, -1, name, nodes)) {
+      PyErr_Clear();
+      return false;
+    }
+
+    // All the groups, their Format and the leaves, without the GIL
+    gil_release nogil;
+    std::vector<group> groups(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      auto &n             = nodes[i];
+      group const &parent = (n.parent < 0 ? g : groups[n.parent]);
+      if (n.is_group()) {
+        groups[i] = parent.create_group(n.name);
+        write_hdf5_format_as_string(groups[i], "Dict");
+      } else if (n.av) {
+        write(parent, n.name, *n.av, true);
+      } else {
+        std::visit(
+           [&](auto const &x) {
+             if constexpr (not std::is_same_v<std::decay_t<decltype(x)>, std::monostate>) h5_write(parent, n.name, x);
+           },
+           n.value);
       }
-      // Default case : error, we can not read
-      PyErr_SetString(PyExc_RuntimeError, "h5_read to Python: unknown scalar type");
+    }
+    return true;
+  }
+
+  // -------------------------
+
+  PyObject *h5_array_info(group g, std::string const &name) {
+    import_numpy();
+
+    array_interface::h5_lengths_type lt;
+    bool is_numeric = false;
+    {
+      gil_release nogil;
+      lt = array_interface::get_h5_lengths_type(g, name);
+      hdf5_lock lock;
+      is_numeric = H5Tget_class(lt.ty) != H5T_STRING and H5Tequal(lt.ty, hdf5_type<dcplx_t>()) <= 0;
+    }
+    // Only the numeric arrays, cf. h5_read_bare for the other cases
+    int rank = lt.rank() - (lt.has_complex_attribute ? 1 : 0);
+    if (rank == 0 or not is_numeric) Py_RETURN_NONE;
+
+    cpp2py::pyref shape = PyTuple_New(rank);
+    if (shape.is_null()) return NULL;
+    for (int i = 0; i < rank; ++i) PyTuple_SET_ITEM((PyObject *)shape, i, PyLong_FromUnsignedLongLong(lt.lengths[i])); // steals
+    PyObject *descr = (PyObject *)PyArray_DescrFromType(h5_to_npy(lt.ty, lt.has_complex_attribute));
+    if (descr == NULL) return NULL;
+    return Py_BuildValue("(ON)", (PyObject *)shape, descr);
+  }
+
+  // -------------------------
+
+  PyObject *h5_read_slice(group g, std::string const &name, std::vector<long> const &offsets, std::vector<long> const &counts,
+                          std::vector<long> const &strides) {
+    import_numpy();
+
+    array_interface::h5_lengths_type lt;
+    bool is_string = false;
+    {
+      gil_release nogil;
+      lt = array_interface::get_h5_lengths_type(g, name);
+      hdf5_lock lock;
+      is_string = (H5Tget_class(lt.ty) == H5T_STRING);
+    }
+    if (is_string) {
+      PyErr_SetString(PyExc_TypeError, "h5_read_slice : a string dataset can not be sliced");
+      return NULL;
+    }
+    int rank = lt.rank() - (lt.has_complex_attribute ? 1 : 0);
+    if (offsets.size() != size_t(rank) or counts.size() != size_t(rank) or strides.size() != size_t(rank)) {
+      PyErr_SetString(PyExc_ValueError, ("h5_read_slice : the slice must have the rank of the dataset " + name).c_str());
+      return NULL;
+    }
+    if (std::any_of(offsets.begin(), offsets.end(), [](long x) { return x < 0; })
+        or std::any_of(counts.begin(), counts.end(), [](long x) { return x < 0; })
+        or std::any_of(strides.begin(), strides.end(), [](long x) { return x <= 0; })) {
+      PyErr_SetString(PyExc_ValueError, "h5_read_slice : the offsets and counts must be non negative, the strides positive");
       return NULL;
     }
 
-    // A scalar complex is a special case
-    if ((lt.rank() == 1) and lt.has_complex_attribute) {
-      std::complex<double> z;
-      h5_read(g, name, z);
-      return PyComplex_FromDoubles(z.real(), z.imag());
+    // The numpy array of the shape of the slice
+    std::vector<npy_intp> L(counts.begin(), counts.end());
+    cpp2py::pyref arr = PyArray_SimpleNewFromDescr(rank, L.data(), PyArray_DescrFromType(h5_to_npy(lt.ty, lt.has_complex_attribute)));
+    if (arr.is_null()) return NULL;
+    if (PyArray_SIZE((PyArrayObject *)(PyObject *)arr) == 0) return arr.new_ref();
+    auto av = make_av_from_npy((PyArrayObject *)(PyObject *)arr);
+
+    array_interface::hyperslab sl(rank, lt.has_complex_attribute);
+    for (int i = 0; i < rank; ++i) {
+      sl.offset[i] = offsets[i];
+      sl.count[i]  = counts[i];
+      sl.stride[i] = strides[i];
     }
+    {
+      gil_release nogil;
+      read(g, name, av, lt, sl);
+    }
+    return arr.new_ref();
+  }
 
-    if (H5Tget_class(lt.ty) == H5T_STRING) {
-      if (lt.rank() == 1) {
-        auto x = h5_read<std::vector<std::string>>(g, name);
-        return cpp2py::convert_to_python(x);
-      }
+  // -------------------------
 
-      if (lt.rank() == 2) {
-        auto x = h5_read<std::vector<std::vector<std::string>>>(g, name);
-        return cpp2py::convert_to_python(x);
+  // Can make_av_from_npy describe the memory of arr as a strided slab of a C-ordered array ?
+  static bool is_slab_of_c_array(PyArrayObject *arr) {
+    int rank      = PyArray_NDIM(arr);
+    auto itemsize = PyArray_ITEMSIZE(arr);
+    if (PyArray_SIZE(arr) == 0) return true;
+    for (int i = 0; i < rank; ++i) {
+      auto s = PyArray_STRIDES(arr)[i];
+      if (s <= 0 or s % itemsize != 0) return false;
+      if (i + 1 < rank) {
+        auto s_next = PyArray_STRIDES(arr)[i + 1];
+        if (s_next <= 0 or s % s_next != 0 or s < s_next * PyArray_DIMS(arr)[i + 1]) return false;
       }
+    }
+    return true;
+  }
+
+  // -------------------------
+
+  PyObject *h5_read_bare(group g, std::string const &name, PyObject *out) {
+    import_numpy();
+
+    if (!PyArray_Check(out)) {
+      PyErr_SetString(PyExc_TypeError, "h5_read : out must be a numpy array");
+      return NULL;
+    }
+    auto *arr = (PyArrayObject *)out;
+    if (!PyArray_ISWRITEABLE(arr)) {
+      PyErr_SetString(PyExc_ValueError, "h5_read : out is not writeable");
+      return NULL;
+    }
+
+    array_interface::h5_lengths_type lt;
+    bool is_string = false;
+    {
+      gil_release nogil;
+      lt = array_interface::get_h5_lengths_type(g, name);
+      hdf5_lock lock;
+      is_string = (H5Tget_class(lt.ty) == H5T_STRING);
+    }
+    if (is_string) {
+      PyErr_SetString(PyExc_TypeError, "h5_read : out can not be used for a string dataset");
+      return NULL;
+    }
 
-      PyErr_SetString(PyExc_RuntimeError, "Unknown string dataset format");
+    // The shape of out must be the one of the dataset, without the last dim (= 2) in the complex case
+    int rank = lt.rank() - (lt.has_complex_attribute ? 1 : 0);
+    bool same_shape = (PyArray_NDIM(arr) == rank);
+    for (int i = 0; same_shape and i < rank; ++i) same_shape = (PyArray_DIMS(arr)[i] == npy_intp(lt.lengths[i]));
+    if (!same_shape) {
+      PyErr_SetString(PyExc_ValueError, ("h5_read : the shape of out does not match the shape of the dataset " + name).c_str());
       return NULL;
     }
 
-    // Last case : it is an array
-    std::vector<npy_intp> L(lt.rank());                            // Make the lengths
-    std::copy(lt.lengths.begin(), lt.lengths.end(), L.begin());    //npy_intp and size_t may differ, so I can not use =
-    int elementsType = h5_to_npy(lt.ty, lt.has_complex_attribute); // element_type in Python from the hdf5 type and complex tag
-    if (lt.has_complex_attribute)
-      L.pop_back(); // remove the last dim which is 2 in complex case,
-                    // since we are going to build a array of complex
-
-    // make a new numpy array
-    PyObject *ob = PyArray_SimpleNewFromDescr(int(L.size()), &L[0], PyArray_DescrFromType(elementsType));
-    if (PyErr_Occurred()) return NULL;
-    // in case of allocation error
-
-    // read from the file
-    read(g, name, make_av_from_npy((PyArrayObject *)ob), lt);
-    return ob;
+    // The numpy type of out is the memory type, HDF5 converts from the type in the file.
+    // A layout which can not be described as a hyperslab (e.g. negative or permuted strides)
+    // is read into a C-ordered temporary, then copied into out.
+    if (is_slab_of_c_array(arr)) {
+      auto av = make_av_from_npy(arr);
+      gil_release nogil;
+      read(g, name, av, lt);
+    } else {
+      cpp2py::pyref tmp = PyArray_NewLikeArray(arr, NPY_CORDER, NULL, 0);
+      if (tmp.is_null()) return NULL;
+      auto av = make_av_from_npy((PyArrayObject *)(PyObject *)tmp);
+      {
+        gil_release nogil;
+        read(g, name, av, lt);
+      }
+      if (PyArray_CopyInto(arr, (PyArrayObject *)(PyObject *)tmp) < 0) return NULL;
+    }
+
+    Py_INCREF(out);
+    return out;
   }
 
 } // namespace h5
@@ -10,6 +10,24 @@ namespace h5 {
   void h5_write_bare(group g, std::string const &name, PyObject *ob);
   PyObject *h5_read_bare(group g, std::string const &name);
 
+  // Read the array dataset name into the preallocated numpy array out, and return out
+  PyObject *h5_read_bare(group g, std::string const &name, PyObject *out);
+
+  // Read the datasets keys of g, as h5_read_bare, in a list. All the HDF5 calls are made without the GIL.
+  PyObject *h5_read_many(group g, std::vector<std::string> const &keys);
+
+  // Write the dict tree, whose values are numpy arrays, scalars, strings or such dicts, in the group name of g, as HDFArchive
+  // does for a dict (Format "Dict"), in one call, without the GIL for the HDF5 calls.
+  // False, and nothing is written, if the tree has other values, e.g. lists or objects.
+  bool h5_write_tree(group g, std::string const &name, PyObject *tree);
+
+  // (shape, dtype) of the numeric array dataset name, None for a scalar or string dataset
+  PyObject *h5_array_info(group g, std::string const &name);
+
+  // Read the hyperslab (offsets, counts, strides) of the array dataset name, in a new numpy array of shape counts
+  PyObject *h5_read_slice(group g, std::string const &name, std::vector<long> const &offsets, std::vector<long> const &counts,
+                          std::vector<long> const &strides);
+
 } // namespace h5
 
 #endif // LIBH5_H5PY_IO_HPP
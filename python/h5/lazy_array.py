@@ -0,0 +1,102 @@
+# Copyright (c) 2019-2020 Simons Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http:#www.apache.org/licenses/LICENSE-2.0.txt
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy
+
+class LazyArray:
+    """
+    A proxy to an array dataset of an archive, which is only read when sliced.
+
+    It has the shape and dtype of the array. Indexing with integers, slices and Ellipsis,
+    as for a numpy array, reads only the corresponding hyperslab of the dataset, e.g.
+    ``A[:10, 0]`` reads 10 elements. ``A[...]`` or ``numpy.asarray(A)`` read the whole array.
+    """
+
+    def __init__(self, group, key, shape, dtype):
+        self._group = group # the HDFArchiveGroupBasicLayer of the dataset
+        self._key = key
+        self.shape = tuple(shape)
+        self.dtype = numpy.dtype(dtype)
+
+    @property
+    def ndim(self): return len(self.shape)
+
+    @property
+    def size(self):
+        n = 1
+        for l in self.shape: n *= l
+        return n
+
+    def __len__(self):
+        if not self.shape: raise TypeError("len() of unsized object")
+        return self.shape[0]
+
+    def __repr__(self):
+        return "LazyArray(%r, shape=%s, dtype=%s)"%(self._key, self.shape, self.dtype)
+
+    def __array__(self, dtype = None):
+        a = self[...]
+        return a if dtype is None else a.astype(dtype)
+
+    def read(self):
+        """Read the whole array"""
+        return self[...]
+
+    def _hyperslab(self, index):
+        """
+        The hyperslab (offsets, counts, strides) of the index, and
+        the numpy index to apply to the slab read from the file : the reversal of the negative steps
+        and the removal of the dimensions indexed by an integer.
+        """
+        if not isinstance(index, tuple): index = (index,)
+        n_ell = sum(1 for i in index if i is Ellipsis)
+        if n_ell > 1:
+            raise IndexError("an index can only have a single ellipsis ('...')")
+        n_ell = self.ndim - (len(index) - n_ell)
+        if n_ell < 0:
+            raise IndexError("too many indices for array: array is %s-dimensional, but %s were indexed"%(self.ndim, len(index)))
+        full = []
+        for i in index:
+            if i is Ellipsis: full += [slice(None)] * n_ell
+            else : full.append(i)
+        full += [slice(None)] * (self.ndim - len(full))
+
+        offsets, counts, strides, post = [], [], [], []
+        for d, (i, n) in enumerate(zip(full, self.shape)):
+            if isinstance(i, slice):
+                r = range(*i.indices(n))
+                step = abs(r.step)
+                offsets.append(min(r) if r else 0)
+                counts.append(len(r))
+                strides.append(step)
+                post.append(slice(None, None, -1) if r.step < 0 else slice(None))
+            elif isinstance(i, (int, numpy.integer)) and not isinstance(i, bool):
+                j = int(i)
+                if j < -n or j >= n:
+                    raise IndexError("index %s is out of bounds for axis %s with size %s"%(j, d, n))
+                offsets.append(j % n)
+                counts.append(1)
+                strides.append(1)
+                post.append(0)
+            else:
+                raise IndexError("LazyArray : only integers, slices and Ellipsis are valid indices, not %r"%(i,))
+        return offsets, counts, strides, tuple(post)
+
+    def __getitem__(self, index):
+        offsets, counts, strides, post = self._hyperslab(index)
+        if 0 in counts:
+            a = numpy.empty(counts, self.dtype)
+        else:
+            a = self._group._read_slice(self._key, offsets, counts, strides)
+        return a[post]
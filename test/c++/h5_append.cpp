@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, AppendScalar) {
+
+  {
+    h5::file file{"test_append.h5", 'w'};
+    h5::group grp{file};
+    for (int i = 0; i < 100; ++i) h5::h5_append(grp, "x", double(i));
+    for (int i = 0; i < 3; ++i) h5::h5_append(grp, "z", dcomplex(i, -i));
+  }
+
+  {
+    // reopen and keep appending
+    h5::file file{"test_append.h5", 'a'};
+    h5::group grp{file};
+    h5::h5_append(grp, "x", std::vector<double>{100, 101, 102});
+  }
+
+  h5::file file{"test_append.h5", 'r'};
+  std::vector<double> x;
+  std::vector<dcomplex> z;
+  h5::read(file, "x", x);
+  h5::read(file, "z", z);
+
+  std::vector<double> x_exp(103);
+  std::iota(x_exp.begin(), x_exp.end(), 0.0);
+  EXPECT_EQ(x, x_exp);
+  EXPECT_EQ(z, (std::vector<dcomplex>{{0, 0}, {1, -1}, {2, -2}}));
+}
+
+TEST(H5, AppendRows) {
+
+  std::vector<long> a(2 * 3);
+  std::iota(a.begin(), a.end(), 0);
+
+  auto make_view = [](long *data, long n0, long n1) {
+    h5ai::h5_array_view v{h5::hdf5_type<long>(), (void *)data, 2, false};
+    v.slab.count[0] = v.L_tot[0] = n0;
+    v.slab.count[1] = v.L_tot[1] = n1;
+    return v;
+  };
+
+  h5::file file{"test_append_rows.h5", 'w'};
+  h5::group grp{file};
+  h5ai::append(grp, "a", make_view(a.data(), 2, 3));
+  h5ai::append(grp, "a", make_view(a.data(), 1, 3));
+
+  auto lt = h5ai::get_h5_lengths_type(grp, "a");
+  EXPECT_EQ(lt.lengths, (std::vector<h5::hsize_t>{3, 3}));
+
+  std::vector<long> b(3 * 3);
+  h5ai::read(grp, "a", make_view(b.data(), 3, 3), lt);
+  EXPECT_EQ(b, (std::vector<long>{0, 1, 2, 3, 4, 5, 0, 1, 2}));
+
+  // Mismatch of the trailing dimension, or of the type
+  EXPECT_THROW(h5ai::append(grp, "a", make_view(a.data(), 1, 2)), std::runtime_error);
+  EXPECT_THROW(h5::h5_append(grp, "a", 1.0), std::runtime_error);
+
+  // A dataset written with a fixed size can not be extended
+  h5::write(grp, "fixed", std::vector<double>{1, 2});
+  EXPECT_THROW(h5::h5_append(grp, "fixed", 3.0), std::runtime_error);
+}
+
+TEST(H5, AppendChunks) {
+
+  h5::file file{"test_append_chunks.h5", 'w'};
+  h5::group grp{file};
+
+  // A large first block spans several chunks of about 64 kB : the later appends only touch the last chunk
+  std::vector<double> big(1000000, 1.0);
+  h5::h5_append(grp, "x", big);
+  h5::h5_append(grp, "x", 2.0);
+
+  auto ds       = grp.open_dataset("x");
+  hid_t dcpl    = H5Dget_create_plist(ds);
+  hsize_t chunk = 0;
+  EXPECT_EQ(H5Pget_chunk(dcpl, 1, &chunk), 1);
+  EXPECT_EQ(chunk, 8192u);
+
+  // The filters of the write policy (deflate by default)
+  EXPECT_EQ(H5Pget_nfilters(dcpl), 1);
+  H5Pclose(dcpl);
+
+  auto x = h5::read<std::vector<double>>(grp, "x");
+  EXPECT_EQ(x.size(), 1000001u);
+  EXPECT_EQ(x.back(), 2.0);
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <memory>
+#include <vector>
+#include <numeric>
+
+TEST(H5, AsyncWriter) {
+
+  std::vector<double> v(1000);
+  std::iota(v.begin(), v.end(), 0.0);
+
+  {
+    h5::file file{"test_async_writer.h5", 'w'};
+    h5::group grp{file};
+    auto sub = grp.create_group("sub");
+
+    h5::async_writer w{file};
+    w.write("v", v);
+    w.write(sub, "x", 3.5);
+    w.write("s", std::string{"abc"});
+
+    // The snapshot is taken at the write : later changes are not seen
+    auto v2 = v;
+    w.write("v2", std::move(v2));
+    v[0] = -1;
+
+    w.flush();
+    EXPECT_EQ(w.pending(), 0);
+  }
+
+  h5::file file{"test_async_writer.h5", 'r'};
+  h5::group grp{file};
+  auto v_read = h5::read<std::vector<double>>(grp, "v");
+  EXPECT_EQ(v_read[0], 0);
+  EXPECT_EQ(v_read, h5::read<std::vector<double>>(grp, "v2"));
+  EXPECT_EQ(h5::read<double>(grp.open_group("sub"), "x"), 3.5);
+  EXPECT_EQ(h5::read<std::string>(grp, "s"), "abc");
+}
+
+// A move-only object, owning its data
+struct owner {
+  std::unique_ptr<std::vector<int>> p;
+};
+void h5_write(h5::group g, std::string const &name, owner const &o) { h5::write(g, name, *o.p); }
+
+TEST(H5, AsyncWriterMoveOnly) {
+
+  {
+    h5::file file{"test_async_writer_move_only.h5", 'w'};
+    h5::async_writer w{file};
+    w.write("o", owner{std::make_unique<std::vector<int>>(10, 7)});
+    w.flush();
+  }
+
+  h5::file file{"test_async_writer_move_only.h5", 'r'};
+  EXPECT_EQ(h5::read<std::vector<int>>(h5::group{file}, "o"), std::vector<int>(10, 7));
+}
+
+TEST(H5, AsyncWriterError) {
+
+  h5::file file{"test_async_writer_error.h5", 'w'};
+  h5::async_writer w{file};
+
+  // no such subgroup
+  w.write("missing/x", 1);
+  w.write("y", 2);
+  EXPECT_THROW(w.flush(), std::runtime_error);
+
+  // The error is reported once, the writer is usable again
+  w.write("z", 3);
+  EXPECT_NO_THROW(w.flush());
+
+  h5::group grp{file};
+  EXPECT_FALSE(grp.has_key("y"));
+  EXPECT_EQ(h5::read<int>(grp, "z"), 3);
+}
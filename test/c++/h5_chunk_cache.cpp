@@ -0,0 +1,102 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+// The chunk cache of the open dataset ds : slots, bytes, w0
+struct cache_t {
+  size_t slots = 0, bytes = 0;
+  double w0 = 0;
+};
+cache_t chunk_cache(h5::dataset const &ds) {
+  cache_t c;
+  h5::proplist dapl = H5Dget_access_plist(ds);
+  H5Pget_chunk_cache(dapl, &c.slots, &c.bytes, &c.w0);
+  return c;
+}
+
+TEST(H5, ChunkCacheHints) {
+
+  // A 200 x 300 matrix of doubles, in chunks of about 8000 bytes
+  long n0 = 200, n1 = 300;
+  std::vector<double> a(n0 * n1);
+  std::iota(a.begin(), a.end(), 0.0);
+  {
+    h5::file file{"test_chunk_cache.h5", 'w'};
+    h5::group grp{file};
+    auto p        = grp.get_write_policy();
+    p.chunk_bytes = 8000;
+    grp.set_write_policy(p);
+    h5ai::h5_array_view v{h5::hdf5_type<double>(), a.data(), 2, false};
+    v.slab.count = v.L_tot = {h5::hsize_t(n0), h5::hsize_t(n1)};
+    h5ai::write(grp, "a", v, true);
+    h5::write(grp, "x", 1.0);
+  }
+
+  h5::file_options opts;
+  opts.chunk_cache_bytes = 64 * 1024;
+  opts.chunk_cache_slots = 1009;
+  h5::file file{"test_chunk_cache.h5", 'r', opts};
+  h5::group grp{file};
+
+  h5::proplist dcpl = H5Dget_create_plist(grp.open_dataset("a"));
+  h5::hsize_t cdims[2];
+  H5Pget_chunk(dcpl, 2, cdims);
+  size_t chunk_bytes = cdims[0] * cdims[1] * sizeof(double), n_chunks0 = (n0 + cdims[0] - 1) / cdims[0], n_chunks1 = (n1 + cdims[1] - 1) / cdims[1];
+
+  // The file default
+  auto c = chunk_cache(grp.open_dataset("a"));
+  EXPECT_EQ(c.bytes, 64 * 1024);
+  EXPECT_EQ(c.slots, 1009);
+
+  // Sized by the hints
+  c = chunk_cache(grp.open_dataset("a", h5::access_hint::random));
+  EXPECT_EQ(c.bytes, n_chunks0 * n_chunks1 * chunk_bytes);
+  EXPECT_GE(c.slots, 100 * n_chunks0 * n_chunks1);
+
+  c = chunk_cache(grp.open_dataset("a", h5::access_hint::column_sweep));
+  EXPECT_EQ(c.bytes, n_chunks0 * chunk_bytes);
+  EXPECT_EQ(c.w0, 0);
+
+  c = chunk_cache(grp.open_dataset("a", h5::access_hint::sequential));
+  EXPECT_EQ(n_chunks1 * chunk_bytes, chunk_bytes); // the chunks span whole rows
+  EXPECT_EQ(c.bytes, 64 * 1024);                    // at least the cache of the file
+  EXPECT_EQ(c.w0, 1);
+
+  // Not chunked : the hint is ignored
+  EXPECT_TRUE(grp.open_dataset("x", h5::access_hint::random).is_valid());
+
+  // Tiled traversal, column by column, with the same open dataset
+  auto lt = h5ai::get_h5_lengths_type(grp, "a", h5::access_hint::column_sweep);
+  EXPECT_EQ(chunk_cache(lt.ds).bytes, n_chunks0 * chunk_bytes);
+  std::vector<double> col(n0);
+  for (long j = 0; j < n1; j += 37) {
+    h5ai::hyperslab sl(2, false);
+    sl.offset = {0, h5::hsize_t(j)};
+    sl.count  = {h5::hsize_t(n0), 1};
+    h5ai::h5_array_view v{h5::hdf5_type<double>(), col.data(), 2, false};
+    v.slab.count = v.L_tot = {h5::hsize_t(n0), 1};
+    h5ai::read(grp, "a", v, lt, sl);
+    for (long i = 0; i < n0; ++i) EXPECT_EQ(col[i], a[i * n1 + j]);
+  }
+}
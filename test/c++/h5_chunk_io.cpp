@@ -0,0 +1,142 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+// A policy with small chunks, which do not divide the arrays below
+h5::write_policy chunk_policy(h5::write_policy::filter_t filter, unsigned n_threads) {
+  h5::write_policy p;
+  p.filter      = filter;
+  p.chunk_bytes = 1000;
+  p.n_threads   = n_threads;
+  return p;
+}
+
+TEST(H5, ChunkIO) {
+
+  using filter_t = h5::write_policy::filter_t;
+  long n0 = 37, n1 = 29;
+  std::vector<double> a(n0 * n1);
+  std::iota(a.begin(), a.end(), 0.0);
+  std::vector<long> l(1000);
+  std::iota(l.begin(), l.end(), -500);
+
+  for (auto filter : {filter_t::deflate, filter_t::shuffle_deflate}) {
+    for (unsigned n_write : {1u, 4u}) {
+      {
+        h5::file file{"test_chunk_io.h5", 'w'};
+        h5::group grp{file};
+        grp.set_write_policy(chunk_policy(filter, n_write));
+        h5ai::write(grp, "a", make_view_2d(a.data(), n0, n1), true);
+        h5::write(grp, "l", l);
+      }
+
+      // Whatever the writer, the chunks can be read by HDF5 or by the thread pool
+      for (unsigned n_read : {1u, 0u, 3u}) {
+        h5::file file{"test_chunk_io.h5", 'r'};
+        h5::group grp{file};
+        grp.set_write_policy(chunk_policy(filter, n_read));
+
+        std::vector<double> b(n0 * n1);
+        h5ai::read(grp, "a", make_view_2d(b.data(), n0, n1), h5ai::get_h5_lengths_type(grp, "a"));
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(h5::read<std::vector<long>>(grp, "l"), l);
+
+        // The thread pool is used directly for these datasets
+        auto lt = h5ai::get_h5_lengths_type(grp, "a");
+        std::vector<double> c(n0 * n1);
+        EXPECT_TRUE(h5ai::read_chunks(lt.ds, make_view_2d(c.data(), n0, n1), lt, 2));
+        EXPECT_EQ(a, c);
+      }
+    }
+  }
+}
+
+TEST(H5, ChunkIOStridedAndComplex) {
+
+  long n0 = 20, n1 = 15;
+  std::vector<dcomplex> z(n0 * n1);
+  for (int i = 0; i < z.size(); ++i) z[i] = dcomplex(i, -2 * i);
+
+  // Every second column of a (n0, 2 * n1) array
+  std::vector<double> big(n0 * 2 * n1, 0);
+  h5ai::h5_array_view v{h5::hdf5_type<double>(), big.data(), 2, false};
+  v.slab.count  = {h5::hsize_t(n0), h5::hsize_t(n1)};
+  v.slab.stride = {1, 2};
+  v.L_tot       = {h5::hsize_t(n0), h5::hsize_t(2 * n1)};
+  for (long i = 0; i < n0 * n1; ++i) big[2 * i] = i;
+
+  {
+    h5::file file{"test_chunk_io_strided.h5", 'w'};
+    h5::group grp{file};
+    grp.set_write_policy(chunk_policy(h5::write_policy::filter_t::shuffle_deflate, 3));
+    h5ai::write(grp, "z", make_view_2d(z.data(), n0, n1), true);
+    h5ai::write(grp, "s", v, true);
+  }
+
+  h5::file file{"test_chunk_io_strided.h5", 'r'};
+  h5::group grp{file};
+  grp.set_write_policy(chunk_policy(h5::write_policy::filter_t::shuffle_deflate, 3));
+
+  std::vector<dcomplex> z2(n0 * n1);
+  h5ai::read(grp, "z", make_view_2d(z2.data(), n0, n1), h5ai::get_h5_lengths_type(grp, "z"));
+  EXPECT_EQ(z, z2);
+
+  std::vector<double> s(n0 * n1), expected(n0 * n1);
+  std::iota(expected.begin(), expected.end(), 0.0);
+  h5ai::read(grp, "s", make_view_2d(s.data(), n0, n1), h5ai::get_h5_lengths_type(grp, "s"));
+  EXPECT_EQ(s, expected);
+
+  // Read back into the strided view
+  std::fill(big.begin(), big.end(), -1);
+  h5ai::read(grp, "s", v, h5ai::get_h5_lengths_type(grp, "s"));
+  for (long i = 0; i < n0 * n1; ++i) {
+    EXPECT_EQ(big[2 * i], i);
+    EXPECT_EQ(big[2 * i + 1], -1);
+  }
+}
+
+TEST(H5, ChunkIOFallback) {
+
+  std::vector<double> a(6);
+  std::iota(a.begin(), a.end(), 0.0);
+
+  h5::file file{"test_chunk_io_fallback.h5", 'w'};
+  h5::group grp{file};
+  h5ai::write(grp, "contiguous", make_view_2d(a.data(), 2, 3), false);
+  h5ai::write(grp, "chunked", make_view_2d(a.data(), 2, 3), true);
+
+  // Not chunked, or read into another type : nothing is read
+  std::vector<double> b(6, 0);
+  auto lt = h5ai::get_h5_lengths_type(grp, "contiguous");
+  EXPECT_FALSE(h5ai::read_chunks(lt.ds, make_view_2d(b.data(), 2, 3), lt, 2));
+  std::vector<float> f(6, 0);
+  lt = h5ai::get_h5_lengths_type(grp, "chunked");
+  EXPECT_FALSE(h5ai::read_chunks(lt.ds, make_view_2d(f.data(), 2, 3), lt, 2));
+
+  // ... and read falls back to H5Dread
+  auto p      = grp.get_write_policy();
+  p.n_threads = 0;
+  grp.set_write_policy(p);
+  h5ai::read(grp, "chunked", make_view_2d(f.data(), 2, 3), lt);
+  EXPECT_EQ(f, (std::vector<float>{0, 1, 2, 3, 4, 5}));
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <array>
+
+struct point_t {
+  double x = 0, y = 0;
+  bool operator==(point_t const &) const = default;
+};
+
+struct particle_t {
+  long id = 0;
+  dcomplex amp = 0;
+  std::array<double, 3> v = {};
+  point_t pos;
+  bool operator==(particle_t const &) const = default;
+};
+
+// The complex fields are not a whole number of complex apart : gathered
+struct packed_t {
+  dcomplex z = 0;
+  double d   = 0;
+  int i      = 0;
+  std::array<short, 3> s     = {};
+  std::array<dcomplex, 2> zz = {};
+  bool operator==(packed_t const &) const = default;
+};
+
+H5_SPECIALIZE_COMPOUND(point_t, H5_COMPOUND_FIELD(point_t, x), H5_COMPOUND_FIELD(point_t, y));
+H5_SPECIALIZE_COMPOUND(particle_t, H5_COMPOUND_FIELD(particle_t, id), H5_COMPOUND_FIELD(particle_t, amp), H5_COMPOUND_FIELD(particle_t, v),
+                       H5_COMPOUND_FIELD(particle_t, pos));
+H5_SPECIALIZE_COMPOUND(packed_t, H5_COMPOUND_FIELD(packed_t, z), H5_COMPOUND_FIELD(packed_t, d), H5_COMPOUND_FIELD(packed_t, i),
+                       H5_COMPOUND_FIELD(packed_t, s), H5_COMPOUND_FIELD(packed_t, zz));
+
+TEST(H5, ColumnarVector) {
+
+  std::vector<particle_t> v;
+  for (long i = 0; i < 100; ++i) v.push_back({i, {double(i), -1.0}, {1.0 * i, 2.0 * i, 3.0 * i}, {0.5 * i, -0.5 * i}});
+  std::vector<packed_t> w;
+  for (int i = 0; i < 10; ++i) w.push_back({{1.0, 1.0 * i}, 0.1 * i, i, {short(i), short(2 * i), short(3 * i)}, {{{0, 1.0 * i}, {-1.0 * i, 0}}}});
+
+  {
+    h5::file file{"test_columnar.h5", 'w'};
+    h5::write(file, "v", v);
+    h5::write(file, "w", w);
+    h5::write(file, "empty", std::vector<particle_t>{});
+
+    // The per-element format, as written by previous versions
+    auto gr = h5::group{file}.create_group("old");
+    h5::write_hdf5_format(gr, v);
+    for (int i = 0; i < 3; ++i) h5::write(gr, std::to_string(i), v[i]);
+  }
+
+  h5::file file{"test_columnar.h5", 'r'};
+  h5::group grp{file};
+
+  // One dataset per field
+  auto gv = grp.open_group("v");
+  EXPECT_EQ(gv.size(), 4);
+  EXPECT_EQ(h5::array_interface::get_h5_lengths_type(gv, "v").lengths, (std::vector<h5::hsize_t>{100, 3}));
+  EXPECT_EQ(h5::array_interface::get_h5_lengths_type(gv, "amp").lengths, (std::vector<h5::hsize_t>{100, 2}));
+  EXPECT_TRUE(gv.has_subgroup("pos"));
+  EXPECT_EQ(h5::array_interface::get_h5_lengths_type(grp.open_group("w"), "zz").lengths, (std::vector<h5::hsize_t>{10, 2, 2}));
+
+  EXPECT_EQ(h5::read<std::vector<particle_t>>(file, "v"), v);
+  EXPECT_EQ(h5::read<std::vector<packed_t>>(file, "w"), w);
+  EXPECT_TRUE(h5::read<std::vector<particle_t>>(file, "empty").empty());
+  EXPECT_EQ(h5::read<std::vector<particle_t>>(file, "old"), (std::vector<particle_t>{v.begin(), v.begin() + 3}));
+}
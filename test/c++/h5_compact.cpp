@@ -0,0 +1,144 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <h5/compact.hpp>
+
+#include <array>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <variant>
+
+// A user type with the compact hooks
+struct params_t {
+  int n       = 0;
+  double beta = 0;
+  std::vector<std::string> names;
+  bool operator==(params_t const &) const = default;
+};
+
+void h5_write_compact(h5::compact::ostream &os, params_t const &p) {
+  h5::compact::write(os, p.n);
+  h5::compact::write(os, p.beta);
+  h5::compact::write(os, p.names);
+}
+
+void h5_read_compact(h5::compact::istream &is, params_t &p) {
+  h5::compact::read(is, p.n);
+  h5::compact::read(is, p.beta);
+  h5::compact::read(is, p.names);
+}
+
+// A user type with only h5_write and h5_read
+struct point_t {
+  double x = 0, y = 0;
+  bool operator==(point_t const &) const = default;
+};
+
+void h5_write(h5::group const &g, std::string const &name, point_t const &p) {
+  auto gr = g.create_group(name);
+  h5::write(gr, "x", p.x);
+  h5::write(gr, "y", p.y);
+}
+
+void h5_read(h5::group const &g, std::string const &name, point_t &p) {
+  auto gr = g.open_group(name);
+  h5::read(gr, "x", p.x);
+  h5::read(gr, "y", p.y);
+}
+
+template <typename T>
+void check_round_trip(T const &x) {
+  EXPECT_EQ(h5::deserialize_compact<T>(h5::serialize_compact(x)), x);
+}
+
+TEST(H5, CompactSerialize) {
+
+  check_round_trip(3);
+  check_round_trip(2.5);
+  check_round_trip(true);
+  check_round_trip(dcomplex(1, -2));
+  check_round_trip(std::string{"abc"});
+  check_round_trip(std::string{});
+  check_round_trip(std::vector<double>{1, 2, 3});
+  check_round_trip(std::vector<dcomplex>{{1, 2}, {3, 4}});
+  check_round_trip(std::vector<bool>{true, false, true});
+  check_round_trip(std::vector<std::string>{"a", "", "long string"});
+  check_round_trip(std::vector<std::vector<int>>{{1}, {}, {2, 3}});
+  check_round_trip(std::array<long, 3>{1, 2, 3});
+  check_round_trip(std::array<std::string, 2>{"a", "b"});
+  check_round_trip(std::map<std::string, double>{{"a", 1}, {"b", 2}});
+  check_round_trip(std::map<int, std::vector<double>>{{1, {1.0}}, {2, {}}});
+  check_round_trip(std::pair<int, double>{1, 2.5});
+  check_round_trip(std::tuple<int, std::string, std::vector<float>>{1, "a", {1.5f}});
+  check_round_trip(std::optional<int>{});
+  check_round_trip(std::optional<int>{4});
+  check_round_trip(std::variant<int, std::string>{std::string{"x"}});
+  check_round_trip(std::variant<int, std::string>{7});
+  check_round_trip(params_t{3, 10.0, {"up", "down"}});
+  check_round_trip(std::vector<params_t>{{1, 2.0, {}}, {2, 3.0, {"a"}}});
+  check_round_trip(point_t{1.5, -2});
+  check_round_trip(std::map<std::string, point_t>{{"origin", {}}, {"p", {1, 2}}});
+
+  // Much smaller than the HDF5 file image
+  auto p     = std::pair<int, double>{1, 2.5};
+  auto bytes = h5::serialize_compact(p);
+  EXPECT_LT(bytes.size(), 32);
+  EXPECT_GT(h5::serialize(p).size(), 10 * bytes.size());
+}
+
+TEST(H5, CompactSerializeErrors) {
+
+  auto buf = h5::serialize_compact(std::vector<int>{1, 2, 3});
+
+  // Another type
+  EXPECT_THROW(h5::deserialize_compact<std::vector<long>>(buf), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<std::string>(buf), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<int>(buf), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<bool>(h5::serialize_compact(std::complex<long double>{1, 2})), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<std::complex<long double>>(h5::serialize_compact(true)), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<long double>(h5::serialize_compact(std::complex<long double>{1, 2})), std::runtime_error);
+
+  // Truncated, or with trailing bytes
+  auto truncated = buf;
+  truncated.pop_back();
+  EXPECT_THROW(h5::deserialize_compact<std::vector<int>>(truncated), std::runtime_error);
+  auto longer = buf;
+  longer.push_back(std::byte{0});
+  EXPECT_THROW(h5::deserialize_compact<std::vector<int>>(longer), std::runtime_error);
+
+  // A length larger than the rest of the buffer is rejected before any allocation
+  auto huge = [](std::vector<std::byte> b, std::size_t header) {
+    b.resize(header);
+    for (int i = 0; i < 8; ++i) b.push_back(std::byte{0xff});
+    b.push_back(std::byte{0x0f});
+    return b;
+  };
+  EXPECT_THROW(h5::deserialize_compact<std::vector<int>>(huge(buf, 8)), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<std::string>(huge(h5::serialize_compact(std::string{"abc"}), 7)), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<std::vector<std::string>>(huge(h5::serialize_compact(std::vector<std::string>{"a"}), 7)),
+               std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<point_t>(huge(h5::serialize_compact(point_t{1, 2}), 7)), std::runtime_error);
+
+  // Another format version, or not the compact format
+  auto other_version = buf;
+  other_version[4]   = std::byte{h5::compact::format_version + 1};
+  EXPECT_THROW(h5::deserialize_compact<std::vector<int>>(other_version), std::runtime_error);
+  EXPECT_THROW(h5::deserialize_compact<std::vector<int>>(h5::serialize(std::vector<int>{1, 2, 3})), std::runtime_error);
+}
@@ -76,4 +76,45 @@ TEST(H5, ComplexCompound){
 
 };
 
+TEST(H5, ComplexConversions){
+
+  std::vector<h5::dcplx_t> vec = { h5::dcplx_t{1.0, -1.0}, h5::dcplx_t{2.0, -2.0} };
+  std::array<double, 3> real_arr = {1.0, 2.0, 3.0};
+  std::vector<float> real_vec = {4.0, 5.0};
+
+  {
+    h5::file file("complex_conversions.h5", 'w');
+    h5::group grp(file);
+    h5::array_interface::h5_array_view v{h5::hdf5_type<h5::dcplx_t>(), vec.data(), 1, false};
+    v.slab.count[0] = v.L_tot[0] = vec.size();
+    h5::array_interface::write(grp, "cplx_vec", v, false);
+    h5_write(file, "real_arr", real_arr);
+    h5_write(file, "real_vec", real_vec);
+    h5_write(file, "real_scal", 6.0);
+  }
+
+  {
+    h5::file file("complex_conversions.h5", 'r');
+
+    // compound into vector<complex<double>> and vector<complex<float>>
+    auto vec_in = h5::read<std::vector<std::complex<double>>>(file, "cplx_vec");
+    EXPECT_EQ(vec_in, (std::vector<std::complex<double>>{{1.0, -1.0}, {2.0, -2.0}}));
+    auto vec_f = h5::read<std::vector<std::complex<float>>>(file, "cplx_vec");
+    EXPECT_EQ(vec_f, (std::vector<std::complex<float>>{{1.0, -1.0}, {2.0, -2.0}}));
+
+    // real into complex : the imaginary parts are set to 0
+    std::array<std::complex<double>, 3> arr_in;
+    arr_in.fill({-1, -1});
+    h5_read(file, "real_arr", arr_in);
+    EXPECT_EQ(arr_in, (std::array<std::complex<double>, 3>{{{1.0, 0}, {2.0, 0}, {3.0, 0}}}));
+
+    auto rvec_in = h5::read<std::vector<std::complex<float>>>(file, "real_vec");
+    EXPECT_EQ(rvec_in, (std::vector<std::complex<float>>{{4.0, 0}, {5.0, 0}}));
+
+    std::complex<double> scal_in{-1, -1};
+    h5_read(file, "real_scal", scal_in);
+    EXPECT_EQ(scal_in, (std::complex<double>{6.0, 0}));
+  }
+};
+
 // clang-format on
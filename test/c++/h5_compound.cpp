@@ -0,0 +1,72 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <array>
+
+struct mesh_t {
+  double omega_max = 0;
+  long n_w         = 0;
+  bool operator==(mesh_t const &) const = default;
+};
+
+struct params_t {
+  double beta = 0;
+  int n_iw    = 0;
+  bool verbose = false;
+  dcomplex mu  = 0;
+  std::array<double, 3> k = {};
+  mesh_t mesh;
+  bool operator==(params_t const &) const = default;
+};
+
+H5_SPECIALIZE_COMPOUND(mesh_t, H5_COMPOUND_FIELD(mesh_t, omega_max), H5_COMPOUND_FIELD(mesh_t, n_w));
+H5_SPECIALIZE_COMPOUND(params_t, H5_COMPOUND_FIELD(params_t, beta), H5_COMPOUND_FIELD(params_t, n_iw), H5_COMPOUND_FIELD(params_t, verbose),
+                       H5_COMPOUND_FIELD(params_t, mu), H5_COMPOUND_FIELD(params_t, k), H5_COMPOUND_FIELD(params_t, mesh));
+
+// A later version of the struct, with a reordered field list and a new field
+struct params_v2_t {
+  int n_iw    = 0;
+  double beta = 0;
+  long n_tau  = -1;
+};
+H5_SPECIALIZE_COMPOUND(params_v2_t, H5_COMPOUND_FIELD(params_v2_t, n_iw), H5_COMPOUND_FIELD(params_v2_t, beta), H5_COMPOUND_FIELD(params_v2_t, n_tau));
+
+TEST(H5, Compound) {
+
+  auto p = params_t{10.0, 1025, true, {0.5, -0.5}, {1, 2, 3}, {20.0, 100}};
+
+  {
+    h5::file file{"test_compound.h5", 'w'};
+    h5::write(file, "params", p);
+
+    // A single dataset
+    h5::group grp{file};
+    EXPECT_TRUE(grp.has_dataset("params"));
+  }
+
+  h5::file file{"test_compound.h5", 'r'};
+  auto p_read = h5::read<params_t>(file, "params");
+  EXPECT_EQ(p, p_read);
+
+  // The members are matched by name
+  auto p2 = h5::read<params_v2_t>(file, "params");
+  EXPECT_EQ(p2.n_iw, 1025);
+  EXPECT_EQ(p2.beta, 10.0);
+  EXPECT_EQ(p2.n_tau, -1);
+}
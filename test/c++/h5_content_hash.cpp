@@ -0,0 +1,166 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, XXH64) {
+  // Reference values of xxHash
+  EXPECT_EQ(h5ai::xxh64("", 0), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(h5ai::xxh64("a", 1), 0xD24EC4F1A98C6E5BULL);
+  EXPECT_EQ(h5ai::xxh64("abc", 3), 0x44BC2CF5AD770999ULL);
+  std::string s = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(h5ai::xxh64(s.data(), s.size()), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(H5, ContentHashOfViews) {
+
+  std::vector<double> a(6 * 4);
+  std::iota(a.begin(), a.end(), 0.0);
+
+  // A strided view and its contiguous copy have the same hash
+  h5ai::h5_array_view v{h5::hdf5_type<double>(), a.data(), 2, false};
+  v.slab.count  = {3, 2};
+  v.slab.stride = {2, 2};
+  v.slab.offset = {0, 1};
+  v.L_tot       = {6, 4};
+
+  std::vector<double> b{1, 3, 9, 11, 17, 19};
+  h5ai::h5_array_view w{h5::hdf5_type<double>(), b.data(), 2, false};
+  w.slab.count = w.L_tot = {3, 2};
+  EXPECT_EQ(h5ai::content_hash(v), h5ai::content_hash(w));
+
+  // ... but not the same shape
+  w.slab.count = w.L_tot = {2, 3};
+  EXPECT_NE(h5ai::content_hash(v), h5ai::content_hash(w));
+
+  b[5] = 0;
+  w.slab.count = w.L_tot = {3, 2};
+  EXPECT_NE(h5ai::content_hash(v), h5ai::content_hash(w));
+}
+
+TEST(H5, SkipUnchanged) {
+
+  std::vector<double> v(1000), v2;
+  std::iota(v.begin(), v.end(), 0.0);
+  std::vector<dcomplex> z(10, dcomplex{1, -1});
+
+  h5::file file{"test_content_hash.h5", 'w'};
+  h5::group grp{file};
+  auto p           = grp.get_write_policy();
+  p.skip_unchanged = true;
+  grp.set_write_policy(p);
+
+  for (int it = 0; it < 5; ++it) {
+    h5::write(grp, "v", v);
+    h5::write(grp, "z", z);
+    h5::write(grp, "n", 3);
+    h5::write(grp, "it", it);
+  }
+  h5::read(grp, "v", v2);
+  EXPECT_EQ(v, v2);
+  EXPECT_EQ(h5::read<std::vector<dcomplex>>(grp, "z"), z);
+  EXPECT_EQ(h5::read<int>(grp, "it"), 4);
+
+  // A change of content, type or shape is written
+  v[10] = -1;
+  h5::write(grp, "v", v);
+  h5::read(grp, "v", v2);
+  EXPECT_EQ(v2[10], -1);
+  h5::write(grp, "n", 3.0);
+  EXPECT_EQ(h5::read<double>(grp, "n"), 3.0);
+  v.resize(10);
+  h5::write(grp, "v", v);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v"), v);
+
+  // The same bytes, but real instead of complex
+  std::vector<double> r(20, 0);
+  for (int i = 0; i < 10; ++i) {
+    r[2 * i]     = 1;
+    r[2 * i + 1] = -1;
+  }
+  h5ai::h5_array_view av{h5::hdf5_type<double>(), r.data(), 2, false};
+  av.slab.count = av.L_tot = {10, 2};
+  h5ai::write(grp, "z", av, true);
+  EXPECT_FALSE(h5ai::get_h5_lengths_type(grp, "z").has_complex_attribute);
+
+  auto c = file.get_io_counters();
+#ifdef H5_WITH_INSTRUMENTATION
+  // v and z 4 times each, n 4 times
+  EXPECT_EQ(c.writes_skipped, 12);
+#else
+  EXPECT_EQ(c.writes_skipped, 0);
+#endif
+}
+
+TEST(H5, SkipUnchangedTrace) {
+
+  std::vector<std::string> skipped;
+  h5::instrumentation::set_trace_hook([&skipped](h5::instrumentation::event const &e) {
+    if (e.op == h5::instrumentation::op_t::write_skipped) skipped.push_back(e.key);
+  });
+  {
+    h5::file file{"test_content_hash_trace.h5", 'w'};
+    h5::group grp{file};
+    auto p           = grp.get_write_policy();
+    p.skip_unchanged = true;
+    grp.set_write_policy(p);
+    for (int it = 0; it < 2; ++it) {
+      h5::write(grp, "fixed", std::vector<int>{1, 2, 3});
+      h5::write(grp, "changing", std::vector<int>{it, it});
+    }
+  }
+  h5::instrumentation::set_trace_hook({});
+
+#ifdef H5_WITH_INSTRUMENTATION
+  EXPECT_EQ(skipped, std::vector<std::string>{"fixed"});
+#else
+  EXPECT_TRUE(skipped.empty());
+#endif
+}
+
+TEST(H5, SkipUnchangedAfterSlice) {
+
+  std::vector<double> v{1, 2, 3, 4}, w{9, 9};
+
+  h5::file file{"test_content_hash_slice.h5", 'w'};
+  h5::group grp{file};
+  auto p           = grp.get_write_policy();
+  p.skip_unchanged = true;
+  grp.set_write_policy(p);
+
+  // A slice changes the dataset : the same full write afterwards is not skipped
+  h5::write(grp, "v", v);
+  h5ai::h5_array_view wv{h5::hdf5_type<double>(), w.data(), 1, false};
+  wv.slab.count = wv.L_tot = {2};
+  h5ai::hyperslab sl(1, false);
+  sl.count = {2};
+  h5ai::write_slice(grp, "v", wv, h5ai::get_h5_lengths_type(grp, "v"), sl);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v"), (std::vector<double>{9, 9, 3, 4}));
+  h5::write(grp, "v", v);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v"), v);
+
+  // The slice removes the content hash stored by the full write
+  h5::write(grp, "w", w);
+  h5ai::write_slice(grp, "w", wv, h5ai::get_h5_lengths_type(grp, "w"), sl);
+  EXPECT_EQ(H5Aexists(grp.open_dataset("w"), "__xxh64__"), 0);
+}
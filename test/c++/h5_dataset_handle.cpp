@@ -0,0 +1,95 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+#include <span>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, DatasetHandle) {
+
+  std::vector<double> a(6 * 5);
+  std::iota(a.begin(), a.end(), 0.0);
+  h5::file file{"test_dataset_handle.h5", 'w'};
+  h5::group grp{file};
+  h5ai::h5_array_view v{h5::hdf5_type<double>(), a.data(), 2, false};
+  v.slab.count = v.L_tot = {6, 5};
+  h5ai::write(grp, "a", v, true);
+
+  auto d = grp.open_dataset_handle<double>("a");
+  EXPECT_EQ(d.shape(), (h5::v_t{6, 5}));
+  EXPECT_EQ(d.rank(), 2);
+  EXPECT_EQ(d.size(), 30);
+  EXPECT_FALSE(d.is_complex());
+  EXPECT_EQ(d.read(), a);
+
+  // A block, every second row, a column
+  EXPECT_EQ(d.read_slice({1, 1}, {2, 3}), (std::vector<double>{6, 7, 8, 11, 12, 13}));
+  EXPECT_EQ(d.read_slice({0, 4}, {3, 1}, {2, 1}), (std::vector<double>{4, 14, 24}));
+
+  // Into a span, of the size of the slice
+  std::vector<double> b(5);
+  d.read_slice_into(b, {5, 0}, {1, 5});
+  EXPECT_EQ(b, (std::vector<double>{25, 26, 27, 28, 29}));
+  EXPECT_THROW(d.read_slice_into(b, {0, 0}, {2, 5}), std::runtime_error);
+  EXPECT_THROW(d.read_into(b), std::runtime_error);
+
+  // Errors : rank, bounds
+  EXPECT_THROW(d.read_slice({0}, {1}), std::runtime_error);
+  EXPECT_THROW(d.read_slice({5, 0}, {2, 5}), std::runtime_error);
+
+  // Overwrite a row
+  std::vector<double> row(5, -1.0);
+  d.write_slice(row, {2, 0}, {1, 5});
+  auto c = d.read();
+  EXPECT_EQ(c[9], 9.0);
+  EXPECT_EQ(c[10], -1.0);
+  EXPECT_EQ(c[14], -1.0);
+  EXPECT_EQ(c[15], 15.0);
+
+  // Read as another type
+  auto df = grp.open_dataset_handle<float>("a", h5::access_hint::sequential);
+  EXPECT_EQ(df.read_slice({0, 0}, {1, 2}), (std::vector<float>{0, 1}));
+  auto dz = grp.open_dataset_handle<dcomplex>("a");
+  EXPECT_EQ(dz.read_slice({1, 0}, {1, 2}), (std::vector<dcomplex>{5, 6}));
+}
+
+TEST(H5, DatasetHandleComplex) {
+
+  long n0 = 4, n1 = 3;
+  std::vector<dcomplex> z(n0 * n1);
+  for (size_t i = 0; i < z.size(); ++i) z[i] = dcomplex(i, -i);
+
+  {
+    // Create the empty dataset, then fill it one row at a time
+    h5::file file{"test_dataset_handle_complex.h5", 'w'};
+    h5::group grp{file};
+    auto d = grp.create_dataset_handle<dcomplex>("z", {h5::hsize_t(n0), h5::hsize_t(n1)}, false);
+    EXPECT_TRUE(d.is_complex());
+    EXPECT_EQ(d.shape(), (h5::v_t{4, 3}));
+    for (long i = 0; i < n0; ++i) d.write_slice(std::span{z}.subspan(i * n1, n1), {h5::hsize_t(i), 0}, {1, h5::hsize_t(n1)});
+  }
+
+  h5::file file{"test_dataset_handle_complex.h5", 'r'};
+  h5::group grp{file};
+  auto d = grp.open_dataset_handle<dcomplex>("z");
+  EXPECT_EQ(d.read(), z);
+  EXPECT_EQ(d.read_slice({1, 2}, {2, 1}), (std::vector<dcomplex>{z[5], z[8]}));
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace h5ai = h5::array_interface;
+
+// A copier for a "device" which is in fact the host memory, recording its calls
+struct recording_copier {
+  std::atomic<int> n_to_host = 0, n_to_device = 0, n_buffers = 0, n_on_main_thread = 0;
+  std::thread::id main_thread = std::this_thread::get_id();
+
+  h5ai::device_copier make() {
+    auto on_main = [this] {
+      if (std::this_thread::get_id() == main_thread) ++n_on_main_thread;
+    };
+    return {[this, on_main](void *host, void const *device, std::size_t bytes) {
+              on_main();
+              ++n_to_host;
+              std::memcpy(host, device, bytes);
+            },
+            [this, on_main](void *device, void const *host, std::size_t bytes) {
+              on_main();
+              ++n_to_device;
+              std::memcpy(device, host, bytes);
+            },
+            [this](std::size_t bytes) {
+              ++n_buffers;
+              return ::operator new(bytes);
+            },
+            [this](void *p) {
+              --n_buffers;
+              ::operator delete(p);
+            }};
+  }
+};
+
+TEST(H5, DeviceStagedIO) {
+
+  long n0 = 101, n1 = 7;
+  std::vector<double> a(n0 * n1);
+  std::iota(a.begin(), a.end(), 0.0);
+  std::vector<dcomplex> z(n0 * n1);
+  for (int i = 0; i < z.size(); ++i) z[i] = dcomplex(i, -i);
+
+  recording_copier rc;
+  auto c = rc.make();
+  h5::v_t lengths{h5::hsize_t(n0), h5::hsize_t(n1)};
+
+  // Blocks of 10 rows : 11 blocks, the last one of a single row
+  std::size_t block_bytes = 10 * n1 * sizeof(double);
+  {
+    h5::file file{"test_device.h5", 'w'};
+    h5ai::write_from_device(file, "a", {h5::hdf5_type<double>(), a.data(), lengths, false}, c, true, block_bytes);
+    h5ai::write_from_device(file, "z", {h5::hdf5_type<double>(), z.data(), lengths, true}, c, false, 2 * block_bytes);
+  }
+  EXPECT_EQ(rc.n_to_host, 22);
+  EXPECT_EQ(rc.n_on_main_thread, 0);
+  EXPECT_EQ(rc.n_buffers, 0);
+
+  h5::file file{"test_device.h5", 'r'};
+  h5::group grp{file};
+  EXPECT_EQ(h5ai::get_h5_lengths_type(grp, "a").lengths, lengths);
+
+  std::vector<double> b(n0 * n1, 0);
+  h5ai::read_to_device(grp, "a", {h5::hdf5_type<double>(), b.data(), lengths, false}, c, block_bytes);
+  EXPECT_EQ(a, b);
+  std::vector<dcomplex> z2(n0 * n1);
+  h5ai::read_to_device(grp, "z", {h5::hdf5_type<double>(), z2.data(), lengths, true}, c, 2 * block_bytes);
+  EXPECT_EQ(z, z2);
+  EXPECT_EQ(rc.n_to_device, 22);
+  EXPECT_EQ(rc.n_on_main_thread, 0);
+  EXPECT_EQ(rc.n_buffers, 0);
+
+  // A single block, and the other shapes
+  std::vector<double> d(n0 * n1, 0);
+  h5ai::read_to_device(grp, "a", {h5::hdf5_type<double>(), d.data(), lengths, false}, h5ai::host_copier());
+  EXPECT_EQ(a, d);
+  EXPECT_THROW(h5ai::read_to_device(grp, "a", {h5::hdf5_type<double>(), d.data(), {h5::hsize_t(n1), h5::hsize_t(n0)}, false}, c),
+               std::runtime_error);
+  EXPECT_THROW(h5ai::read_to_device(grp, "z", {h5::hdf5_type<double>(), d.data(), lengths, false}, c), std::runtime_error);
+}
+
+TEST(H5, DeviceStagedIOEmpty) {
+
+  h5::file file{"test_device_empty.h5", 'w'};
+  recording_copier rc;
+  std::vector<double> a;
+  h5ai::write_from_device(file, "a", {h5::hdf5_type<double>(), a.data(), {0, 3}, false}, rc.make(), true);
+  EXPECT_EQ(h5ai::get_h5_lengths_type(file, "a").lengths, (h5::v_t{0, 3}));
+  h5ai::read_to_device(file, "a", {h5::hdf5_type<double>(), a.data(), {0, 3}, false}, rc.make());
+  EXPECT_EQ(rc.n_to_host + rc.n_to_device, 0);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <map>
+#include <vector>
+#include <numeric>
+
+// size of the file on disk
+long file_size(std::string const &name) {
+  h5::file f{name, 'r'};
+  hsize_t size = 0;
+  H5Fget_filesize(f, &size);
+  return long(size);
+}
+
+// A service writes its data, and the next run unlinks it
+void write_data(std::string const &name, h5::file_options const &opts, int it) {
+  h5::file f{name, 'a', opts};
+  h5::group top{f};
+  auto g = top.create_group("data", true);
+  std::vector<double> v(100000, double(it));
+  h5::array_interface::h5_array_view av{h5::hdf5_type<double>(), v.data(), 1, false};
+  av.slab.count = av.L_tot = {v.size()};
+  h5::array_interface::write(g, "v", av, false);
+  auto n = std::to_string(it);
+  h5::write(top, "tail" + n, it);
+}
+
+void unlink_data(std::string const &name, h5::file_options const &opts) {
+  h5::file f{name, 'a', opts};
+  h5::group{f}.unlink("data");
+}
+
+TEST(H5, FileCompact) {
+
+  std::vector<double> a(1000);
+  std::iota(a.begin(), a.end(), 0.0);
+  std::map<std::string, int> m = {{"x", 1}, {"y", 2}};
+  { h5::file f{"test_file_compact.h5", 'w'}; }
+  for (int it = 0; it < 5; ++it) {
+    write_data("test_file_compact.h5", {}, it);
+    if (it < 4) unlink_data("test_file_compact.h5", {});
+  }
+  {
+    h5::file f{"test_file_compact.h5", 'a'};
+    h5::group top{f};
+    h5::write(top, "a", a);
+    h5::write(top, "m", m);
+    h5::h5_write_attribute(top, "version", "1.2");
+    top.create_softlink("data/v", "link");
+    auto g = top.create_group("g");
+    H5Lcreate_hard(top, "data/v", top, "hard", H5P_DEFAULT, H5P_DEFAULT);
+    H5Lcreate_hard(top, "data/v", g, "hard", H5P_DEFAULT, H5P_DEFAULT);
+    f.compact("test_file_compact_packed.h5");
+  }
+
+  // The space of the previous runs is not copied
+  EXPECT_GT(file_size("test_file_compact.h5"), 5 * 100000 * sizeof(double));
+  EXPECT_LT(file_size("test_file_compact_packed.h5"), 2 * 100000 * sizeof(double));
+
+  h5::file f{"test_file_compact_packed.h5", 'r'};
+  h5::group top{f};
+  EXPECT_EQ(h5::read<std::vector<double>>(top, "a"), a);
+  EXPECT_EQ((h5::read<std::map<std::string, int>>(top, "m")), m);
+  EXPECT_EQ(h5::read<int>(top, "tail2"), 2);
+  EXPECT_EQ(h5::read<std::vector<double>>(top, "data/v"), std::vector<double>(100000, 4.0));
+  EXPECT_EQ(h5::read<std::vector<double>>(top, "link")[0], 4.0);
+  EXPECT_EQ(h5::h5_read_attribute<std::string>(top, "version"), "1.2");
+  EXPECT_EQ(h5::read_hdf5_format(top.open_group("m")), "Dict");
+
+  // An object with several hard links is copied once
+  EXPECT_EQ(header_address(top, "hard"), header_address(top, "data/v"));
+  EXPECT_EQ(header_address(top, "g/hard"), header_address(top, "data/v"));
+
+  EXPECT_THROW(f.compact(f.name()), std::runtime_error);
+}
+
+TEST(H5, PersistFreeSpace) {
+
+  // The space of the unlinked group is reused after the file is reopened
+  h5::file_options opts;
+  opts.persist_free_space = true;
+  for (auto [name, o] : {std::pair{"test_free_space.h5", h5::file_options{}}, std::pair{"test_free_space_persist.h5", opts}}) {
+    { h5::file f{name, 'w', o}; }
+    for (int it = 0; it < 6; ++it) {
+      write_data(name, o, it);
+      unlink_data(name, o);
+    }
+    write_data(name, o, 6);
+  }
+  EXPECT_GT(file_size("test_free_space.h5"), 6 * 100000 * sizeof(double));
+  EXPECT_LT(file_size("test_free_space_persist.h5"), 2 * 100000 * sizeof(double));
+
+  h5::file f{"test_free_space_persist.h5", 'r'};
+  EXPECT_EQ(h5::read<std::vector<double>>(f, "data/v")[0], 6.0);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+
+TEST(H5, FileOptions) {
+
+  h5::file_options opts;
+  opts.latest_format        = true;
+  opts.alignment            = 4096;
+  opts.alignment_threshold  = 1024;
+  opts.metadata_cache_size  = 8 << 20;
+  opts.paged_aggregation    = true;
+  opts.file_space_page_size = 8192;
+  opts.page_buffer_size     = 1 << 20;
+
+  std::vector<double> v(10000, 1.0), w;
+  {
+    h5::file file{"test_file_options.h5", 'w', opts};
+    h5::group grp{file};
+    h5::array_interface::h5_array_view av{h5::hdf5_type<double>(), v.data(), 1, false};
+    av.slab.count[0] = av.L_tot[0] = v.size();
+    h5::array_interface::write(grp, "v", av, false);
+    h5::write(grp, "x", 1);
+
+    // access properties
+    H5AC_cache_config_t config;
+    config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+    ASSERT_GE(H5Fget_mdc_config(file, &config), 0);
+    EXPECT_EQ(config.max_size, opts.metadata_cache_size);
+
+    // the large dataset is aligned
+    auto ds = grp.open_dataset("v");
+    EXPECT_EQ(H5Dget_offset(ds) % opts.alignment, 0);
+  }
+
+  // creation properties are stored in the file, the page buffer requires them
+  h5::file file{"test_file_options.h5", 'r', opts};
+  h5::object fcpl = H5Fget_create_plist(file);
+  H5F_fspace_strategy_t strategy;
+  hbool_t persist;
+  hsize_t threshold, page_size;
+  H5Pget_file_space_strategy(fcpl, &strategy, &persist, &threshold);
+  H5Pget_file_space_page_size(fcpl, &page_size);
+  EXPECT_EQ(strategy, H5F_FSPACE_STRATEGY_PAGE);
+  EXPECT_EQ(page_size, opts.file_space_page_size);
+
+  h5::read(file, "v", w);
+  EXPECT_EQ(v, w);
+}
+
+TEST(H5, FileOptionsDefault) {
+  // The default options are the HDF5 defaults
+  {
+    h5::file file{"test_file_options_default.h5", 'w', h5::file_options{}};
+    h5::write(file, "x", 2);
+  }
+  h5::file file{"test_file_options_default.h5", 'r'};
+  EXPECT_EQ(h5::read<int>(file, "x"), 2);
+}
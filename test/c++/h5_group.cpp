@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <map>
+#include <vector>
+
+TEST(H5, GroupElements) {
+
+  h5::file file{"test_group.h5", 'w'};
+  h5::group grp{file};
+
+  h5::write(grp, "a", 1.0);
+  h5::write(grp, "b", std::vector<int>{1, 2, 3});
+  grp.create_group("c");
+  grp.create_softlink("b", "d");
+
+  EXPECT_EQ(grp.size(), 4);
+  EXPECT_EQ(grp.get_all_dataset_names(), (std::vector<std::string>{"a", "b", "d"}));
+  EXPECT_EQ(grp.get_all_subgroup_names(), (std::vector<std::string>{"c"}));
+  EXPECT_EQ(grp.get_all_subgroup_dataset_names(), (std::vector<std::string>{"a", "b", "c", "d"}));
+
+  auto elements = grp.get_all_elements(true);
+  ASSERT_EQ(elements.size(), 4);
+  EXPECT_EQ(elements[0].name, "a");
+  EXPECT_TRUE(elements[0].is_dataset());
+  EXPECT_TRUE(elements[0].lengths.empty());
+  EXPECT_TRUE(h5::hdf5_type_equal(elements[0].ty, h5::hdf5_type<double>()));
+  EXPECT_EQ(elements[1].lengths, (std::vector<h5::hsize_t>{3}));
+  EXPECT_TRUE(h5::hdf5_type_equal(elements[1].ty, h5::hdf5_type<int>()));
+  EXPECT_TRUE(elements[2].is_group());
+  EXPECT_FALSE(elements[2].ty.is_valid());
+  EXPECT_EQ(elements[3].lengths, (std::vector<h5::hsize_t>{3}));
+
+  // Without the dataset info
+  EXPECT_FALSE(grp.get_all_elements()[1].ty.is_valid());
+}
+
+TEST(H5, GroupElementsFormat) {
+
+  h5::file file{"test_group_format.h5", 'w'};
+  h5::group grp{file};
+
+  h5::write(grp, "m", std::map<std::string, int>{{"x", 1}});
+  h5::write(grp, "z", std::vector<dcomplex>{{1, 2}});
+  h5::write(grp, "v", std::vector<double>{1, 2});
+  grp.create_group("plain");
+
+  // The tags of all the elements, with the listing
+  auto elements = grp.get_all_elements(false, true);
+  ASSERT_EQ(elements.size(), 4);
+  EXPECT_EQ(elements[0].name, "m");
+  EXPECT_EQ(elements[0].format, "Dict");
+  EXPECT_EQ(elements[1].format, "");
+  EXPECT_EQ(elements[2].name, "v");
+  EXPECT_FALSE(elements[2].has_complex_attribute);
+  EXPECT_EQ(elements[3].name, "z");
+  EXPECT_TRUE(elements[3].has_complex_attribute);
+  EXPECT_EQ(grp.get_all_elements()[0].format, "");
+
+  // The tags are fixed size strings, stored in the object header
+  auto m = grp.open_group("m");
+  {
+    h5::attribute attr = H5Aopen(m, "Format", H5P_DEFAULT);
+    h5::datatype ty    = H5Aget_type(attr);
+    EXPECT_FALSE(H5Tis_variable_str(ty));
+  }
+  EXPECT_EQ(h5::read_hdf5_format(m), "Dict");
+
+  // ... and replaced when written again
+  h5::write_hdf5_format_as_string(m, "Other");
+  EXPECT_EQ(h5::read_hdf5_format(m), "Other");
+}
+
+TEST(H5, GroupElementsBadFormat) {
+
+  h5::file file{"test_group_bad_format.h5", 'w'};
+  h5::group grp{file};
+  h5::write(grp, "a", 1.0);
+  auto b = grp.create_group("b");
+  {
+    // A Format attribute which is not a scalar string
+    hsize_t dims[1]      = {2};
+    h5::dataspace dspace = H5Screate_simple(1, dims, nullptr);
+    h5::attribute attr   = H5Acreate2(b, "Format", H5T_NATIVE_INT, dspace, H5P_DEFAULT, H5P_DEFAULT);
+  }
+
+  // It does not stop the listing of the other elements
+  auto elements = grp.get_all_elements(false, true);
+  ASSERT_EQ(elements.size(), 2);
+  EXPECT_FALSE(elements[0].format_unread);
+  EXPECT_EQ(elements[1].format, "");
+  EXPECT_TRUE(elements[1].format_unread);
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+TEST(H5, IoCounters) {
+
+  std::vector<double> v(100, 1.0), w;
+
+  h5::file file;
+  h5::group grp{file};
+  h5::write(grp, "v", v);
+  h5::read(grp, "v", w);
+  (void)grp.get_all_dataset_names();
+
+  auto c = file.get_io_counters();
+#ifdef H5_WITH_INSTRUMENTATION
+  EXPECT_EQ(c.datasets_created, 1);
+  EXPECT_GE(c.datasets_opened, 1);
+  EXPECT_EQ(c.writes, 1);
+  EXPECT_EQ(c.reads, 1);
+  EXPECT_EQ(c.iterations, 1);
+  EXPECT_EQ(c.bytes_written, 800);
+  EXPECT_EQ(c.bytes_read, 800);
+  EXPECT_GT(c.write_seconds, 0);
+  EXPECT_GT(c.filter_seconds, 0); // the vector is compressed
+
+  // The counters are shared by the copies of the file
+  auto f2 = file;
+  f2.reset_io_counters();
+  EXPECT_EQ(file.get_io_counters().writes, 0);
+#else
+  EXPECT_EQ(c.writes, 0);
+  EXPECT_EQ(c.bytes_written, 0);
+#endif
+}
+
+TEST(H5, ChromeTrace) {
+
+  h5::instrumentation::set_trace_hook(h5::instrumentation::make_chrome_trace_hook("test_trace.json"));
+  {
+    h5::file file;
+    h5::write(file, "x", 1.0);
+    h5::write(file, R"(a"b\c)", 2.0);
+  }
+  h5::instrumentation::set_trace_hook({});
+
+  std::ifstream in{"test_trace.json"};
+  std::stringstream ss;
+  ss << in.rdbuf();
+  auto trace = ss.str();
+  EXPECT_EQ(trace.rfind("{\"traceEvents\": [", 0), 0);
+  EXPECT_NE(trace.find("]}"), std::string::npos);
+#ifdef H5_WITH_INSTRUMENTATION
+  EXPECT_NE(trace.find(R"("name": "x", "cat": "write")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("name": "a\"b\\c", "cat": "write")"), std::string::npos);
+#endif
+}
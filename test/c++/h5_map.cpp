@@ -126,3 +126,90 @@ TEST(H5, Map_OldVsNew) {
   // compare
   EXPECT_EQ(m, mm);
 }
+
+TEST(H5, Map_Columnar) {
+
+  std::map<long, double> m;
+  for (long i = 0; i < 1000; ++i) m.emplace(3 * i - 500, 0.5 * i);
+  std::map<std::string, dcomplex> mz = {{"a", {1, 2}}, {"b", {3, -4}}};
+  std::map<double, std::string> ms   = {{1.5, "one and a half"}, {-2, "minus two"}};
+
+  {
+    h5::file file{"test_map_columnar.h5", 'w'};
+    h5::group grp{file};
+    auto p       = grp.get_write_policy();
+    p.map_layout = h5::write_policy::map_layout_t::columnar;
+    grp.set_write_policy(p);
+    h5_write(grp, "m", m);
+    h5_write(grp, "mz", mz);
+    h5_write(grp, "ms", ms);
+
+    // Two datasets, in the order of the map
+    auto gr = grp.open_group("m");
+    EXPECT_EQ(h5::read_hdf5_format(gr), "ColumnarDict");
+    EXPECT_EQ(gr.get_all_dataset_names(), (std::vector<std::string>{"keys", "values"}));
+    auto keys = h5::read<std::vector<long>>(gr, "keys");
+    EXPECT_EQ(keys.size(), 1000);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+  }
+
+  std::map<long, double> mm;
+  std::map<std::string, dcomplex> mmz;
+  std::map<double, std::string> mms;
+  {
+    h5::file file{"test_map_columnar.h5", 'r'};
+    h5::group grp{file};
+    h5_read(grp, "m", mm);
+    h5_read(grp, "mz", mmz);
+    h5_read(grp, "ms", mms);
+  }
+  EXPECT_EQ(m, mm);
+  EXPECT_EQ(mz, mmz);
+  EXPECT_EQ(ms, mms);
+}
+
+TEST(H5, Map_DefaultLayout) {
+
+  // By default, the format read by older versions : one subgroup per element
+  std::map<int, double> m = {{2, 1.5}, {-1, 3.0}};
+  {
+    h5::file file{"test_map_default_layout.h5", 'w'};
+    h5::group grp{file};
+    h5_write(grp, "m", m);
+    auto gr = grp.open_group("m");
+    EXPECT_EQ(h5::read_hdf5_format(gr), "Dict");
+    EXPECT_EQ(gr.get_all_subgroup_names(), (std::vector<std::string>{"0", "1"}));
+    EXPECT_EQ(h5::read<int>(gr.open_group("0"), "key"), -1);
+  }
+
+  std::map<int, double> mm;
+  h5::file file{"test_map_default_layout.h5", 'r'};
+  h5_read(h5::group{file}, "m", mm);
+  EXPECT_EQ(m, mm);
+}
+
+TEST(H5, Map_ColumnarReadsOld) {
+
+  // A map of arithmetic types in the format of one subgroup per element
+  std::map<int, double> m = {{2, 1.5}, {-1, 3.0}};
+  {
+    h5::file file{"test_map_columnar_old.h5", 'w'};
+    h5::group grp{file};
+    auto gr = grp.create_group("m");
+    write_hdf5_format(gr, m);
+    int indx = 0;
+    for (auto const &[key, val] : m) {
+      auto element_gr = gr.create_group(std::to_string(indx++));
+      h5_write(element_gr, "key", key);
+      h5_write(element_gr, "val", val);
+    }
+  }
+
+  std::map<int, double> mm;
+  {
+    h5::file file{"test_map_columnar_old.h5", 'r'};
+    h5::group grp{file};
+    h5_read(grp, "m", mm);
+  }
+  EXPECT_EQ(m, mm);
+}
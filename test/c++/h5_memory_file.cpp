@@ -79,3 +79,40 @@ TEST(H5, MemoryFile) {
     EXPECT_EQ(vec_str, vec_str_read);
   }
 }
+
+TEST(H5, MemoryFileReleaseBuffer) {
+
+  auto vec_dbl = std::vector<double>(1000, 3.0);
+
+  std::vector<std::byte> buf_copy, buf;
+  {
+    auto f = h5::file{size_t{1} << 20};
+    h5::write(f, "vec_dbl", vec_dbl);
+
+    // The file is still used by the group
+    auto g = h5::group{f};
+    EXPECT_THROW((void)f.release_buffer(), std::runtime_error);
+  }
+  {
+    auto f = h5::file{};
+    h5::write(f, "vec_dbl", vec_dbl);
+    buf_copy = f.as_buffer();
+    buf      = f.release_buffer();
+    EXPECT_FALSE(f.is_valid());
+  }
+  EXPECT_EQ(buf, buf_copy);
+
+  // Adopt the buffer, and write more in it
+  auto f = h5::file{std::move(buf)};
+  h5::write(f, "vec_int", std::vector<int>{1, 2, 3});
+  std::vector<double> vec_dbl_read;
+  h5::read(f, "vec_dbl", vec_dbl_read);
+  EXPECT_EQ(vec_dbl, vec_dbl_read);
+
+  auto buf2 = f.release_buffer();
+  EXPECT_GT(buf2.size(), buf_copy.size());
+
+  std::vector<int> vec_int_read;
+  h5::read(h5::file{buf2}, "vec_int", vec_int_read);
+  EXPECT_EQ(vec_int_read, (std::vector<int>{1, 2, 3}));
+}
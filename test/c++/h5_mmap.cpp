@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, MapDataset) {
+
+  std::vector<double> a(3 * 1000);
+  std::iota(a.begin(), a.end(), 0.0);
+  std::vector<std::complex<double>> z = {{1, 2}, {3, 4}};
+
+  {
+    h5::file file{"test_mmap.h5", 'w'};
+    h5::group grp{file};
+    h5ai::h5_array_view v{h5::hdf5_type<double>(), a.data(), 2, false};
+    v.slab.count = v.L_tot = {3, 1000};
+    h5ai::write(grp, "a", v, false);  // contiguous
+    h5ai::write(grp, "a_z", v, true); // compressed
+    h5ai::h5_array_view vz{h5::hdf5_type<std::complex<double>>(), z.data(), 1, true};
+    vz.slab.count[0] = vz.L_tot[0] = 2;
+    h5ai::write(grp, "z", vz, false);
+    h5::write(grp, "e", std::vector<int>{});
+  }
+
+  {
+    // Not opened read-only
+    h5::file file{"test_mmap.h5", 'a'};
+    h5::group grp{file};
+    EXPECT_FALSE(h5ai::is_mappable(grp, "a"));
+    EXPECT_THROW(h5ai::map_dataset(grp, "a"), std::runtime_error);
+  }
+
+  h5ai::mapped_dataset m;
+  {
+    h5::file file{"test_mmap.h5", 'r'};
+    h5::group grp{file};
+    EXPECT_TRUE(h5ai::is_mappable(grp, "a"));
+    EXPECT_FALSE(h5ai::is_mappable(grp, "a_z"));
+    EXPECT_THROW(h5ai::map_dataset(grp, "a_z"), std::runtime_error);
+
+    auto mz = h5ai::map_dataset(grp, "z");
+    EXPECT_TRUE(mz.lt.has_complex_attribute);
+    EXPECT_EQ(mz.lt.lengths, (h5::v_t{2, 2}));
+    auto const *pz = static_cast<double const *>(mz.data);
+    EXPECT_EQ(std::vector<double>(pz, pz + 4), (std::vector<double>{1, 2, 3, 4}));
+
+    auto me = h5ai::map_dataset(grp, "e");
+    EXPECT_EQ(me.data, nullptr);
+    EXPECT_EQ(me.lt.lengths, (h5::v_t{0}));
+
+    m = h5ai::map_dataset(grp, "a");
+  }
+
+  // The mapping outlives the file
+  EXPECT_EQ(m.lt.lengths, (h5::v_t{3, 1000}));
+  auto const *p = static_cast<double const *>(m.data);
+  EXPECT_EQ(std::vector<double>(p, p + a.size()), a);
+}
+
+TEST(H5, MapDatasetWithUserblock) {
+
+  std::vector<double> a{1, 2, 3, 4};
+
+  {
+    // A file with a user block, written directly with HDF5
+    hid_t fcpl = H5Pcreate(H5P_FILE_CREATE);
+    H5Pset_userblock(fcpl, 512);
+    hid_t fi = H5Fcreate("test_mmap_userblock.h5", H5F_ACC_TRUNC, fcpl, H5P_DEFAULT);
+    hsize_t dims[1] = {4};
+    hid_t sp        = H5Screate_simple(1, dims, nullptr);
+    hid_t ds        = H5Dcreate2(fi, "a", H5T_NATIVE_DOUBLE, sp, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Dwrite(ds, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, a.data());
+    H5Dclose(ds);
+    H5Sclose(sp);
+    H5Fclose(fi);
+    H5Pclose(fcpl);
+  }
+
+  h5::file file{"test_mmap_userblock.h5", 'r'};
+  h5::group grp{file};
+  ASSERT_TRUE(h5ai::is_mappable(grp, "a"));
+  auto m        = h5ai::map_dataset(grp, "a");
+  auto const *p = static_cast<double const *>(m.data);
+  EXPECT_EQ(std::vector<double>(p, p + 4), a);
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+// size of the file on disk after a flush
+long file_size(h5::file &f) {
+  f.flush();
+  hsize_t size = 0;
+  H5Fget_filesize(f, &size);
+  return long(size);
+}
+
+TEST(H5, InPlaceOverwrite) {
+
+  std::vector<double> v(10000);
+
+  h5::file file{"test_overwrite.h5", 'w'};
+  h5::group grp{file};
+  auto p               = grp.get_write_policy();
+  p.in_place_overwrite   = true;
+  p.contiguous_threshold = 1 << 20; // a compressed chunk may be reallocated when its compressed size changes
+  grp.set_write_policy(p);
+
+  // The same arrays written again and again : the file does not grow, the datasets are kept
+  long size = 0;
+  auto addr = haddr_t{};
+  for (int it = 0; it < 10; ++it) {
+    std::iota(v.begin(), v.end(), double(it));
+    h5::write(grp, "v", v);
+    h5::write(grp, "x", 1.5 * it);
+    h5::write(grp, "s", std::string{"iteration"});
+    if (it == 1) {
+      size = file_size(file);
+      addr = header_address(grp, "v");
+    }
+  }
+  EXPECT_EQ(file_size(file), size);
+  EXPECT_EQ(header_address(grp, "v"), addr);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v")[0], 9.0);
+  EXPECT_EQ(h5::read<double>(grp, "x"), 13.5);
+  EXPECT_EQ(h5::read<std::string>(grp, "s"), "iteration");
+
+  // Another shape or type : a new dataset
+  h5::write(grp, "v", std::vector<double>(5, 1.0));
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v"), std::vector<double>(5, 1.0));
+  h5::write(grp, "x", 3);
+  EXPECT_EQ(h5::read<int>(grp, "x"), 3);
+  h5::write(grp, "s", std::string{"longer string"});
+  EXPECT_EQ(h5::read<std::string>(grp, "s"), "longer string");
+
+  // The attributes are rewritten : a complex array overwritten by reals of the same shape is real
+  std::vector<dcomplex> z(3, dcomplex{1, 2});
+  h5::write(grp, "z", z);
+  EXPECT_TRUE(h5ai::get_h5_lengths_type(grp, "z").has_complex_attribute);
+  std::vector<double> r(6, 4.0);
+  h5ai::h5_array_view av{h5::hdf5_type<double>(), r.data(), 2, false};
+  av.slab.count = av.L_tot = {3, 2};
+  h5ai::write(grp, "z", av, true);
+  auto lt = h5ai::get_h5_lengths_type(grp, "z");
+  EXPECT_FALSE(lt.has_complex_attribute);
+  EXPECT_EQ(lt.lengths, (h5::v_t{3, 2}));
+}
+
+TEST(H5, InPlaceOverwriteFilterParameters) {
+
+  h5::file file{"test_overwrite_filter.h5", 'w'};
+  h5::group grp{file};
+  auto p             = grp.get_write_policy();
+  p.in_place_overwrite = true;
+  grp.set_write_policy(p);
+
+  // the deflate level of the dataset
+  auto level = [&]() {
+    auto ds           = grp.open_dataset("v");
+    hid_t dcpl        = H5Dget_create_plist(ds);
+    unsigned flags    = 0, cd[1] = {0};
+    size_t n_cd       = 1;
+    H5Pget_filter_by_id2(dcpl, H5Z_FILTER_DEFLATE, &flags, &n_cd, cd, 0, nullptr, nullptr);
+    H5Pclose(dcpl);
+    return cd[0];
+  };
+
+  std::vector<double> v(10000, 1.0);
+  h5::write(grp, "v", v);
+  EXPECT_EQ(level(), 1u);
+
+  // Another deflate level : a new dataset, with the new level
+  p.deflate_level = 9;
+  grp.set_write_policy(p);
+  h5::write(grp, "v", v);
+  EXPECT_EQ(level(), 9u);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v"), v);
+}
+
+TEST(H5, OverwriteDefault) {
+
+  // Without the policy, the dataset is unlinked and created again
+  h5::file file{"test_overwrite_default.h5", 'w'};
+  h5::group grp{file};
+  h5::write(grp, "v", std::vector<double>(10000, 1.0));
+  long size = file_size(file);
+  h5::write(grp, "v", std::vector<double>(10000, 2.0));
+  EXPECT_GT(file_size(file), size);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "v")[0], 2.0);
+}
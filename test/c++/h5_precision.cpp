@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <cmath>
+
+namespace h5ai = h5::array_interface;
+
+using precision_t = h5::write_policy::precision_t;
+
+// size in bytes of the type of the dataset g[name] in the file
+size_t file_type_size(h5::group const &g, std::string const &name) { return H5Tget_size(h5ai::get_h5_lengths_type(g, name).ty); }
+
+TEST(H5, PrecisionFloat32) {
+
+  std::vector<double> v(1000);
+  for (int i = 0; i < v.size(); ++i) v[i] = std::sin(0.1 * i) / 3;
+  std::vector<dcomplex> z(100);
+  for (int i = 0; i < z.size(); ++i) z[i] = dcomplex(v[i], -v[i + 1]);
+  std::vector<int> l(100, 7);
+
+  h5::file file{"test_precision.h5", 'w'};
+  h5::group grp{file};
+  auto p      = grp.get_write_policy();
+  p.precision = precision_t::float32;
+  grp.set_write_policy(p);
+
+  h5::write(grp, "v", v);
+  h5::write(grp, "z", z);
+  h5::write(grp, "l", l);
+  h5::write(grp, "x", 1.0 / 3);
+  h5::write(grp, "f", std::vector<float>(10, 0.5f));
+
+  // Only the compressed double arrays are stored in single precision
+  EXPECT_EQ(file_type_size(grp, "v"), 4);
+  EXPECT_EQ(file_type_size(grp, "z"), 4);
+  EXPECT_EQ(file_type_size(grp, "l"), sizeof(int));
+  EXPECT_EQ(file_type_size(grp, "x"), 8);
+  EXPECT_EQ(file_type_size(grp, "f"), 4);
+
+  // ... and read back as double, to single precision
+  auto v2 = h5::read<std::vector<double>>(grp, "v");
+  ASSERT_EQ(v2.size(), v.size());
+  for (int i = 0; i < v.size(); ++i) EXPECT_EQ(v2[i], double(float(v[i])));
+  auto z2 = h5::read<std::vector<dcomplex>>(grp, "z");
+  ASSERT_EQ(z2.size(), z.size());
+  for (int i = 0; i < z.size(); ++i) {
+    EXPECT_EQ(z2[i].real(), double(float(z[i].real())));
+    EXPECT_EQ(z2[i].imag(), double(float(z[i].imag())));
+  }
+  EXPECT_EQ(h5::read<double>(grp, "x"), 1.0 / 3);
+
+  // Incremental mode : the dataset in single precision is unchanged, it is not created again
+  p.skip_unchanged = true;
+  grp.set_write_policy(p);
+  h5::write(grp, "v", v);
+  auto addr = header_address(grp, "v");
+  h5::write(grp, "v", v);
+  EXPECT_EQ(header_address(grp, "v"), addr);
+}
+
+TEST(H5, PrecisionZfp) {
+
+  std::vector<double> v(1000);
+  for (int i = 0; i < v.size(); ++i) v[i] = std::cos(0.01 * i);
+
+  h5::file file{"test_precision_zfp.h5", 'w'};
+  h5::group grp{file};
+  auto p         = grp.get_write_policy();
+  p.precision    = precision_t::zfp;
+  p.zfp_accuracy = 1e-6;
+  grp.set_write_policy(p);
+  h5::write(grp, "v", v);
+
+  // With the ZFP plugin : double in the file, within the accuracy. Otherwise, single precision.
+  bool has_zfp = H5Zfilter_avail(h5::write_policy::filter_zfp) > 0;
+  EXPECT_EQ(file_type_size(grp, "v"), has_zfp ? 8 : 4);
+  auto v2 = h5::read<std::vector<double>>(grp, "v");
+  ASSERT_EQ(v2.size(), v.size());
+  for (int i = 0; i < v.size(); ++i) EXPECT_NEAR(v2[i], v[i], has_zfp ? 1e-6 : 1e-7);
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, ReadBatch) {
+
+  std::vector<std::vector<double>> data(6);
+  for (int i = 0; i < 6; ++i) {
+    data[i].resize(100 + 10 * i);
+    std::iota(data[i].begin(), data[i].end(), 1000.0 * i);
+  }
+
+  h5::file file{"test_read_batch.h5", 'w'};
+  h5::group grp{file};
+  // Contiguous datasets, written in the order 0, 1, ..., then a chunked one and a scalar
+  for (int i = 0; i < 4; ++i) {
+    auto n = std::to_string(i);
+    h5ai::write(grp, "c" + n, make_view_2d(data[i].data(), 1, data[i].size()), false);
+  }
+  h5ai::write(grp, "chunked", make_view_2d(data[4].data(), 1, data[4].size()), true);
+  h5::write(grp, "x", 2.5);
+
+  // Requested in another order, and a slice
+  std::vector<std::vector<double>> out(6);
+  for (int i = 0; i < 5; ++i) out[i].resize(data[i].size());
+  out[5].resize(3);
+  h5ai::hyperslab sl(2, false);
+  sl.offset = {0, 10};
+  sl.count  = {1, 3};
+  double x  = 0;
+  h5ai::h5_array_view vx{h5::hdf5_type<double>(), &x, 0, false};
+  std::vector<h5ai::read_request> reqs = {
+     {"x", vx},
+     {"c3", make_view_2d(out[3].data(), 1, out[3].size())},
+     {"chunked", make_view_2d(out[4].data(), 1, out[4].size())},
+     {"c1", make_view_2d(out[1].data(), 1, out[1].size())},
+     {"c0", make_view_2d(out[0].data(), 1, out[0].size())},
+     {"c2", make_view_2d(out[2].data(), 1, out[2].size())},
+     {"c0", make_view_2d(out[5].data(), 1, 3), sl},
+  };
+
+  // The datasets in the order of the file
+  auto plan = h5ai::plan_read_batch(grp, reqs);
+  EXPECT_EQ(plan.lts.size(), reqs.size());
+  auto pos = [&](size_t i) { return std::find(plan.order.begin(), plan.order.end(), i) - plan.order.begin(); };
+  EXPECT_LT(pos(4), pos(3));
+  EXPECT_LT(pos(3), pos(5));
+  EXPECT_LT(pos(5), pos(1));
+  EXPECT_LT(pos(1), pos(2));
+  EXPECT_EQ(plan.order.back(), 0);
+
+  // The contiguous datasets are close : a single range. Without any gap, the ranges are exactly their data.
+  EXPECT_EQ(plan.ranges.size(), 1);
+  EXPECT_GE(plan.ranges[0].second, (100 + 110 + 120 + 130 + 1) * sizeof(double));
+  h5::hsize_t total = 0;
+  for (auto const &[offset, size] : h5ai::plan_read_batch(grp, reqs, 0).ranges) total += size;
+  EXPECT_EQ(total, (100 + 110 + 120 + 130 + 1) * sizeof(double));
+
+  for (bool readahead : {false, true}) {
+    for (auto &o : out) std::fill(o.begin(), o.end(), 0);
+    x = 0;
+    h5ai::read_batch(grp, reqs, {.readahead = readahead});
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(out[i], data[i]);
+    EXPECT_EQ(out[5], (std::vector<double>{10, 11, 12}));
+    EXPECT_EQ(x, 2.5);
+  }
+
+  // A missing dataset : nothing is read
+  reqs.push_back({"missing", vx});
+  x = 0;
+  EXPECT_THROW(h5ai::read_batch(grp, reqs), std::runtime_error);
+  EXPECT_EQ(x, 0);
+}
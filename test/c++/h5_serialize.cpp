@@ -20,6 +20,7 @@
 #include <h5/serialization.hpp>
 
 #include <array>
+#include <map>
 
 TEST(H5, Serialize) {
 
@@ -33,4 +34,49 @@ TEST(H5, Serialize) {
   // compare
   EXPECT_EQ(arr_str, arr_str_ser);
   EXPECT_EQ(arr_dbl, arr_dbl_ser);
+
+  // with a size hint, and adopting the buffer
+  auto vec_dbl     = std::vector<double>(100, 1.0);
+  auto vec_dbl_ser = h5::deserialize<std::vector<double>>(h5::serialize(vec_dbl, 1 << 16));
+  EXPECT_EQ(vec_dbl, vec_dbl_ser);
+}
+
+TEST(H5, SeveralMemoryFiles) {
+
+  // Several memory files, and files opened from the same buffer, at the same time
+  h5::file a, b;
+  h5::write(a, "x", 1);
+  h5::write(b, "x", 2);
+  auto buf = a.as_buffer();
+  h5::file c{buf}, d{buf};
+  EXPECT_EQ(h5::read<int>(b, "x"), 2);
+  EXPECT_EQ(h5::read<int>(c, "x"), 1);
+  EXPECT_EQ(h5::read<int>(d, "x"), 1);
+}
+
+TEST(H5, Serializer) {
+
+  h5::serializer ser;
+  std::vector<double> v(1000);
+
+  // The same buffer, of the same size, for the same-shaped objects
+  auto const &buf = ser(v);
+  auto *data      = buf.data();
+  auto size       = buf.size();
+  for (int i = 0; i < 10; ++i) {
+    v[i] = i;
+    auto const &b = ser(v);
+    EXPECT_EQ(b.data(), data);
+    EXPECT_EQ(b.size(), size);
+    EXPECT_EQ(h5::deserialize<std::vector<double>>(b), v);
+  }
+
+  // Other types
+  EXPECT_EQ(h5::deserialize<std::string>(ser(std::string{"abc"})), "abc");
+  auto m = std::map<std::string, int>{{"a", 1}, {"b", 2}};
+  for (int i = 0; i < 50; ++i) {
+    m["a"] = i;
+    EXPECT_EQ((h5::deserialize<std::map<std::string, int>>(ser(m))), m);
+  }
+  EXPECT_EQ(h5::deserialize<std::vector<double>>(ser(v)), v);
 }
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, ReadSlice) {
+
+  std::vector<double> a(4 * 5);
+  std::iota(a.begin(), a.end(), 0.0);
+
+  {
+    h5::file file{"test_slice.h5", 'w'};
+    h5ai::write(file, "a", make_view_2d(a.data(), 4, 5), true);
+  }
+
+  h5::file file{"test_slice.h5", 'r'};
+  h5::group grp{file};
+  auto lt = h5ai::get_h5_lengths_type(grp, "a");
+
+  // A 2x3 block at offset (1,1)
+  std::vector<double> b(2 * 3);
+  h5ai::hyperslab sl(2, false);
+  sl.offset = {1, 1};
+  sl.count  = {2, 3};
+  h5ai::read(grp, "a", make_view_2d(b.data(), 2, 3), lt, sl);
+  EXPECT_EQ(b, (std::vector<double>{6, 7, 8, 11, 12, 13}));
+
+  // Every second row, last column
+  std::vector<double> c(2);
+  sl.offset = {0, 4};
+  sl.stride = {2, 1};
+  sl.count  = {2, 1};
+  h5ai::read(grp, "a", make_view_2d(c.data(), 2, 1), lt, sl);
+  EXPECT_EQ(c, (std::vector<double>{4, 14}));
+
+  // Out of bounds
+  sl.offset = {3, 4};
+  sl.stride = {1, 1};
+  sl.count  = {2, 1};
+  EXPECT_THROW(h5ai::read(grp, "a", make_view_2d(c.data(), 2, 1), lt, sl), std::runtime_error);
+}
+
+TEST(H5, WriteSlice) {
+
+  std::vector<dcomplex> a(3 * 2);
+  for (int i = 0; i < a.size(); ++i) a[i] = dcomplex(i, -i);
+
+  {
+    h5::file file{"test_write_slice.h5", 'w'};
+    h5::group grp{file};
+
+    // Create the empty dataset, then fill it one row at a time
+    h5ai::create_dataset(grp, "a", {{3, 2, 2}, h5::hdf5_type<dcomplex>(), true}, false);
+    auto lt = h5ai::get_h5_lengths_type(grp, "a");
+    for (int i = 0; i < 3; ++i) {
+      h5ai::hyperslab sl(2, true);
+      sl.offset[0] = i;
+      sl.count     = {1, 2, 2};
+      h5ai::write_slice(grp, "a", make_view_2d(a.data() + 2 * i, 1, 2), lt, sl);
+    }
+  }
+
+  std::vector<dcomplex> b(3 * 2);
+  {
+    h5::file file{"test_write_slice.h5", 'r'};
+    h5::group grp{file};
+    h5ai::read(grp, "a", make_view_2d(b.data(), 3, 2), h5ai::get_h5_lengths_type(grp, "a"));
+  }
+  EXPECT_EQ(a, b);
+}
+
+TEST(H5, ReadOpenDataset) {
+
+  std::vector<double> a(2 * 3);
+  std::iota(a.begin(), a.end(), 0.0);
+
+  h5::file file{"test_read_open_dataset.h5", 'w'};
+  h5::group grp{file};
+  h5ai::write(grp, "a", make_view_2d(a.data(), 2, 3), false);
+
+  // The lengths_type keeps the dataset open : it is read even after being unlinked
+  auto lt = h5ai::get_h5_lengths_type(grp.open_dataset("a"));
+  EXPECT_TRUE(lt.ds.is_valid());
+  grp.unlink("a");
+
+  std::vector<double> b(2 * 3);
+  h5ai::read(grp, "a", make_view_2d(b.data(), 2, 3), lt);
+  EXPECT_EQ(a, b);
+}
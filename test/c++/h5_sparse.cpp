@@ -0,0 +1,97 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+// The 4x5 matrix
+//   1 0 2 0 0
+//   0 0 0 0 0
+//   0 3 0 4 5
+//   6 0 0 0 0
+template <typename T>
+h5::sparse_csr<T> make_matrix() {
+  return {{4, 5}, {0, 2, 2, 5, 6}, {0, 2, 1, 3, 4, 0}, {T(1), T(2), T(3), T(4), T(5), T(6)}};
+}
+
+TEST(H5, SparseCSR) {
+
+  auto m = make_matrix<double>();
+  auto z = make_matrix<dcomplex>();
+  for (auto &x : z.data) x *= dcomplex(1, -1);
+
+  {
+    h5::file file{"test_sparse.h5", 'w'};
+    h5::write(file, "m", m);
+    h5::write(file, "z", z);
+    h5::write(file, "empty", h5::sparse_csr<double>{});
+  }
+
+  h5::file file{"test_sparse.h5", 'r'};
+  h5::group grp{file};
+  EXPECT_EQ(h5::read_hdf5_format(grp.open_group("m")), "SparseCSR");
+  EXPECT_EQ(h5::read<h5::sparse_csr<double>>(grp, "m"), m);
+  EXPECT_EQ(h5::read<h5::sparse_csr<dcomplex>>(grp, "z"), z);
+  EXPECT_EQ(h5::read<h5::sparse_csr<double>>(grp, "empty"), h5::sparse_csr<double>{});
+
+  // The indices in another integer type
+  auto mi = h5::read<h5::sparse_csr<double, int>>(grp, "m");
+  EXPECT_EQ(mi.indices, (std::vector<int>{0, 2, 1, 3, 4, 0}));
+}
+
+TEST(H5, SparseCSRRows) {
+
+  auto m = make_matrix<double>();
+  {
+    h5::file file{"test_sparse_rows.h5", 'w'};
+    h5::write(file, "m", m);
+  }
+
+  h5::file file{"test_sparse_rows.h5", 'r'};
+  h5::group grp{file};
+
+  // Rows 1 and 2 : the empty row and the row with 3 elements
+  auto r = h5::read_csr_rows<double>(grp, "m", 1, 3);
+  EXPECT_EQ(r.shape, (std::array<long, 2>{2, 5}));
+  EXPECT_EQ(r.indptr, (std::vector<long>{0, 0, 3}));
+  EXPECT_EQ(r.indices, (std::vector<long>{1, 3, 4}));
+  EXPECT_EQ(r.data, (std::vector<double>{3, 4, 5}));
+
+  // All rows, or none
+  EXPECT_EQ(h5::read_csr_rows<double>(grp, "m", 0, 4), m);
+  auto none = h5::read_csr_rows<double>(grp, "m", 2, 2);
+  EXPECT_EQ(none.indptr, (std::vector<long>{0}));
+  EXPECT_EQ(none.nnz(), 0);
+
+  EXPECT_THROW(h5::read_csr_rows<double>(grp, "m", 3, 5), std::runtime_error);
+  EXPECT_THROW(h5::read_csr_rows<long>(grp, "m", 0, 1), std::runtime_error);
+}
+
+TEST(H5, SparseCSRInconsistent) {
+
+  h5::file file{"test_sparse_bad.h5", 'w'};
+  auto m = make_matrix<double>();
+  m.shape[0] = 3;
+  EXPECT_THROW(h5::write(file, "m", m), std::runtime_error);
+  m = make_matrix<double>();
+  m.data.pop_back();
+  EXPECT_THROW(h5::write(file, "m", m), std::runtime_error);
+}
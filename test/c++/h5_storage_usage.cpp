@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+// The report of the dataset at path
+h5::dataset_storage const &find(h5::storage_usage const &r, std::string const &path) {
+  for (auto const &d : r.datasets)
+    if (d.path == path) return d;
+  throw std::runtime_error("no dataset " + path);
+}
+
+TEST(H5, StorageReport) {
+
+  h5::file file{"test_storage_report.h5", 'w'};
+  h5::group grp{file};
+  auto p                 = grp.get_write_policy();
+  p.contiguous_threshold = 0;
+  grp.set_write_policy(p);
+
+  h5::write(grp, "zeros", std::vector<double>(100000, 0.0));
+  h5::write(grp, "x", 1.5);
+  auto sub = grp.create_group("sub");
+  h5::write(sub, "l", std::vector<long>(10, 3));
+  for (int i = 0; i < 20; ++i) {
+    auto n = std::to_string(i);
+    h5::write(sub, "s" + n, i);
+  }
+
+  // Another hard link to sub/l, and a soft one : reported once
+  H5Lcreate_hard(grp, "sub/l", grp, "l_again", H5P_DEFAULT, H5P_DEFAULT);
+  H5Lcreate_soft("/zeros", grp, "zeros_link", H5P_DEFAULT, H5P_DEFAULT);
+  file.flush();
+
+  auto r = h5::storage_report(grp);
+  EXPECT_EQ(r.groups.size(), 2);
+  EXPECT_EQ(r.groups[0].path, "/");
+  EXPECT_EQ(r.groups[0].n_links, 5);
+  EXPECT_EQ(r.groups[1].path, "/sub");
+  EXPECT_EQ(r.groups[1].n_links, 21);
+  for (auto const &g : r.groups) EXPECT_GT(g.header_bytes, 0);
+  EXPECT_EQ(r.datasets.size(), 23);
+
+  // A chunked and compressed array of zeros
+  auto const &z = find(r, "/zeros");
+  EXPECT_EQ(z.type, "double");
+  EXPECT_EQ(z.shape, (h5::v_t{100000}));
+  EXPECT_EQ(z.layout, "chunked");
+  EXPECT_EQ(z.chunk.size(), 1);
+  EXPECT_FALSE(z.filters.empty());
+  EXPECT_EQ(z.filters.back(), "deflate");
+  EXPECT_EQ(z.logical_bytes, 800000);
+  EXPECT_GT(z.compression_ratio(), 100);
+
+  // A scalar, not compressed
+  auto const &x = find(r, "/x");
+  EXPECT_EQ(x.shape, h5::v_t{});
+  EXPECT_EQ(x.logical_bytes, 8);
+  EXPECT_NE(x.layout, "chunked");
+  EXPECT_TRUE(x.filters.empty());
+
+  // The datasets of the subgroup, through its first link
+  EXPECT_EQ(find(r, "/l_again").type, "long");
+  EXPECT_THROW(find(r, "/sub/l"), std::runtime_error);
+  EXPECT_EQ(find(r, "/sub/s3").logical_bytes, sizeof(int));
+
+  EXPECT_GT(r.file_bytes, r.storage_bytes());
+  EXPECT_GT(r.metadata_bytes(), 0);
+
+  // Not recursive
+  auto r1 = h5::storage_report(grp, false);
+  EXPECT_EQ(r1.groups.size(), 1);
+  EXPECT_EQ(r1.datasets.size(), 3);
+
+  // The JSON report
+  auto json = h5::storage_report(sub).to_json();
+  EXPECT_NE(json.find("\"path\": \"/sub/s19\""), std::string::npos);
+  EXPECT_NE(json.find("\"compression_ratio\""), std::string::npos);
+  EXPECT_EQ(json.front(), '{');
+}
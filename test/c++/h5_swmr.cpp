@@ -0,0 +1,114 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#include <sys/wait.h>
+
+// one byte through a pipe, to synchronize the writer and the reader
+void notify(int fd) {
+  char c = 1;
+  if (write(fd, &c, 1) != 1) _exit(2);
+}
+void wait_for(int fd) {
+  char c = 0;
+  if (read(fd, &c, 1) != 1) _exit(2);
+}
+
+TEST(H5, SWMR) {
+
+  h5::file_options opts;
+  opts.swmr = true;
+
+  int to_reader[2], to_writer[2];
+  ASSERT_EQ(pipe(to_reader), 0);
+  ASSERT_EQ(pipe(to_writer), 0);
+
+  // The writer, in another process, appends to a time series while the reader reads it
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    int status = 0;
+    try {
+      h5::file file{"test_swmr.h5", 'w', opts};
+      if (not file.is_swmr()) _exit(3);
+      h5::group grp{file};
+      for (int i = 0; i < 10; ++i) h5::h5_append(grp, "t", double(i));
+      file.flush();
+      notify(to_reader[1]);
+
+      wait_for(to_writer[0]);
+      h5::h5_append(grp, "t", std::vector<double>{10, 11, 12});
+      notify(to_reader[1]);
+      wait_for(to_writer[0]);
+    } catch (std::exception const &) { status = 1; }
+    _exit(status);
+  }
+
+  wait_for(to_reader[0]);
+  {
+    h5::file file{"test_swmr.h5", 'r', opts};
+    EXPECT_TRUE(file.is_swmr());
+    h5::group grp{file};
+
+    auto lt = h5::array_interface::get_h5_lengths_type(grp, "t");
+    EXPECT_EQ(lt.lengths, (h5::v_t{10}));
+    EXPECT_EQ(h5::read<std::vector<double>>(grp, "t").back(), 9.0);
+
+    // The new data are seen once the open dataset is refreshed
+    notify(to_writer[1]);
+    wait_for(to_reader[0]);
+    file.refresh();
+    EXPECT_EQ(h5::array_interface::get_h5_lengths_type(lt.ds).lengths, (h5::v_t{13}));
+
+    std::vector<double> expected(13);
+    std::iota(expected.begin(), expected.end(), 0.0);
+    EXPECT_EQ(h5::read<std::vector<double>>(grp, "t"), expected);
+    notify(to_writer[1]);
+  }
+
+  int status = -1;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+#endif
+
+TEST(H5, SWMRStartWrite) {
+
+  // A file created with the latest format switches to SWMR once its datasets are created
+  h5::file_options opts;
+  opts.latest_format = true;
+  h5::file file{"test_swmr_start.h5", 'w', opts};
+  h5::group grp{file};
+  h5::h5_append(grp, "t", 1.0);
+  EXPECT_FALSE(file.is_swmr());
+  file.start_swmr_write();
+  EXPECT_TRUE(file.is_swmr());
+  h5::h5_append(grp, "t", 2.0);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "t"), (std::vector<double>{1, 2}));
+
+  // Not in SWMR mode
+  h5::file other{"test_swmr_other.h5", 'w'};
+  EXPECT_FALSE(other.is_swmr());
+  EXPECT_THROW(other.start_swmr_write(), std::runtime_error);
+}
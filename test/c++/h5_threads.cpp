@@ -0,0 +1,71 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <numeric>
+
+TEST(H5, LockIsNeeded) {
+  hbool_t is_ts = 0;
+  H5is_library_threadsafe(&is_ts);
+  EXPECT_EQ(h5::hdf5_lock::is_needed(), not is_ts);
+
+  // recursive
+  h5::hdf5_lock l1;
+  h5::hdf5_lock l2;
+}
+
+TEST(H5, ConcurrentRead) {
+
+  constexpr int n_datasets = 32, n_threads = 8;
+
+  {
+    h5::file file{"test_concurrent_read.h5", 'w'};
+    h5::group grp{file};
+    for (int i = 0; i < n_datasets; ++i) {
+      std::vector<double> v(100 + i);
+      std::iota(v.begin(), v.end(), double(i));
+      auto n = std::to_string(i);
+      h5::write(grp, "v" + n, v);
+      h5::write(grp, "s" + n, n);
+    }
+  }
+
+  // One file, shared by all the threads
+  h5::file file{"test_concurrent_read.h5", 'r'};
+  h5::group grp{file};
+
+  std::atomic<int> n_errors = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int k = 0; k < 4 * n_datasets; ++k) {
+        int i  = (k + t) % n_datasets;
+        auto n = std::to_string(i);
+        auto v = h5::read<std::vector<double>>(grp, "v" + n);
+        auto s = h5::read<std::string>(grp, "s" + n);
+        if (v.size() != 100 + i or v[0] != i or v.back() != i + 99 + i or s != n) ++n_errors;
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+  EXPECT_EQ(n_errors, 0);
+}
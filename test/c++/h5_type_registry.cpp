@@ -0,0 +1,87 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+
+TEST(H5, TypeRegistryImmortal) {
+
+  // The same locked bool type on every call, and no reference counting
+  auto b1 = h5::hdf5_type<bool>();
+  auto b2 = h5::hdf5_type<bool>();
+  EXPECT_EQ(hid_t(b1), hid_t(b2));
+
+  int count = h5::hdf5_type<double>().get_ref_count();
+  {
+    auto d  = h5::hdf5_type<double>();
+    auto d2 = d;
+    auto d3 = std::move(d2);
+    EXPECT_EQ(d3.get_ref_count(), count);
+  }
+  EXPECT_EQ(h5::hdf5_type<double>().get_ref_count(), count);
+  EXPECT_TRUE(h5::hdf5_type<bool>().is_valid());
+
+  // Many bools are written without creating any new type
+  auto n_types = H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_DATATYPE);
+  {
+    h5::file file{"test_type_registry.h5", 'w'};
+    for (int i = 0; i < 100; ++i) {
+      auto n = std::to_string(i);
+      h5::write(file, "b" + n, (i % 2 == 0));
+    }
+    EXPECT_EQ(h5::read<bool>(file, "b2"), true);
+    EXPECT_EQ(h5::read<bool>(file, "b3"), false);
+  }
+  EXPECT_EQ(H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_DATATYPE), n_types);
+}
+
+TEST(H5, TypeRegistryLookup) {
+
+  using h5::detail::find_registered_type;
+  using h5::detail::registry_index;
+  using h5::detail::type_registry;
+
+  // From the C++ type to the hdf5 type, and back
+  EXPECT_EQ(type_registry()[registry_index<int>::value].id, hid_t(h5::hdf5_type<int>()));
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<int>()), registry_index<int>::value);
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<bool>()), registry_index<bool>::value);
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<h5::dcplx_t>()), registry_index<h5::dcplx_t>::value);
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<unsigned short>()), registry_index<unsigned short>::value);
+
+  // Equal types : the first one
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<char>()), registry_index<signed char>::value);
+  EXPECT_EQ(find_registered_type(h5::hdf5_type<std::complex<double>>()), registry_index<double>::value);
+
+  // The types in the file, e.g. of another byte order, or a fixed size string
+  EXPECT_EQ(find_registered_type(H5T_IEEE_F64BE), registry_index<double>::value);
+  EXPECT_EQ(find_registered_type(H5T_STD_U32LE), registry_index<unsigned int>::value);
+  h5::datatype str = H5Tcopy(H5T_C_S1);
+  H5Tset_size(str, 12);
+  EXPECT_EQ(find_registered_type(str), registry_index<std::string>::value);
+
+  // Not in the registry
+  h5::datatype other_enum = H5Tenum_create(H5T_NATIVE_CHAR);
+  char val                = 2;
+  H5Tenum_insert(other_enum, "TWO", &val);
+  EXPECT_EQ(find_registered_type(other_enum), -1);
+  EXPECT_EQ(find_registered_type(h5::make_array_type(h5::hdf5_type<double>(), {3})), -1);
+
+  EXPECT_EQ(h5::get_name_of_h5_type(h5::hdf5_type<double>()), "double");
+  EXPECT_EQ(h5::get_name_of_h5_type(h5::hdf5_type<unsigned long>()), "unsigned long");
+  EXPECT_EQ(h5::get_name_of_h5_type(h5::hdf5_type<std::string>()), "std::string");
+}
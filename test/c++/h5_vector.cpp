@@ -17,6 +17,7 @@
 #include "./test_common.hpp"
 
 #include <h5/h5.hpp>
+#include <hdf5.h>
 #include <variant>
 
 TEST(H5, Vector) {
@@ -110,3 +111,50 @@ TEST(H5, VectorAttribute) {
   EXPECT_EQ(vevs, rvevs);
   EXPECT_EQ(vves, rvves);
 }
+
+TEST(H5, VectorStringLayout) {
+
+  // A single long string : the automatic layout uses variable-length strings
+  std::vector<std::string> outlier = {"a", "", "bc", std::string(1000, 'x')};
+  std::vector<std::string> dense   = {"ab", "cd", "e"};
+  using layout_t                   = h5::write_policy::string_layout_t;
+
+  {
+    h5::file file{"test_vec_str_layout.h5", 'w'};
+    h5::group grp{file};
+    h5::write(grp, "outlier_default", outlier);
+
+    auto p          = grp.get_write_policy();
+    p.string_layout = layout_t::automatic;
+    grp.set_write_policy(p);
+    h5::write(grp, "outlier", outlier);
+    h5::write(grp, "dense", dense);
+
+    p.string_layout = layout_t::variable;
+    grp.set_write_policy(p);
+    h5::write(grp, "dense_vl", dense);
+    h5::write(grp, "empty_vl", std::vector<std::string>{});
+
+    p.string_layout = layout_t::fixed;
+    grp.set_write_policy(p);
+    h5::write(grp, "outlier_fixed", outlier);
+  }
+
+  h5::file file{"test_vec_str_layout.h5", 'r'};
+  h5::group grp{file};
+
+  // layout on disk
+  auto is_variable = [&](std::string const &name) { return H5Tis_variable_str(h5::array_interface::get_h5_lengths_type(grp, name).ty) > 0; };
+  EXPECT_FALSE(is_variable("outlier_default"));
+  EXPECT_TRUE(is_variable("outlier"));
+  EXPECT_FALSE(is_variable("dense"));
+  EXPECT_TRUE(is_variable("dense_vl"));
+  EXPECT_FALSE(is_variable("outlier_fixed"));
+
+  EXPECT_EQ(h5::read<std::vector<std::string>>(grp, "outlier_default"), outlier);
+  EXPECT_EQ(h5::read<std::vector<std::string>>(grp, "outlier"), outlier);
+  EXPECT_EQ(h5::read<std::vector<std::string>>(grp, "dense"), dense);
+  EXPECT_EQ(h5::read<std::vector<std::string>>(grp, "dense_vl"), dense);
+  EXPECT_EQ(h5::read<std::vector<std::string>>(grp, "outlier_fixed"), outlier);
+  EXPECT_TRUE(h5::read<std::vector<std::string>>(grp, "empty_vl").empty());
+}
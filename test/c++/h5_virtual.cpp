@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <vector>
+#include <numeric>
+
+namespace h5ai = h5::array_interface;
+
+TEST(H5, VirtualDataset) {
+
+  // The outputs of 4 ranks, with 5 values each
+  int n_ranks = 4, n = 5;
+  for (int r = 0; r < n_ranks; ++r) {
+    auto rs = std::to_string(r);
+    h5::file file{"test_virtual_rank" + rs + ".h5", 'w'};
+    std::vector<double> v(n);
+    std::iota(v.begin(), v.end(), double(r * n));
+    h5::write(file, "data", v);
+    h5::write(file, "z", std::vector<dcomplex>(2, dcomplex(r, -r)));
+  }
+
+  {
+    h5::file file{"test_virtual.h5", 'w'};
+    h5::group grp{file};
+    std::vector<h5::virtual_source> sources, zsources;
+    for (int r = 0; r < n_ranks; ++r) {
+      auto rs = std::to_string(r);
+      sources.push_back({"test_virtual_rank" + rs + ".h5", "data", {h5::hsize_t(r * n)}, {h5::hsize_t(n)}});
+      zsources.push_back({"test_virtual_rank" + rs + ".h5", "z", {h5::hsize_t(r), 0, 0}, {1, 2, 2}, {}, {2, 2}});
+    }
+    auto ds = grp.create_virtual_dataset("all", h5::hdf5_type<double>(), {h5::hsize_t(n_ranks * n)}, sources);
+    EXPECT_TRUE(ds.is_valid());
+
+    // The complex vectors as the rows of a matrix, and a source starting at an offset
+    grp.create_virtual_dataset("z", h5::hdf5_type<double>(), {h5::hsize_t(n_ranks), 2, 2}, zsources, true);
+    grp.create_virtual_dataset("tail", h5::hdf5_type<double>(), {3},
+                               {{"test_virtual_rank1.h5", "data", {0}, {2}, {3}}});
+  }
+
+  // Read as a normal dataset
+  h5::file file{"test_virtual.h5", 'r'};
+  h5::group grp{file};
+  std::vector<double> expected(n_ranks * n);
+  std::iota(expected.begin(), expected.end(), 0.0);
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "all"), expected);
+
+  std::vector<dcomplex> z(n_ranks * 2);
+  h5ai::h5_array_view v{h5::hdf5_type<dcomplex>(), z.data(), 2, true};
+  v.slab.count[0] = v.L_tot[0] = n_ranks;
+  v.slab.count[1] = v.L_tot[1] = 2;
+  auto lt         = h5ai::get_h5_lengths_type(grp, "z");
+  EXPECT_TRUE(lt.has_complex_attribute);
+  h5ai::read(grp, "z", v, lt);
+  for (int r = 0; r < n_ranks; ++r) {
+    EXPECT_EQ(z[2 * r], dcomplex(r, -r));
+    EXPECT_EQ(z[2 * r + 1], dcomplex(r, -r));
+  }
+
+  // The unmapped part is 0
+  EXPECT_EQ(h5::read<std::vector<double>>(grp, "tail"), (std::vector<double>{8, 9, 0}));
+}
+
+TEST(H5, VirtualDatasetErrors) {
+
+  h5::file file{"test_virtual_errors.h5", 'w'};
+  h5::group grp{file};
+  auto ty = h5::hdf5_type<double>();
+  EXPECT_THROW(grp.create_virtual_dataset("a", ty, {4}, {{"f.h5", "d", {2}, {3}}}), std::runtime_error);
+  EXPECT_THROW(grp.create_virtual_dataset("a", ty, {4}, {{"f.h5", "d", {0, 0}, {1, 1}}}), std::runtime_error);
+  EXPECT_THROW(grp.create_virtual_dataset("a", ty, {4}, {{"f.h5", "d", {0}, {2}, {}, {3}}}), std::runtime_error);
+  EXPECT_THROW(grp.create_virtual_dataset("a", ty, {4, 3}, {}, true), std::runtime_error);
+}
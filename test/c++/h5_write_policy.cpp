@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+
+// chunk dimensions of the dataset g[name], empty if it is contiguous
+std::vector<hsize_t> get_chunk_dims(h5::group g, std::string const &name) {
+  auto ds           = g.open_dataset(name);
+  h5::proplist dcpl = H5Dget_create_plist(ds);
+  if (H5Pget_layout(dcpl) != H5D_CHUNKED) return {};
+  std::vector<hsize_t> dims(H5Sget_simple_extent_ndims(h5::dataspace{H5Dget_space(ds)}));
+  H5Pget_chunk(dcpl, dims.size(), dims.data());
+  return dims;
+}
+
+// number of filters applied to the dataset g[name]
+int get_nfilters(h5::group g, std::string const &name) {
+  auto ds           = g.open_dataset(name);
+  h5::proplist dcpl = H5Dget_create_plist(ds);
+  return H5Pget_nfilters(dcpl);
+}
+
+TEST(H5, WritePolicy) {
+
+  std::vector<double> v(1000);
+  std::iota(v.begin(), v.end(), 0.0);
+
+  {
+    h5::file file{"test_write_policy.h5", 'w'};
+
+    // The default : chunks of at most chunk_bytes, deflate
+    h5::group grp{file};
+    h5::h5_write(grp, "default", v);
+    EXPECT_EQ(get_chunk_dims(grp, "default"), std::vector<hsize_t>{1000});
+    EXPECT_EQ(get_nfilters(grp, "default"), 1);
+
+    // Small chunks with shuffle + deflate, inherited by the subgroups
+    auto p          = grp.get_write_policy();
+    p.chunk_bytes   = 800;
+    p.filter        = h5::write_policy::filter_t::shuffle_deflate;
+    p.deflate_level = 4;
+    grp.set_write_policy(p);
+    auto sub = grp.create_group("sub");
+    h5::h5_write(sub, "small_chunks", v);
+    EXPECT_EQ(get_chunk_dims(sub, "small_chunks"), std::vector<hsize_t>{100});
+    EXPECT_EQ(get_nfilters(sub, "small_chunks"), 2);
+
+    // Below the threshold, the dataset is contiguous
+    p.contiguous_threshold = 1 << 20;
+    file.set_write_policy(p);
+    h5::group grp2{file};
+    h5::h5_write(grp2, "contiguous", v);
+    EXPECT_TRUE(get_chunk_dims(grp2, "contiguous").empty());
+
+    // An unavailable registered filter falls back to deflate
+    p.contiguous_threshold = 0;
+    p.filter               = h5::write_policy::filter_t::registered;
+    p.filter_id            = h5::write_policy::filter_zstd;
+    grp2.set_write_policy(p);
+    h5::h5_write(grp2, "registered", v);
+    EXPECT_EQ(get_nfilters(grp2, "registered"), 1);
+  }
+
+  h5::file file{"test_write_policy.h5", 'r'};
+  for (auto name : {"default", "sub/small_chunks", "contiguous", "registered"}) {
+    std::vector<double> w;
+    h5::h5_read(file, name, w);
+    EXPECT_EQ(v, w);
+  }
+}
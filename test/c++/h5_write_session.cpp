@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include "./test_common.hpp"
+
+#include <h5/h5.hpp>
+#include <hdf5.h>
+#include <vector>
+#include <numeric>
+#include <filesystem>
+
+// The configuration of the metadata cache of the file
+H5AC_cache_config_t mdc_config(h5::file const &f) {
+  H5AC_cache_config_t config;
+  config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+  H5Fget_mdc_config(f, &config);
+  return config;
+}
+
+// Is the size of the metadata cache of the file fixed ?
+bool is_fixed_size(h5::file const &f) {
+  auto config = mdc_config(f);
+  return config.incr_mode == H5C_incr__off and config.decr_mode == H5C_decr__off;
+}
+
+// A tree of many small objects
+void write_tree(h5::group g, int n) {
+  for (int i = 0; i < n; ++i) {
+    auto name = std::to_string(i);
+    auto sub  = g.create_group("g" + name);
+    h5::write(sub, "x", double(i));
+    h5::write(sub, "v", std::vector<int>(10, i));
+    h5::write_attribute(sub, "name", name);
+  }
+}
+
+TEST(H5, WriteSession) {
+
+  std::string filename = "test_write_session.h5";
+  {
+    h5::file file{filename, 'w'};
+    EXPECT_FALSE(is_fixed_size(file));
+    {
+      h5::write_session session{file, 64 << 20};
+      EXPECT_TRUE(file.in_write_session());
+      EXPECT_TRUE(is_fixed_size(file));
+      EXPECT_TRUE(mdc_config(file).evictions_enabled);
+      EXPECT_EQ(mdc_config(file).max_size, 64 << 20);
+      write_tree(file, 200);
+
+      // The implicit flush is deferred : the metadata are not in the file yet
+      file.flush_if_not_in_session();
+      auto size_in_session = std::filesystem::file_size(filename);
+
+      // A nested session, e.g. in a function called during the session
+      {
+        h5::write_session inner{file};
+        write_tree(h5::group{file}.create_group("inner"), 10);
+      }
+      EXPECT_TRUE(file.in_write_session());
+      EXPECT_TRUE(is_fixed_size(file));
+
+      session.commit();
+      EXPECT_GT(std::filesystem::file_size(filename), size_in_session);
+
+      // An explicit flush commits too
+      auto size_committed = std::filesystem::file_size(filename);
+      write_tree(h5::group{file}.create_group("more"), 50);
+      file.flush();
+      EXPECT_GT(std::filesystem::file_size(filename), size_committed);
+    }
+    EXPECT_FALSE(file.in_write_session());
+    EXPECT_FALSE(is_fixed_size(file));
+
+    // After the session, file::flush writes to the file again
+    h5::write(file, "after", 1);
+    file.flush();
+  }
+
+  h5::file file{filename, 'r'};
+  h5::group grp{file};
+  EXPECT_EQ(grp.get_all_subgroup_names().size(), 202);
+  EXPECT_EQ(h5::read<double>(grp, "g199/x"), 199);
+  EXPECT_EQ(h5::read<std::vector<int>>(grp, "inner/g3/v"), std::vector<int>(10, 3));
+  EXPECT_EQ(h5::read<int>(grp, "after"), 1);
+
+  // Not for a read-only file
+  EXPECT_THROW(h5::write_session{file}, std::runtime_error);
+}
+
+TEST(H5, WriteSessionMemoryFile) {
+
+  h5::file file;
+  {
+    h5::write_session session{file};
+    write_tree(file, 20);
+  }
+  h5::file copy{file.as_buffer()};
+  EXPECT_EQ(h5::read<std::vector<int>>(copy, "g7/v"), std::vector<int>(10, 7));
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+#include <gtest/gtest.h>
+#include <h5/h5.hpp>
+#include <mpi.h>
+#include <vector>
+
+namespace h5ai = h5::array_interface;
+
+// Each rank writes its own rows of a shared (n_ranks * 2, 3) dataset
+TEST(H5, MPICollectiveWriteSlice) {
+
+  int rank = 0, n_ranks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &n_ranks);
+
+  std::vector<double> a(2 * 3, double(rank));
+
+  {
+    h5::file file{"test_mpi.h5", 'w', MPI_COMM_WORLD};
+    EXPECT_TRUE(file.is_parallel());
+    h5::group grp{file};
+
+    h5ai::create_dataset(grp, "a", {{h5::hsize_t(2 * n_ranks), 3}, h5::hdf5_type<double>(), false}, false);
+    auto lt = h5ai::get_h5_lengths_type(grp, "a");
+
+    h5ai::h5_array_view v{h5::hdf5_type<double>(), (void *)a.data(), 2, false};
+    v.slab.count = v.L_tot = {2, 3};
+    h5ai::hyperslab sl(2, false);
+    sl.offset = {h5::hsize_t(2 * rank), 0};
+    sl.count  = {2, 3};
+    h5ai::write_slice(grp, "a", v, lt, sl);
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    h5::file file{"test_mpi.h5", 'r'};
+    std::vector<double> b(2 * 3 * n_ranks);
+    h5ai::h5_array_view v{h5::hdf5_type<double>(), (void *)b.data(), 2, false};
+    v.slab.count = v.L_tot = {h5::hsize_t(2 * n_ranks), 3};
+    h5ai::read(file, "a", v, h5ai::get_h5_lengths_type(file, "a"));
+    for (int i = 0; i < b.size(); ++i) EXPECT_EQ(b[i], double(i / 6));
+  }
+}
+
+int main(int argc, char **argv) {
+  MPI_Init(&argc, &argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  int res = RUN_ALL_TESTS();
+  MPI_Finalize();
+  return res;
+}
@@ -19,11 +19,36 @@
 #include <limits>
 
 #include <h5/h5.hpp>
+#include <hdf5.h>
 
 using namespace std::complex_literals;
 
 using dcomplex = std::complex<double>;
 
+// view on a contiguous C-ordered 2d array of shape (n0, n1)
+template <typename T>
+h5::array_interface::h5_array_view make_view_2d(T *data, long n0, long n1) {
+  h5::array_interface::h5_array_view v{h5::hdf5_type<T>(), (void *)data, 2, h5::is_complex_v<T>};
+  v.slab.count[0] = v.L_tot[0] = n0;
+  v.slab.count[1] = v.L_tot[1] = n1;
+  return v;
+}
+
+// address of the object header of the dataset g[name]
+inline haddr_t header_address(h5::group const &g, std::string const &name) {
+#if H5_VERSION_GE(1, 12, 0)
+  H5O_info2_t info;
+  H5Oget_info_by_name3(g, name.c_str(), &info, H5O_INFO_BASIC, H5P_DEFAULT);
+  haddr_t addr = HADDR_UNDEF;
+  H5VLnative_token_to_addr(g, info.token, &addr);
+  return addr;
+#else
+  H5O_info_t info;
+  H5Oget_info_by_name2(g, name.c_str(), &info, H5O_INFO_BASIC, H5P_DEFAULT);
+  return info.addr;
+#endif
+}
+
 #define MAKE_MAIN_MPI                                                                                                                                \
   int main(int argc, char **argv) {                                                                                                                  \
     ::mpi::environment env(argc, argv);                                                                                                              \
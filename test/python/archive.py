@@ -16,7 +16,7 @@ import unittest
 import numpy as np
 from math import isnan
 
-from h5 import HDFArchive
+from h5 import HDFArchive, LazyArray, _h5py
 
 def assert_arrays_are_close(a, b, precision = 1.e-6):
     d = np.amax(np.abs(a - b))
@@ -185,5 +185,194 @@ class TestHdf5Io(unittest.TestCase):
             with self.assertRaises(RuntimeError) :
                 a.create_softlink('data', 'link', delete_if_exists = False)
 
+    def test_lazy_arrays(self):
+        filename = 'h5archive_lazy.h5'
+        a = np.arange(60, dtype = np.float64).reshape(6, 5, 2)
+        with HDFArchive(filename, 'w') as ar:
+            ar['a'] = a
+            ar['z'] = a + 1j * a
+            ar['i'] = 3
+            ar['s'] = 'a string'
+            ar['grp'] = {'b' : a}
+
+        with HDFArchive(filename, 'r') as ar:
+            A = ar.get_lazy('a')
+            self.assertEqual(A.shape, (6, 5, 2))
+            self.assertEqual(A.dtype, np.float64)
+            self.assertEqual(len(A), 6)
+            for idx in [(slice(1, 3), 0), (Ellipsis, 1), (slice(None, None, 2), slice(4, 0, -2)), (-1, -1, -1), (slice(5, 2),), Ellipsis]:
+                assert_arrays_are_close(A[idx], a[idx])
+                self.assertEqual(np.shape(A[idx]), np.shape(a[idx]))
+            assert_arrays_are_close(np.asarray(A), a)
+            with self.assertRaises(IndexError):
+                A[6]
+            with self.assertRaises(IndexError):
+                A[[0, 1]]
+
+            Z = ar.get_lazy('z')
+            self.assertEqual(Z.shape, (6, 5, 2))
+            self.assertEqual(Z.dtype, np.complex128)
+            assert_arrays_are_close(Z[2:4, ::-1, 1], (a + 1j * a)[2:4, ::-1, 1])
+            assert_arrays_are_close(ar.get_lazy('grp/b')[0], a[0])
+            with self.assertRaises(TypeError):
+                ar.get_lazy('i')
+
+        # Opt-in for all the arrays, the scalars are read
+        with HDFArchive(filename, 'r', lazy_arrays = True) as ar:
+            A = ar['a']
+            self.assertTrue(isinstance(A, LazyArray))
+            assert_arrays_are_close(A[1], a[1])
+            self.assertTrue(isinstance(ar['grp']['b'], LazyArray))
+            self.assertEqual(ar['i'], 3)
+            self.assertEqual(ar['s'], 'a string')
+        with HDFArchive(filename, 'r') as ar:
+            self.assertTrue(isinstance(ar['a'], np.ndarray))
+
+    def test_dict_tree(self):
+        filename = 'h5archive_tree.h5'
+        a = np.arange(6, dtype = np.float64).reshape(2, 3)
+        tree = {'a' : a, 'z' : a + 1j * a, 't' : a.T, 'i' : 3, 'b' : True, 'x' : 2.5, 'c' : 1 + 2j, 's' : 'a string',
+                'n' : np.int32(4), 1 : 'int key', 'sub' : {'a' : a, 'empty' : {}}}
+        with HDFArchive(filename, 'w') as ar:
+            ar['tree'] = tree
+            self.assertTrue(ar.is_group('tree'))
+            # with other values, the tree is written in Python
+            ar['mixed'] = {'a' : a, 'l' : [1, 2]}
+
+        with HDFArchive(filename, 'r') as ar:
+            r = ar['tree']
+            self.assertEqual(set(r.keys()), set(str(k) for k in tree.keys()))
+            for k in ['a', 'z', 't']:
+                assert_arrays_are_close(r[k], tree[k])
+            self.assertEqual(r['t'].shape, (3, 2))
+            self.assertEqual(r['i'], 3)
+            self.assertEqual(r['b'], True)
+            self.assertEqual(r['x'], 2.5)
+            self.assertEqual(r['c'], 1 + 2j)
+            self.assertEqual(r['s'], 'a string')
+            self.assertEqual(r['n'], 4)
+            self.assertEqual(r['1'], 'int key')
+            assert_arrays_are_close(r['sub']['a'], a)
+            self.assertEqual(r['sub']['empty'], {})
+            m = ar['mixed']
+            assert_arrays_are_close(m['a'], a)
+            self.assertEqual(m['l'], [1, 2])
+
+    def test_compact(self):
+        a = np.arange(100000, dtype = np.float64)
+        with HDFArchive('h5archive_big.h5', 'w', file_options = {'persist_free_space' : True}) as ar:
+            ar['a'] = a
+            ar['b'] = 1
+        with HDFArchive('h5archive_big.h5', 'a') as ar:
+            del ar['a']
+            ar.compact('h5archive_packed.h5')
+        import os
+        self.assertLess(os.path.getsize('h5archive_packed.h5'), a.nbytes / 2)
+        with HDFArchive('h5archive_packed.h5', 'r') as ar:
+            self.assertEqual(list(ar.keys()), ['b'])
+            self.assertEqual(ar['b'], 1)
+
+    def test_sparse(self):
+        try:
+            import scipy.sparse as sp
+        except ImportError:
+            self.skipTest("scipy is not available")
+        m = sp.random(40, 30, density = 0.1, format = 'csr', random_state = 1)
+        z = sp.coo_matrix(m * (1 - 2j))
+        with HDFArchive('h5archive_sparse.h5', 'w') as ar:
+            ar['m'] = m
+            ar['z'] = z
+            ar['empty'] = sp.csr_matrix((3, 4))
+        with HDFArchive('h5archive_sparse.h5', 'r') as ar:
+            r = ar['m']
+            self.assertTrue(sp.isspmatrix_csr(r))
+            self.assertEqual(r.shape, m.shape)
+            assert_arrays_are_close(r.toarray(), m.toarray())
+            assert_arrays_are_close(ar['z'].toarray(), z.toarray())
+            self.assertEqual(ar['empty'].shape, (3, 4))
+            self.assertEqual(ar['empty'].nnz, 0)
+
+    def test_format_listing(self):
+        with HDFArchive('h5archive_formats.h5', 'w') as ar:
+            for i in range(50):
+                ar['l%d'%i] = [i, 'x']
+            ar['t'] = (1, 2)
+            ar['a'] = np.arange(3)
+        with HDFArchive('h5archive_formats.h5', 'r') as ar:
+            # The tags of all the keys are read in the listing of the group
+            self.assertEqual(ar._format_of('l3'), 'List')
+            self.assertEqual(ar._format_of('t'), 'Tuple')
+            self.assertEqual(ar._format_of('a'), '')
+            self.assertEqual(len(ar._format_index), 52)
+            self.assertEqual(ar['l7'], [7, 'x'])
+            self.assertEqual(ar['t'], (1, 2))
+        with HDFArchive('h5archive_formats.h5', 'a') as ar:
+            ar._format_of('t')
+            ar['t'] = [3]
+            self.assertEqual(ar._format_of('t'), 'List')
+            self.assertEqual(ar['t'], [3])
+
+    def test_key_cache(self):
+        filename = 'h5archive_keys.h5'
+
+        class Raw:
+            # written with the low level API, the archive does not know the kind of the key
+            def __init__(self, x): self.x = x
+            def __write_hdf5__(self, group, key): _h5py.h5_write(group, key, self.x)
+
+        def check_keys(ar, keys):
+            self.assertEqual(len(ar), len(keys))
+            self.assertEqual(sorted(ar), sorted(keys))
+            self.assertEqual(sorted(ar.keys()), sorted(keys))
+            for k in keys: self.assertIn(k, ar)
+
+        with HDFArchive(filename, 'w') as ar:
+            ar['a'] = 1
+            ar['g'] = {'x' : [1, 2]}
+            check_keys(ar, ['a', 'g'])
+            self.assertTrue(ar.is_group('g'))
+
+            # The views are lazy, and follow the mutations of the group
+            values, items = ar.values(), ar.items()
+            self.assertEqual(len(values), 2)
+
+            # del unlinks the key from the file
+            del ar['a']
+            check_keys(ar, ['g'])
+            self.assertNotIn('a', ar)
+            self.assertEqual(len(values), 1)
+            self.assertEqual([k for k, v in items], ['g'])
+            with self.assertRaises(KeyError):
+                del ar['a']
+
+            # A group overwritten by data, and data by a group
+            ar['g'] = 2.5
+            check_keys(ar, ['g'])
+            self.assertTrue(ar.is_data('g'))
+            self.assertEqual(list(values), [2.5])
+            ar['b'] = 3
+            ar['b'] = {'y' : 4}
+            check_keys(ar, ['g', 'b'])
+            self.assertTrue(ar.is_group('b'))
+            self.assertEqual(dict(items), {'g' : 2.5, 'b' : {'y' : 4}})
+
+            # __write_hdf5__ and a softlink
+            ar['r'] = Raw(7)
+            check_keys(ar, ['g', 'b', 'r'])
+            self.assertTrue(ar.is_data('r'))
+            ar.create_softlink('b', 'l')
+            check_keys(ar, ['g', 'b', 'r', 'l'])
+            self.assertTrue(ar.is_group('l'))
+            self.assertEqual(ar['l']['y'], 4)
+            del ar['l']
+            check_keys(ar, ['g', 'b', 'r'])
+
+        # The file has the same keys when it is opened again
+        with HDFArchive(filename, 'r') as ar:
+            check_keys(ar, ['g', 'b', 'r'])
+            self.assertTrue(ar.is_data('g'))
+            self.assertTrue(ar.is_group('b'))
+            self.assertEqual(dict(ar.items()), {'g' : 2.5, 'b' : {'y' : 4}, 'r' : 7})
+
 if __name__ == '__main__':
     unittest.main()
@@ -105,5 +105,77 @@ class TestH5Interface(unittest.TestCase):
             assert_arrays_are_close(r, a)
             c += 1 
 
+    def test_h5_read_out(self):
+
+        f = h5.File("test_read_out.h5", 'w')
+        g = h5.Group(f)
+        a = np.arange(12, dtype = np.float64).reshape(3, 4)
+        h5.h5_write(g, 'a', a)
+        h5.h5_write(g, 'z', a + 1j * a)
+        h5.h5_write(g, 'i8', np.array([-1, 2, -3], np.int8))
+
+        # 1 byte signed integers are read as int8, not as strings
+        r = h5.h5_read(g, 'i8')
+        self.assertEqual(r.dtype, np.int8)
+        self.assertTrue((r == [-1, 2, -3]).all())
+
+        # Read into a preallocated array, which is returned
+        out = np.zeros((3, 4))
+        r = h5.h5_read(g, 'a', out = out)
+        self.assertTrue(r is out)
+        assert_arrays_are_close(out, a)
+
+        out = np.zeros((3, 4), np.complex128)
+        h5.h5_read(g, 'z', out = out)
+        assert_arrays_are_close(out, a + 1j * a)
+
+        # Non contiguous buffers
+        buf = np.zeros((6, 8))
+        h5.h5_read(g, 'a', out = buf[::2, 1::2])
+        assert_arrays_are_close(buf[::2, 1::2], a)
+        self.assertEqual(np.count_nonzero(buf[1::2, :]), 0)
+
+        out = np.zeros((4, 3)).T
+        h5.h5_read(g, 'a', out = out)
+        assert_arrays_are_close(out, a)
+
+        # Wrong shape
+        with self.assertRaises(ValueError):
+            h5.h5_read(g, 'a', out = np.zeros((4, 3)))
+
+    def test_h5_read_many(self):
+
+        f = h5.File("test_read_many.h5", 'w')
+        g = h5.Group(f)
+        a = np.arange(12, dtype = np.float64).reshape(3, 4)
+        h5.h5_write(g, 'a', a)
+        h5.h5_write(g, 'z', a + 1j * a)
+        h5.h5_write(g, 'i', 14)
+        h5.h5_write(g, 's', "a string")
+        h5.h5_write(g, 'c', 1.2 + 3j)
+
+        # The values in the order of the keys
+        r = h5.h5_read_many(g, ['z', 'i', 'a', 's', 'c'])
+        self.assertEqual(len(r), 5)
+        assert_arrays_are_close(r[0], a + 1j * a)
+        self.assertEqual(r[1], 14)
+        assert_arrays_are_close(r[2], a)
+        self.assertEqual(r[3], "a string")
+        self.assertEqual(r[4], 1.2 + 3j)
+        self.assertEqual(h5.h5_read_many(g, []), [])
+
+        with self.assertRaises(RuntimeError):
+            h5.h5_read_many(g, ['a', 'not_there'])
+
+        # Reads and writes from several threads, which run without the GIL during the I/O
+        from concurrent.futures import ThreadPoolExecutor
+        def work(i):
+            h5.h5_write(g, 'b%s'%i, a * i)
+            return h5.h5_read(g, 'b%s'%i)
+        with ThreadPoolExecutor(4) as pool:
+            res = list(pool.map(work, range(8)))
+        for i, b in enumerate(res):
+            assert_arrays_are_close(b, a * i)
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,22 @@
+# Run h5_storage_report on INPUT and check the top level of the JSON report
+# cmake -DTOOL=<h5_storage_report> -DINPUT=<file.h5> -P check_h5_storage_report.cmake
+
+execute_process(COMMAND ${TOOL} ${INPUT} RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE err)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "h5_storage_report failed (${result}) : ${err}")
+endif()
+
+if(NOT out MATCHES "^{\"file_bytes\": [0-9]+, \"storage_bytes\": [0-9]+, \"metadata_bytes\": [0-9]+,")
+  message(FATAL_ERROR "The report does not start with the sizes of the file :\n${out}")
+endif()
+foreach(key groups datasets)
+  if(NOT out MATCHES "\n \"${key}\": \\[")
+    message(FATAL_ERROR "No ${key} in the report :\n${out}")
+  endif()
+endforeach()
+if(NOT out MATCHES "\"path\": \"/ASCII\"")
+  message(FATAL_ERROR "The dataset /ASCII is not in the report :\n${out}")
+endif()
+if(NOT out MATCHES "}\n$")
+  message(FATAL_ERROR "The report does not end with a newline")
+endif()
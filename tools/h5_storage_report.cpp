@@ -0,0 +1,58 @@
+// Copyright (c) 2022 Simons Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Nils Wentzell
+
+// Print the storage report of a file, or of one of its groups, as JSON (cf. h5::storage_report)
+//
+//   h5_storage_report file.h5 [group] [--no-recursive]
+
+#include <h5/h5.hpp>
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv) {
+
+  std::string filename, group_name = "/";
+  bool recursive = true;
+  int n_args     = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--no-recursive") == 0)
+      recursive = false;
+    else if (std::strcmp(argv[i], "-h") == 0 or std::strcmp(argv[i], "--help") == 0)
+      n_args = -1;
+    else if (n_args >= 0)
+      (n_args++ == 0 ? filename : group_name) = argv[i];
+  }
+  if (n_args < 1 or n_args > 2) {
+    std::cerr << "Usage : " << argv[0] << " file.h5 [group] [--no-recursive]\n"
+              << "Print the size, layout, chunks, filters and compression ratio of the datasets of the group (default : /),\n"
+              << "and the metadata of the groups, as JSON.\n";
+    return n_args < 0 ? 0 : 2;
+  }
+
+  try {
+    h5::file file{filename, 'r'};
+    h5::group g{file};
+    if (group_name != "/") g = g.open_group(group_name);
+    std::cout << h5::storage_report(g, recursive).to_json();
+  } catch (std::exception const &e) {
+    std::cerr << argv[0] << " : " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}